@@ -2,6 +2,12 @@ void set_vsync(bool enable);
 
 void on_window_resize(u32 w, u32 h);
 void present();
+void set_frame_pacing(u32 max_frames_in_flight, bool low_latency);
+void begin_frame();
+FrameTimings get_frame_timings();
+Fence insert_fence();
+bool is_signaled(Fence fence);
+void wait(Fence fence);
 CameraMatrices calculate_perspective_matrices(v3f position, v3f rotation, f32 aspect_ratio, f32 fov_radians, f32 near_plane, f32 far_plane);
 
 void set_blend(BlendFunction function, Blend source, Blend destination);
@@ -15,32 +21,64 @@ void enable_depth_clip();
 void set_viewport(s32 x, s32 y, u32 w, u32 h);
 
 void draw(u32 vertex_count, u32 start_vertex);
-void draw_indexed(u32 index_count);
+void draw_instanced(u32 vertex_count, u32 instance_count, u32 start_vertex, u32 start_instance);
+void draw_indexed(u32 index_count, u32 first_index, s32 base_vertex);
+void draw_indexed_indirect(ComputeBuffer *arguments, u32 offset, u32 draw_count, u32 stride);
+
+VertexLayout *create_vertex_layout(Span<VertexStream> streams);
+void set_vertex_layout(VertexLayout *layout);
 
 VertexBuffer *create_vertex_buffer(Span<u8> buffer, Span<ElementType> vertex_descriptor);
 void set_vertex_buffer(VertexBuffer *buffer);
+void set_vertex_buffers(u32 slot, VertexBuffer *buffer, u32 offset, u32 stride);
 void update_vertex_buffer(VertexBuffer *buffer, Span<u8> data);
+void *map_vertex_buffer(VertexBuffer *buffer, Access access);
+void unmap_vertex_buffer(VertexBuffer *buffer);
 
 IndexBuffer *create_index_buffer(Span<u8> buffer, u32 index_size);
+void update_index_buffer(IndexBuffer *buffer, Span<u8> data, u32 first_index);
 void set_index_buffer(IndexBuffer *buffer);
 
 Texture2D *create_texture_2d(u32 width, u32 height, void const *data, Format format);
+Texture2D *create_texture_2d_mipmapped(u32 width, u32 height, u32 mip_count, Format format);
+Texture2D *create_texture_2d_multisampled(u32 width, u32 height, Format format, u32 sample_count);
+Texture2D *create_renderbuffer(u32 width, u32 height, Format format, u32 sample_count);
 void set_texture_2d(Texture2D *texture, u32 slot);
 void resize_texture_2d(Texture2D *texture, u32 w, u32 h);
 void read_texture_2d(Texture2D *texture, Span<u8> data);
+Readback *create_readback(u32 size);
+void read_texture_2d_async(Texture2D *texture, u32 mip, Readback *readback);
+bool is_readback_ready(Readback *readback);
+void *map_readback(Readback *readback);
+void unmap_readback(Readback *readback);
 void update_texture_2d(Texture2D *texture, u32 width, u32 height, void *data);
+void update_texture_2d_region(Texture2D *texture, u32 x, u32 y, u32 width, u32 height, void const *data);
 void generate_mipmaps_2d(Texture2D *texture);
 
 void set_sampler(Filtering filtering, Comparison comparison, u32 slot);
 
 RenderTarget *create_render_target(Texture2D *color, Texture2D *depth);
+RenderTarget *create_window_render_target(Format color_format, Format depth_format, f32 scale);
+RenderTarget *create_render_target_with_attachments(Span<Texture2D *> colors, Texture2D *depth);
+void resolve(RenderTarget *source, RenderTarget *destination);
 void set_render_target(RenderTarget *target);
 void clear(RenderTarget *render_target, ClearFlags flags, v4f color, f32 depth);
+void discard(RenderTarget *render_target, ClearFlags flags);
 
 TextureCube *create_texture_cube(u32 size, void **data, Format format);
 void set_texture_cube(TextureCube *texture, u32 slot);
 void generate_mipmaps_cube(TextureCube *texture, GenerateCubeMipmapParams params);
 
+Texture2DArray *create_texture_2d_array(u32 width, u32 height, u32 layer_count, u32 mip_count, Format format);
+void update_texture_2d_array_layer(Texture2DArray *texture, u32 layer, void const *data);
+void generate_mipmaps_2d_array(Texture2DArray *texture);
+void set_texture_2d_array(Texture2DArray *texture, u32 slot);
+
+TextureCubeArray *create_texture_cube_array(u32 size, u32 layer_count, Format format);
+void update_texture_cube_array_layer(TextureCubeArray *texture, u32 layer, void **data);
+void generate_mipmaps_cube_array(TextureCubeArray *texture);
+void set_texture_cube_array(TextureCubeArray *texture, u32 slot);
+
 Shader *create_shader(Span<utf8> source);
 void set_shader(Shader *shader);
 
@@ -56,10 +94,13 @@ RasterizerState get_rasterizer();
 ComputeShader *create_compute_shader(Span<utf8> source);
 void set_compute_shader(ComputeShader *shader);
 void dispatch_compute_shader(u32 x, u32 y, u32 z);
+void dispatch_compute_indirect(ComputeBuffer *arguments, u32 offset);
+void memory_barrier(Barrier barriers);
 
 ComputeBuffer *create_compute_buffer(u32 size);
 void read_compute_buffer(ComputeBuffer *buffer, void *data);
+void update_compute_buffer(ComputeBuffer *buffer, void const *data, u32 offset, u32 size);
 void set_compute_buffer(ComputeBuffer *buffer, u32 slot);
-void set_compute_texture(Texture2D *texture, u32 slot);
+void set_compute_texture(Texture2D *texture, u32 slot, u32 mip, Access access);
 
 void init_colored_rectangle_shader();
@@ -0,0 +1,245 @@
+#pragma once
+#include "tgraphics.h"
+
+namespace tgraphics {
+
+// Packs many small images into a few shared textures ("pages").
+//
+// Images are inserted one at a time with a skyline packer: each page keeps the height of the
+// packed area along its width and a new image goes where its top edge ends up lowest.
+// Every insert uploads only the image's own rectangle. When no page has room a new page is added.
+//
+// Example:
+//
+//   auto atlas = create_texture_atlas({1024, 1024});
+//   auto icon = insert_image(state, atlas, {32, 32}, pixels);
+//   state->set_texture_2d(atlas.pages[icon.page], 0);
+//   // sample with icon.uv
+
+struct AtlasRegion {
+	u32 page;
+	v2u position; // in texels, of the first row and column of the image
+	v2u size;
+	v4f uv;       // u0, v0, u1, v1. v0 is at the first row of the image
+};
+
+struct SkylineNode {
+	u32 x;
+	u32 y;
+	u32 width;
+};
+
+// Skyline of a single page. Nodes are sorted by x and cover the whole width.
+struct SkylinePacker {
+	v2u size;
+	List<SkylineNode> nodes;
+};
+
+TGRAPHICS_API SkylinePacker create_skyline_packer(v2u size);
+TGRAPHICS_API void free(SkylinePacker &packer);
+
+// Reserves a rectangle of `size` and returns its position, or false if it does not fit.
+TGRAPHICS_API bool pack(SkylinePacker &packer, v2u size, v2u *position);
+
+struct TextureAtlas {
+	v2u page_size;
+	Format format;
+
+	// Empty texels around every image, so filtering does not pick up neighbours.
+	u32 padding;
+
+	List<Texture2D *> pages;
+	List<SkylinePacker> packers;
+};
+
+// Pages are created on the first insert. Supported formats are Format_rgba_u8n and Format_r_u8n.
+TGRAPHICS_API TextureAtlas create_texture_atlas(v2u page_size, Format format = Format_rgba_u8n, u32 padding = 1);
+
+// Frees CPU side memory. Pages stay alive with the state.
+TGRAPHICS_API void free(TextureAtlas &atlas);
+
+// Packs and uploads an image of `size` texels, tightly packed rows starting from the first one.
+// `data` may be null to only reserve the rectangle. Returns false if the image is larger than a page.
+TGRAPHICS_API bool insert_image(State *state, TextureAtlas &atlas, v2u size, void const *data, AtlasRegion *region);
+
+inline AtlasRegion insert_image(State *state, TextureAtlas &atlas, v2u size, void const *data) {
+	AtlasRegion result = {};
+	bool inserted = insert_image(state, atlas, size, data, &result);
+	assert(inserted, "insert_image: image is larger than an atlas page");
+	return result;
+}
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+SkylinePacker create_skyline_packer(v2u size) {
+	SkylinePacker result = {};
+	result.size = size;
+	result.nodes.add({.x = 0, .y = 0, .width = size.x});
+	return result;
+}
+
+void free(SkylinePacker &packer) {
+	free(packer.nodes);
+}
+
+namespace atlas {
+
+// Returns the height at which a rectangle of `width` would rest if its left edge is at node `index`,
+// or ~0u if it runs past the right edge.
+inline u32 get_fit_height(SkylinePacker &packer, umm index, u32 width) {
+	auto x = packer.nodes[index].x;
+	if (x + width > packer.size.x)
+		return ~0u;
+
+	u32 y = 0;
+	u32 remaining = width;
+	for (umm i = index; remaining; ++i) {
+		auto &node = packer.nodes[i];
+		y = max(y, node.y);
+		remaining -= min(remaining, node.width);
+	}
+	return y;
+}
+
+inline u32 get_bytes_per_texel(Format format) {
+	switch (format) {
+		case Format_rgba_u8n: return 4;
+		case Format_r_u8n:    return 1;
+	}
+	invalid_code_path();
+	return 0;
+}
+
+}
+
+bool pack(SkylinePacker &packer, v2u size, v2u *position) {
+	using namespace atlas;
+
+	if (size.x > packer.size.x || size.y > packer.size.y)
+		return false;
+
+	// Lowest top edge first, then the narrowest node so wide gaps stay available.
+	umm best_index = ~(umm)0;
+	u32 best_top = ~0u;
+	u32 best_width = ~0u;
+	for (umm i = 0; i < packer.nodes.count; ++i) {
+		auto y = get_fit_height(packer, i, size.x);
+		if (y == ~0u || y + size.y > packer.size.y)
+			continue;
+		auto top = y + size.y;
+		if (top < best_top || (top == best_top && packer.nodes[i].width < best_width)) {
+			best_index = i;
+			best_top = top;
+			best_width = packer.nodes[i].width;
+		}
+	}
+	if (best_index == ~(umm)0)
+		return false;
+
+	auto x = packer.nodes[best_index].x;
+	*position = {x, best_top - size.y};
+
+	// Replace the covered part of the skyline with one node at the new height.
+	SkylineNode inserted = {.x = x, .y = best_top, .width = size.x};
+	umm end = best_index;
+	while (end < packer.nodes.count && packer.nodes[end].x + packer.nodes[end].width <= x + size.x)
+		++end;
+	if (end < packer.nodes.count && packer.nodes[end].x < x + size.x) {
+		// Partially covered node keeps its right part.
+		auto &node = packer.nodes[end];
+		auto cut = x + size.x - node.x;
+		node.x += cut;
+		node.width -= cut;
+	}
+
+	List<SkylineNode> nodes;
+	for (umm i = 0; i < best_index; ++i)
+		nodes.add(packer.nodes[i]);
+	nodes.add(inserted);
+	for (umm i = end; i < packer.nodes.count; ++i)
+		nodes.add(packer.nodes[i]);
+
+	// Merge neighbours of the same height.
+	umm merged_count = 0;
+	for (umm i = 0; i < nodes.count; ++i) {
+		if (merged_count && nodes[merged_count - 1].y == nodes[i].y) {
+			nodes[merged_count - 1].width += nodes[i].width;
+		} else {
+			nodes[merged_count++] = nodes[i];
+		}
+	}
+	nodes.count = merged_count;
+
+	free(packer.nodes);
+	packer.nodes = nodes;
+	return true;
+}
+
+TextureAtlas create_texture_atlas(v2u page_size, Format format, u32 padding) {
+	TextureAtlas result = {};
+	result.page_size = page_size;
+	result.format = format;
+	result.padding = padding;
+	atlas::get_bytes_per_texel(format);
+	return result;
+}
+
+void free(TextureAtlas &atlas) {
+	for (auto &packer : atlas.packers)
+		free(packer);
+	free(atlas.packers);
+	free(atlas.pages);
+}
+
+bool insert_image(State *state, TextureAtlas &atlas, v2u size, void const *data, AtlasRegion *region) {
+	v2u padded = {size.x + atlas.padding * 2, size.y + atlas.padding * 2};
+	if (padded.x > atlas.page_size.x || padded.y > atlas.page_size.y)
+		return false;
+
+	u32 page = 0;
+	v2u position = {};
+	for (; page < atlas.packers.count; ++page) {
+		if (pack(atlas.packers[page], padded, &position))
+			break;
+	}
+
+	if (page == atlas.packers.count) {
+		// New pages start cleared so padding is transparent.
+		List<u8> zeros;
+		defer { free(zeros); };
+		zeros.resize((umm)atlas.page_size.x * atlas.page_size.y * atlas::get_bytes_per_texel(atlas.format));
+		memset(zeros.data, 0, zeros.count);
+
+		atlas.pages.add(state->create_texture_2d(atlas.page_size.x, atlas.page_size.y, zeros.data, atlas.format));
+		atlas.packers.add(create_skyline_packer(atlas.page_size));
+
+		bool packed = pack(atlas.packers[page], padded, &position);
+		assert(packed);
+	}
+
+	position.x += atlas.padding;
+	position.y += atlas.padding;
+
+	if (data) {
+		state->update_texture_2d_region(atlas.pages[page], position.x, position.y, size.x, size.y, data);
+	}
+
+	region->page = page;
+	region->position = position;
+	region->size = size;
+	region->uv = {
+		(f32)position.x            / atlas.page_size.x,
+		(f32)position.y            / atlas.page_size.y,
+		(f32)(position.x + size.x) / atlas.page_size.x,
+		(f32)(position.y + size.y) / atlas.page_size.y,
+	};
+	return true;
+}
+
+}
+
+#endif
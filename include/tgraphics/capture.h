@@ -0,0 +1,399 @@
+#pragma once
+#include "tgraphics.h"
+
+namespace tgraphics {
+
+// Records every call made through a State into a binary trace file, which `replay_trace` from replay.h
+// executes again on any backend.
+//
+// Capture replaces the state's function pointers with wrappers that serialize the arguments, including
+// uploaded data, and then call the backend. Calls made by other calls (e.g. `create_vertex_layout` inside
+// `create_vertex_buffer`) are not recorded, replaying the outer call repeats them.
+// Resources are referred to by the order they were created in, so capture has to start right after `init`.
+//
+// Trace layout:
+//   TraceHeader
+//   for every call: u16 ApiCall, then the arguments in declaration order.
+//     `present` is followed by u64 microseconds since the capture started, used for paced replay.
+//     Values are stored as is, resources as u32 handles (~0u is null),
+//     spans and uploaded data as u64 count followed by the elements.
+//
+// Example:
+//
+//   auto state = init(GraphicsApi_opengl, {.window = window});
+//   start_capture(state, u8"frame.trace"s);
+//   ...
+//   stop_capture(state);
+
+enum ApiCall : u16 {
+	#include "generated/calls.h"
+	ApiCall_count,
+};
+
+inline constexpr u32 trace_magic = 0x52544754; // "TGTR"
+inline constexpr u32 trace_version = 4;
+inline constexpr u32 trace_null_handle = ~0u;
+
+struct TraceHeader {
+	u32 magic;
+	u32 version;
+	u32 call_count; // ApiCall_count of the writer, a trace of a different api does not replay
+	u32 reserved;
+};
+
+// Returns false if the file could not be created.
+TGRAPHICS_API bool start_capture(State *state, Span<utf8> path);
+
+// Restores the backend's functions and closes the file. No other thread may use the state during this call.
+// Buffers mapped during the capture must be unmapped before it stops.
+TGRAPHICS_API void stop_capture(State *state);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+#include <stdio.h>
+
+namespace tgraphics {
+
+struct Capture {
+	// Function pointers of the backend, called by the wrappers.
+	State original;
+
+	FILE *file;
+	List<u8> buffer;
+
+	// Held for the duration of a recorded call so calls from different threads do not interleave.
+	SRWLOCK lock;
+
+	HashMap<umm, u32> handles; // address of a resource to its handle plus one
+	u32 handle_count;
+	bool warned_unknown_handle;
+
+	LARGE_INTEGER start_time;
+	LARGE_INTEGER frequency;
+
+	// Shader constants and vertex buffers that are currently mapped.
+	// The application writes to `shadow`, `snapshot` keeps the contents at map time to find what changed.
+	struct MappedBuffer {
+		void *buffer;
+		void *data; // mapping of the backend
+		u8 *shadow;
+		u8 *snapshot;
+		umm size;
+	};
+	List<MappedBuffer> mapped_buffers;
+};
+
+namespace trace {
+
+// Written buffer is flushed at every present and when it grows past this.
+inline constexpr umm capture_flush_size = 4 * 1024 * 1024;
+
+inline thread_local u32 call_depth = 0;
+
+inline void write_bytes(Capture &capture, void const *data, umm size) {
+	auto offset = capture.buffer.count;
+	capture.buffer.resize(offset + size);
+	memcpy(capture.buffer.data + offset, data, size);
+}
+
+template <class T>
+void write_raw(Capture &capture, T const &value) {
+	write_bytes(capture, &value, sizeof(value));
+}
+
+inline void flush(Capture &capture) {
+	fwrite(capture.buffer.data, 1, capture.buffer.count, capture.file);
+	fflush(capture.file);
+	capture.buffer.clear();
+}
+
+inline void register_handle(Capture &capture, void const *pointer) {
+	auto handle = capture.handle_count++;
+	if (pointer)
+		capture.handles.get_or_insert((umm)pointer) = handle + 1;
+}
+
+struct TraceCall {
+	Capture &capture;
+	ApiCall call;
+	bool recording;
+
+	TraceCall(Capture &capture, ApiCall call) : capture(capture), call(call) {
+		recording = call_depth++ == 0;
+		if (recording) {
+			AcquireSRWLockExclusive(&capture.lock);
+			write_raw(capture, (u16)call);
+			if (call == ApiCall_present) {
+				LARGE_INTEGER now;
+				QueryPerformanceCounter(&now);
+				write_raw(capture, (u64)((now.QuadPart - capture.start_time.QuadPart) * 1'000'000 / capture.frequency.QuadPart));
+			}
+		}
+	}
+	~TraceCall() {
+		if (recording) {
+			if (call == ApiCall_present || capture.buffer.count >= capture_flush_size)
+				flush(capture);
+			ReleaseSRWLockExclusive(&capture.lock);
+		}
+		--call_depth;
+	}
+};
+
+template <class T>
+void write_value(Capture &capture, T const &value) {
+	write_raw(capture, value);
+}
+
+template <class T>
+void write_value(Capture &capture, T *pointer) {
+	u32 handle = trace_null_handle;
+	if (pointer) {
+		auto index = capture.handles.get_or_insert((umm)pointer);
+		if (index) {
+			handle = index - 1;
+		} else if (!capture.warned_unknown_handle) {
+			capture.warned_unknown_handle = true;
+			print(Print_warning, "capture: a resource created before start_capture was used, it will be null on replay\n");
+		}
+	}
+	write_raw(capture, handle);
+}
+
+template <class T>
+void write_value(Capture &capture, Span<T> span) {
+	write_raw(capture, (u64)span.count);
+	write_bytes(capture, span.data, span.count * sizeof(T));
+}
+
+inline void write_value(Capture &capture, Span<Texture2D *> textures) {
+	write_raw(capture, (u64)textures.count);
+	for (auto texture : textures)
+		write_value(capture, texture);
+}
+
+inline void write_value(Capture &capture, Span<VertexStream> streams) {
+	write_raw(capture, (u64)streams.count);
+	for (auto &stream : streams) {
+		write_value(capture, stream.elements);
+		write_raw(capture, stream.step_rate);
+	}
+}
+
+inline void write_data(Capture &capture, void const *data, umm size) {
+	if (!data)
+		size = 0;
+	write_raw(capture, (u64)size);
+	write_bytes(capture, data, size);
+}
+
+inline void write_faces(Capture &capture, void **faces, umm face_size) {
+	for (u32 i = 0; i < 6; ++i)
+		write_data(capture, faces ? faces[i] : 0, face_size);
+}
+
+// Handles are numbered in creation order, null results included, so replay numbers them the same way.
+template <class T>
+void capture_result(Capture &capture, T *result) {
+	register_handle(capture, result);
+}
+inline void capture_result(Capture &capture, void *result) {}
+template <class T>
+void capture_result(Capture &capture, T const &result) {}
+
+// Attachments may be created by the call, e.g. by create_window_render_target, so they get handles too.
+// replay_result registers them in the same order.
+inline void capture_result(Capture &capture, RenderTarget *result) {
+	register_handle(capture, result);
+	if (!result)
+		return;
+	register_handle(capture, result->color);
+	for (u32 i = 1; i < result->color_count; ++i)
+		register_handle(capture, result->colors[i]);
+	register_handle(capture, result->depth);
+}
+
+// Maps through the backend and hands out a copy of the contents, so writes can be found on unmap.
+// The backend mapping is made readable to take that copy, even if `access` asked only for writing.
+inline void *map_shadow(State *state, Capture &capture, void *buffer, void *data, umm size) {
+	if (!data)
+		return 0;
+	Capture::MappedBuffer mapped = {
+		.buffer = buffer,
+		.data = data,
+		.shadow = state->allocator.allocate<u8>(size * 2),
+		.size = size,
+	};
+	mapped.snapshot = mapped.shadow + size;
+	memcpy(mapped.shadow, data, size);
+	memcpy(mapped.snapshot, data, size);
+	capture.mapped_buffers.add(mapped);
+	return mapped.shadow;
+}
+
+// Copies the changed bytes of `buffer`'s shadow into the backend mapping and records their range.
+// Nothing is recorded if it was mapped before the capture started.
+inline void unmap_shadow(State *state, Capture &capture, void *buffer) {
+	for (umm i = 0; i < capture.mapped_buffers.count; ++i) {
+		auto mapped = capture.mapped_buffers[i];
+		if (mapped.buffer != buffer)
+			continue;
+
+		umm first = 0;
+		while (first < mapped.size && mapped.shadow[first] == mapped.snapshot[first])
+			++first;
+		umm last = mapped.size;
+		while (last > first && mapped.shadow[last - 1] == mapped.snapshot[last - 1])
+			--last;
+
+		memcpy((u8 *)mapped.data + first, mapped.shadow + first, last - first);
+		write_raw(capture, (u64)first);
+		write_data(capture, mapped.shadow + first, last - first);
+
+		state->allocator.free(mapped.shadow);
+		capture.mapped_buffers[i] = capture.mapped_buffers[capture.mapped_buffers.count - 1];
+		capture.mapped_buffers.count -= 1;
+		return;
+	}
+	write_raw(capture, (u64)0);
+	write_data(capture, 0, 0);
+}
+
+// Sizes of uploaded data. They are taken from the OpenGL objects.
+
+inline umm data_size_create_texture_2d(u32 width, u32 height, void const *data, Format format) {
+	return (umm)width * height * gl::get_bytes_per_texel(format);
+}
+inline umm data_size_update_texture_2d(Texture2D *texture, u32 width, u32 height, void *data) {
+	return (umm)width * height * ((gl::Texture2DImpl *)texture)->bytes_per_texel;
+}
+inline umm data_size_update_texture_2d_region(Texture2D *texture, u32 x, u32 y, u32 width, u32 height, void const *data) {
+	return (umm)width * height * ((gl::Texture2DImpl *)texture)->bytes_per_texel;
+}
+inline umm data_size_create_texture_cube(u32 size, void **data, Format format) {
+	return (umm)size * size * gl::get_bytes_per_texel(format);
+}
+inline umm data_size_update_texture_2d_array_layer(Texture2DArray *texture, u32 layer, void const *data) {
+	return (umm)texture->size.x * texture->size.y * ((gl::Texture2DArrayImpl *)texture)->bytes_per_texel;
+}
+inline umm data_size_update_texture_cube_array_layer(TextureCubeArray *texture, u32 layer, void **data) {
+	return (umm)texture->size * texture->size * ((gl::TextureCubeArrayImpl *)texture)->bytes_per_texel;
+}
+inline umm data_size_update_shader_constants(ShaderConstants *constants, void const *source, u32 offset, u32 size) {
+	return size;
+}
+// Output buffer, recorded only so replay has memory of the right size to read into.
+inline umm data_size_read_compute_buffer(ComputeBuffer *buffer, void *data) {
+	return ((gl::ComputeBufferImpl *)buffer)->size;
+}
+inline umm data_size_update_compute_buffer(ComputeBuffer *buffer, void const *data, u32 offset, u32 size) {
+	return size;
+}
+
+}
+
+bool start_capture(State *state, Span<utf8> path) {
+	using namespace trace;
+
+	assert(!state->capture, "start_capture: capture is already running");
+
+	List<char> path_z;
+	defer { free(path_z); };
+	path_z.resize(path.count + 1);
+	memcpy(path_z.data, path.data, path.count);
+	path_z[path.count] = 0;
+
+	auto file = fopen(path_z.data, "wb");
+	if (!file) {
+		print(Print_error, "start_capture: failed to create {}\n", path);
+		return false;
+	}
+
+	auto &capture = *state->allocator.allocate<Capture>();
+	capture.original = *state;
+	capture.file = file;
+	InitializeSRWLock(&capture.lock);
+	QueryPerformanceFrequency(&capture.frequency);
+	QueryPerformanceCounter(&capture.start_time);
+
+	TraceHeader header = {
+		.magic = trace_magic,
+		.version = trace_version,
+		.call_count = ApiCall_count,
+	};
+	write_raw(capture, header);
+
+	// Created by init, replay registers its own in the same order.
+	capture_result(capture, state->back_buffer);
+
+	state->capture = &capture;
+
+	#include "generated/capture.h"
+
+	// The application gets a shadow copy of the mapped buffer. Bytes it changed are recorded on unmap.
+	state->_map_shader_constants = [](State *_state, ShaderConstants *constants, Access access) -> void * {
+		auto &capture = *_state->capture;
+		TraceCall call(capture, ApiCall_map_shader_constants);
+		if (!call.recording)
+			return capture.original._map_shader_constants(_state, constants, access);
+		write_value(capture, constants);
+		write_value(capture, access);
+		auto result = capture.original._map_shader_constants(_state, constants, (Access)(access | Access_read));
+		return map_shadow(_state, capture, constants, result, ((gl::ShaderConstantsImpl *)constants)->values_size);
+	};
+	state->_unmap_shader_constants = [](State *_state, ShaderConstants *constants) -> void {
+		auto &capture = *_state->capture;
+		TraceCall call(capture, ApiCall_unmap_shader_constants);
+		if (call.recording) {
+			write_value(capture, constants);
+			unmap_shadow(_state, capture, constants);
+		}
+		capture.original._unmap_shader_constants(_state, constants);
+	};
+	state->_map_vertex_buffer = [](State *_state, VertexBuffer *buffer, Access access) -> void * {
+		auto &capture = *_state->capture;
+		TraceCall call(capture, ApiCall_map_vertex_buffer);
+		if (!call.recording)
+			return capture.original._map_vertex_buffer(_state, buffer, access);
+		write_value(capture, buffer);
+		write_value(capture, access);
+		auto result = capture.original._map_vertex_buffer(_state, buffer, (Access)(access | Access_read));
+		return map_shadow(_state, capture, buffer, result, ((gl::VertexBufferImpl *)buffer)->size);
+	};
+	state->_unmap_vertex_buffer = [](State *_state, VertexBuffer *buffer) -> void {
+		auto &capture = *_state->capture;
+		TraceCall call(capture, ApiCall_unmap_vertex_buffer);
+		if (call.recording) {
+			write_value(capture, buffer);
+			unmap_shadow(_state, capture, buffer);
+		}
+		capture.original._unmap_vertex_buffer(_state, buffer);
+	};
+
+	return true;
+}
+
+void stop_capture(State *state) {
+	using namespace trace;
+
+	assert(state->capture, "stop_capture: capture is not running");
+	auto &capture = *state->capture;
+	assert(capture.mapped_buffers.count == 0, "stop_capture: a buffer mapped during the capture is still mapped");
+
+	#include "generated/uncapture.h"
+
+	flush(capture);
+	fclose(capture.file);
+
+	free(capture.buffer);
+	free(capture.handles);
+	free(capture.mapped_buffers);
+	state->allocator.free(&capture);
+	state->capture = 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,310 @@
+#pragma once
+#include "tgraphics.h"
+#include "parallel.h"
+
+namespace tgraphics {
+
+// Planes are stored as (normal.x, normal.y, normal.z, distance) with normals pointing inside.
+// A point p is inside a plane if dot(normal, p) + distance >= 0.
+struct Frustum {
+	v4f planes[6]; // left, right, bottom, top, near, far
+};
+
+// Bounding volumes in structure-of-arrays layout.
+// Arrays do not need any particular alignment.
+struct CullSpheres {
+	f32 const *x;
+	f32 const *y;
+	f32 const *z;
+	f32 const *radius;
+	umm count;
+};
+
+struct CullBoxes {
+	f32 const *center_x;
+	f32 const *center_y;
+	f32 const *center_z;
+	f32 const *extent_x; // half size
+	f32 const *extent_y;
+	f32 const *extent_z;
+	umm count;
+};
+
+// Extracts normalized frustum planes from a view-projection matrix (Gribb & Hartmann).
+// Expects OpenGL clip space, where -w <= z <= w.
+TGRAPHICS_API Frustum extract_frustum(m4 const &view_projection);
+inline Frustum extract_frustum(CameraMatrices const &matrices) { return extract_frustum(matrices.mvp); }
+
+// Test every volume against `frustum` and write indices of the visible ones to `visible_indices`,
+// which must have room for `count` indices. Returns the number of visible volumes.
+// When `pool` is not null large arrays are split across its threads.
+// Volumes intersecting a plane are considered visible.
+TGRAPHICS_API umm cull_spheres(Frustum const &frustum, CullSpheres spheres, u32 *visible_indices, ThreadPool *pool = 0);
+TGRAPHICS_API umm cull_boxes  (Frustum const &frustum, CullBoxes   boxes,   u32 *visible_indices, ThreadPool *pool = 0);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+#include <immintrin.h>
+
+namespace tgraphics {
+
+Frustum extract_frustum(m4 const &m) {
+	// m4 is column major, element at (row, column) is s[column * 4 + row].
+	auto row = [&](u32 r) {
+		return v4f{m.s[r], m.s[4 + r], m.s[8 + r], m.s[12 + r]};
+	};
+
+	auto r0 = row(0);
+	auto r1 = row(1);
+	auto r2 = row(2);
+	auto r3 = row(3);
+
+	Frustum result;
+	result.planes[0] = r3 + r0;
+	result.planes[1] = r3 - r0;
+	result.planes[2] = r3 + r1;
+	result.planes[3] = r3 - r1;
+	result.planes[4] = r3 + r2;
+	result.planes[5] = r3 - r2;
+
+	for (auto &plane : result.planes) {
+		plane /= sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+	}
+	return result;
+}
+
+namespace culling {
+
+// Volumes per chunk when splitting across threads.
+inline constexpr umm min_volumes_per_chunk = 4096;
+
+// Each kernel processes [begin, end) and writes visible indices starting at `output`.
+// Returns the number of written indices.
+// Lanes are written unconditionally and the cursor advanced only for visible ones,
+// which avoids a branch per volume.
+
+inline umm cull_spheres_scalar(Frustum const &frustum, CullSpheres s, umm begin, umm end, u32 *output) {
+	umm visible_count = 0;
+	for (umm i = begin; i < end; ++i) {
+		bool visible = true;
+		for (auto &plane : frustum.planes) {
+			visible &= plane.x * s.x[i] + plane.y * s.y[i] + plane.z * s.z[i] + plane.w >= -s.radius[i];
+		}
+		output[visible_count] = (u32)i;
+		visible_count += visible;
+	}
+	return visible_count;
+}
+
+inline umm cull_boxes_scalar(Frustum const &frustum, CullBoxes b, umm begin, umm end, u32 *output) {
+	umm visible_count = 0;
+	for (umm i = begin; i < end; ++i) {
+		bool visible = true;
+		for (auto &plane : frustum.planes) {
+			f32 distance = plane.x * b.center_x[i] + plane.y * b.center_y[i] + plane.z * b.center_z[i] + plane.w;
+			f32 radius = fabsf(plane.x) * b.extent_x[i] + fabsf(plane.y) * b.extent_y[i] + fabsf(plane.z) * b.extent_z[i];
+			visible &= distance >= -radius;
+		}
+		output[visible_count] = (u32)i;
+		visible_count += visible;
+	}
+	return visible_count;
+}
+
+#if defined(__AVX2__)
+
+inline constexpr umm lane_count = 8;
+
+inline umm cull_spheres_simd(Frustum const &frustum, CullSpheres s, umm begin, umm end, u32 *output) {
+	__m256 px[6], py[6], pz[6], pw[6];
+	for (u32 p = 0; p < 6; ++p) {
+		px[p] = _mm256_set1_ps(frustum.planes[p].x);
+		py[p] = _mm256_set1_ps(frustum.planes[p].y);
+		pz[p] = _mm256_set1_ps(frustum.planes[p].z);
+		pw[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+	auto sign_mask = _mm256_set1_ps(-0.0f);
+
+	umm visible_count = 0;
+	umm i = begin;
+	for (; i + lane_count <= end; i += lane_count) {
+		auto x = _mm256_loadu_ps(s.x + i);
+		auto y = _mm256_loadu_ps(s.y + i);
+		auto z = _mm256_loadu_ps(s.z + i);
+		auto negative_radius = _mm256_xor_ps(_mm256_loadu_ps(s.radius + i), sign_mask);
+
+		auto outside = _mm256_setzero_ps();
+		for (u32 p = 0; p < 6; ++p) {
+			auto distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], x), _mm256_mul_ps(py[p], y)), _mm256_add_ps(_mm256_mul_ps(pz[p], z), pw[p]));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negative_radius, _CMP_LT_OQ));
+		}
+
+		u32 visible_mask = ~_mm256_movemask_ps(outside) & 0xff;
+		for (u32 lane = 0; lane < lane_count; ++lane) {
+			output[visible_count] = (u32)(i + lane);
+			visible_count += (visible_mask >> lane) & 1;
+		}
+	}
+	return visible_count + cull_spheres_scalar(frustum, s, i, end, output + visible_count);
+}
+
+inline umm cull_boxes_simd(Frustum const &frustum, CullBoxes b, umm begin, umm end, u32 *output) {
+	__m256 px[6], py[6], pz[6], pw[6];
+	__m256 ax[6], ay[6], az[6];
+	for (u32 p = 0; p < 6; ++p) {
+		px[p] = _mm256_set1_ps(frustum.planes[p].x);
+		py[p] = _mm256_set1_ps(frustum.planes[p].y);
+		pz[p] = _mm256_set1_ps(frustum.planes[p].z);
+		pw[p] = _mm256_set1_ps(frustum.planes[p].w);
+		ax[p] = _mm256_set1_ps(fabsf(frustum.planes[p].x));
+		ay[p] = _mm256_set1_ps(fabsf(frustum.planes[p].y));
+		az[p] = _mm256_set1_ps(fabsf(frustum.planes[p].z));
+	}
+	auto sign_mask = _mm256_set1_ps(-0.0f);
+
+	umm visible_count = 0;
+	umm i = begin;
+	for (; i + lane_count <= end; i += lane_count) {
+		auto cx = _mm256_loadu_ps(b.center_x + i);
+		auto cy = _mm256_loadu_ps(b.center_y + i);
+		auto cz = _mm256_loadu_ps(b.center_z + i);
+		auto ex = _mm256_loadu_ps(b.extent_x + i);
+		auto ey = _mm256_loadu_ps(b.extent_y + i);
+		auto ez = _mm256_loadu_ps(b.extent_z + i);
+
+		auto outside = _mm256_setzero_ps();
+		for (u32 p = 0; p < 6; ++p) {
+			auto distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], cx), _mm256_mul_ps(py[p], cy)), _mm256_add_ps(_mm256_mul_ps(pz[p], cz), pw[p]));
+			auto radius   = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_xor_ps(radius, sign_mask), _CMP_LT_OQ));
+		}
+
+		u32 visible_mask = ~_mm256_movemask_ps(outside) & 0xff;
+		for (u32 lane = 0; lane < lane_count; ++lane) {
+			output[visible_count] = (u32)(i + lane);
+			visible_count += (visible_mask >> lane) & 1;
+		}
+	}
+	return visible_count + cull_boxes_scalar(frustum, b, i, end, output + visible_count);
+}
+
+#else
+
+inline constexpr umm lane_count = 4;
+
+inline umm cull_spheres_simd(Frustum const &frustum, CullSpheres s, umm begin, umm end, u32 *output) {
+	__m128 px[6], py[6], pz[6], pw[6];
+	for (u32 p = 0; p < 6; ++p) {
+		px[p] = _mm_set1_ps(frustum.planes[p].x);
+		py[p] = _mm_set1_ps(frustum.planes[p].y);
+		pz[p] = _mm_set1_ps(frustum.planes[p].z);
+		pw[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+	auto sign_mask = _mm_set1_ps(-0.0f);
+
+	umm visible_count = 0;
+	umm i = begin;
+	for (; i + lane_count <= end; i += lane_count) {
+		auto x = _mm_loadu_ps(s.x + i);
+		auto y = _mm_loadu_ps(s.y + i);
+		auto z = _mm_loadu_ps(s.z + i);
+		auto negative_radius = _mm_xor_ps(_mm_loadu_ps(s.radius + i), sign_mask);
+
+		auto outside = _mm_setzero_ps();
+		for (u32 p = 0; p < 6; ++p) {
+			auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y)), _mm_add_ps(_mm_mul_ps(pz[p], z), pw[p]));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negative_radius));
+		}
+
+		u32 visible_mask = ~_mm_movemask_ps(outside) & 0xf;
+		for (u32 lane = 0; lane < lane_count; ++lane) {
+			output[visible_count] = (u32)(i + lane);
+			visible_count += (visible_mask >> lane) & 1;
+		}
+	}
+	return visible_count + cull_spheres_scalar(frustum, s, i, end, output + visible_count);
+}
+
+inline umm cull_boxes_simd(Frustum const &frustum, CullBoxes b, umm begin, umm end, u32 *output) {
+	__m128 px[6], py[6], pz[6], pw[6];
+	__m128 ax[6], ay[6], az[6];
+	for (u32 p = 0; p < 6; ++p) {
+		px[p] = _mm_set1_ps(frustum.planes[p].x);
+		py[p] = _mm_set1_ps(frustum.planes[p].y);
+		pz[p] = _mm_set1_ps(frustum.planes[p].z);
+		pw[p] = _mm_set1_ps(frustum.planes[p].w);
+		ax[p] = _mm_set1_ps(fabsf(frustum.planes[p].x));
+		ay[p] = _mm_set1_ps(fabsf(frustum.planes[p].y));
+		az[p] = _mm_set1_ps(fabsf(frustum.planes[p].z));
+	}
+	auto sign_mask = _mm_set1_ps(-0.0f);
+
+	umm visible_count = 0;
+	umm i = begin;
+	for (; i + lane_count <= end; i += lane_count) {
+		auto cx = _mm_loadu_ps(b.center_x + i);
+		auto cy = _mm_loadu_ps(b.center_y + i);
+		auto cz = _mm_loadu_ps(b.center_z + i);
+		auto ex = _mm_loadu_ps(b.extent_x + i);
+		auto ey = _mm_loadu_ps(b.extent_y + i);
+		auto ez = _mm_loadu_ps(b.extent_z + i);
+
+		auto outside = _mm_setzero_ps();
+		for (u32 p = 0; p < 6; ++p) {
+			auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)), _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+			auto radius   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_xor_ps(radius, sign_mask)));
+		}
+
+		u32 visible_mask = ~_mm_movemask_ps(outside) & 0xf;
+		for (u32 lane = 0; lane < lane_count; ++lane) {
+			output[visible_count] = (u32)(i + lane);
+			visible_count += (visible_mask >> lane) & 1;
+		}
+	}
+	return visible_count + cull_boxes_scalar(frustum, b, i, end, output + visible_count);
+}
+
+#endif
+
+// Runs `kernel` over chunks of [0, count). Every chunk writes its indices at its own start in `output`,
+// afterwards the results are moved together.
+template <class Kernel>
+umm cull_parallel(umm count, u32 *output, ThreadPool *pool, Kernel &&kernel) {
+	umm chunk_begins[max_parallel_chunk_count];
+	umm chunk_visible_counts[max_parallel_chunk_count];
+
+	auto chunk_count = get_parallel_chunk_count(pool, count, min_volumes_per_chunk);
+
+	parallel_for(pool, count, min_volumes_per_chunk, [&](u32 chunk_index, umm begin, umm end) {
+		chunk_begins[chunk_index] = begin;
+		chunk_visible_counts[chunk_index] = kernel(begin, end, output + begin);
+	});
+
+	umm visible_count = chunk_visible_counts[0];
+	for (u32 chunk_index = 1; chunk_index < chunk_count; ++chunk_index) {
+		memmove(output + visible_count, output + chunk_begins[chunk_index], chunk_visible_counts[chunk_index] * sizeof(u32));
+		visible_count += chunk_visible_counts[chunk_index];
+	}
+	return visible_count;
+}
+
+}
+
+umm cull_spheres(Frustum const &frustum, CullSpheres spheres, u32 *visible_indices, ThreadPool *pool) {
+	return culling::cull_parallel(spheres.count, visible_indices, pool, [&](umm begin, umm end, u32 *output) {
+		return culling::cull_spheres_simd(frustum, spheres, begin, end, output);
+	});
+}
+
+umm cull_boxes(Frustum const &frustum, CullBoxes boxes, u32 *visible_indices, ThreadPool *pool) {
+	return culling::cull_parallel(boxes.count, visible_indices, pool, [&](umm begin, umm end, u32 *output) {
+		return culling::cull_boxes_simd(frustum, boxes, begin, end, output);
+	});
+}
+
+}
+
+#endif
@@ -0,0 +1,248 @@
+#pragma once
+#include "tgraphics.h"
+#include "parallel.h"
+
+namespace tgraphics {
+
+enum DepthOrder : u8 {
+	DepthOrder_none,
+	DepthOrder_front_to_back, // opaque geometry, depth is the least significant field
+	DepthOrder_back_to_front, // blended geometry, depth is sorted before pipeline and material
+};
+
+// Layout of a draw key, most significant bits first:
+//
+//   front to back: | target 6 | pass 6 | pipeline 12 | material 16 |  depth 24 |
+//   back to front: | target 6 | pass 6 |   ~depth 24 | pipeline 12 | material 16 |
+//
+// Sorting keys in ascending order groups draws by render target, then pass, then
+// either by state (so shader and texture switches are minimized) or by distance.
+// `depth` is expected to be normalized to [0, 1], e.g. view space depth divided by the far plane.
+inline constexpr u32 draw_key_target_bits   = 6;
+inline constexpr u32 draw_key_pass_bits     = 6;
+inline constexpr u32 draw_key_pipeline_bits = 12;
+inline constexpr u32 draw_key_material_bits = 16;
+inline constexpr u32 draw_key_depth_bits    = 24;
+
+inline u64 make_draw_key(u32 target, u32 pass, u32 pipeline, u32 material, f32 depth, DepthOrder order) {
+	assert(target   < (1 << draw_key_target_bits));
+	assert(pass     < (1 << draw_key_pass_bits));
+	assert(pipeline < (1 << draw_key_pipeline_bits));
+	assert(material < (1 << draw_key_material_bits));
+
+	u64 quantized_depth = 0;
+	if (order != DepthOrder_none) {
+		constexpr u32 max_depth = (1 << draw_key_depth_bits) - 1;
+		quantized_depth = (u64)(clamp(depth, 0.0f, 1.0f) * max_depth);
+		if (order == DepthOrder_back_to_front)
+			quantized_depth = max_depth - quantized_depth;
+	}
+
+	u64 key = target;
+	key = (key << draw_key_pass_bits) | pass;
+	if (order == DepthOrder_back_to_front) {
+		key = (key << draw_key_depth_bits)    | quantized_depth;
+		key = (key << draw_key_pipeline_bits) | pipeline;
+		key = (key << draw_key_material_bits) | material;
+	} else {
+		key = (key << draw_key_pipeline_bits) | pipeline;
+		key = (key << draw_key_material_bits) | material;
+		key = (key << draw_key_depth_bits)    | quantized_depth;
+	}
+	return key;
+}
+
+inline constexpr u32 draw_packet_constants_slot_count = 4;
+inline constexpr u32 draw_packet_texture_slot_count   = 4;
+
+// Everything needed to issue one draw call.
+// Null resources are left as they are, so unrelated state set before `flush` is kept.
+struct DrawPacket {
+	RenderTarget *render_target = 0;
+	Shader *shader = 0;
+	VertexBuffer *vertex_buffer = 0;
+	IndexBuffer *index_buffer = 0;
+	ShaderConstants *constants[draw_packet_constants_slot_count] = {};
+	Texture2D *textures[draw_packet_texture_slot_count] = {};
+
+	// Number of vertices, or indices if `index_buffer` is set.
+	u32 count = 0;
+	u32 start_vertex = 0;
+
+	// Used only with `index_buffer`.
+	u32 first_index = 0;
+	s32 base_vertex = 0;
+};
+
+// Collects draws in any order and submits them sorted by their keys.
+struct DrawQueue {
+	List<u64> keys;
+	List<u32> indices;
+	List<DrawPacket> packets;
+
+	// Scratch for the radix sort, kept between flushes to avoid reallocation.
+	List<u64> sorted_keys;
+	List<u32> sorted_indices;
+
+	// Queues with fewer draws than this are sorted on the calling thread.
+	umm min_draws_per_sort_chunk = 16 * 1024;
+
+	void push(u64 key, DrawPacket const &packet) {
+		keys.add(key);
+		indices.add((u32)packets.count);
+		packets.add(packet);
+	}
+
+	void clear() {
+		keys.clear();
+		indices.clear();
+		packets.clear();
+	}
+
+	// Sorts the queued draws, submits them to `state` and clears the queue.
+	// `pool` is optional, it is used only for large queues.
+	void flush(State *state, ThreadPool *pool = 0);
+};
+
+TGRAPHICS_API void free(DrawQueue &queue);
+
+// Sorts `keys` in ascending order, applying the same permutation to `values`.
+// The sort is stable. `keys_scratch` and `values_scratch` must be of the same size as `keys`.
+// The result may end up in either the input or the scratch arrays, the returned value tells which.
+TGRAPHICS_API bool radix_sort(Span<u64> keys, Span<u32> values, Span<u64> keys_scratch, Span<u32> values_scratch, ThreadPool *pool, umm min_items_per_chunk);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+// Returns true if the sorted result is in the scratch arrays.
+bool radix_sort(Span<u64> keys, Span<u32> values, Span<u64> keys_scratch, Span<u32> values_scratch, ThreadPool *pool, umm min_items_per_chunk) {
+	assert(keys.count == values.count);
+	assert(keys.count == keys_scratch.count);
+	assert(keys.count == values_scratch.count);
+
+	auto count = keys.count;
+	if (count == 0)
+		return false;
+
+	u64 *source_keys   = keys.data;
+	u32 *source_values = values.data;
+	u64 *dest_keys     = keys_scratch.data;
+	u32 *dest_values   = values_scratch.data;
+
+	auto chunk_count = get_parallel_chunk_count(pool, count, min_items_per_chunk);
+
+	u32 histograms[max_parallel_chunk_count][256];
+
+	bool result_in_scratch = false;
+	for (u32 shift = 0; shift < 64; shift += 8) {
+		parallel_for(pool, count, min_items_per_chunk, [&](u32 chunk_index, umm begin, umm end) {
+			auto &histogram = histograms[chunk_index];
+			memset(histogram, 0, sizeof(histogram));
+			for (umm i = begin; i < end; ++i) {
+				++histogram[(source_keys[i] >> shift) & 0xff];
+			}
+		});
+
+		// If every key has the same digit this pass would not move anything.
+		// Upper bytes of draw keys are often the same for the whole queue.
+		u32 first_digit = (source_keys[0] >> shift) & 0xff;
+		umm first_digit_count = 0;
+		for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+			first_digit_count += histograms[chunk_index][first_digit];
+		}
+		if (first_digit_count == count)
+			continue;
+
+		// Turn counts into output offsets. Digits are the outer loop and chunks the inner one,
+		// so items from earlier chunks land before items from later ones and the sort stays stable.
+		u32 offset = 0;
+		for (u32 digit = 0; digit < 256; ++digit) {
+			for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+				auto digit_count = histograms[chunk_index][digit];
+				histograms[chunk_index][digit] = offset;
+				offset += digit_count;
+			}
+		}
+
+		parallel_for(pool, count, min_items_per_chunk, [&](u32 chunk_index, umm begin, umm end) {
+			auto &offsets = histograms[chunk_index];
+			for (umm i = begin; i < end; ++i) {
+				auto destination = offsets[(source_keys[i] >> shift) & 0xff]++;
+				dest_keys  [destination] = source_keys[i];
+				dest_values[destination] = source_values[i];
+			}
+		});
+
+		swap(source_keys, dest_keys);
+		swap(source_values, dest_values);
+		result_in_scratch = !result_in_scratch;
+	}
+
+	return result_in_scratch;
+}
+
+void DrawQueue::flush(State *state, ThreadPool *pool) {
+	if (!packets.count)
+		return;
+
+	sorted_keys.resize(keys.count);
+	sorted_indices.resize(indices.count);
+
+	u32 *order = indices.data;
+	if (radix_sort(keys, indices, sorted_keys, sorted_indices, pool, min_draws_per_sort_chunk)) {
+		order = sorted_indices.data;
+	}
+
+	// Resources bound by the previous packet. Setters are called only for what changed.
+	DrawPacket bound = {};
+
+	for (umm i = 0; i < packets.count; ++i) {
+		auto &packet = packets[order[i]];
+
+		if (packet.render_target && packet.render_target != bound.render_target) {
+			state->set_render_target(bound.render_target = packet.render_target);
+		}
+		if (packet.shader && packet.shader != bound.shader) {
+			state->set_shader(bound.shader = packet.shader);
+		}
+		if (packet.vertex_buffer && packet.vertex_buffer != bound.vertex_buffer) {
+			state->set_vertex_buffer(bound.vertex_buffer = packet.vertex_buffer);
+		}
+		if (packet.index_buffer && packet.index_buffer != bound.index_buffer) {
+			state->set_index_buffer(bound.index_buffer = packet.index_buffer);
+		}
+		for (u32 slot = 0; slot < draw_packet_constants_slot_count; ++slot) {
+			if (packet.constants[slot] && packet.constants[slot] != bound.constants[slot]) {
+				state->set_shader_constants(bound.constants[slot] = packet.constants[slot], slot);
+			}
+		}
+		for (u32 slot = 0; slot < draw_packet_texture_slot_count; ++slot) {
+			if (packet.textures[slot] && packet.textures[slot] != bound.textures[slot]) {
+				state->set_texture_2d(bound.textures[slot] = packet.textures[slot], slot);
+			}
+		}
+
+		if (packet.index_buffer) {
+			state->draw_indexed(packet.count, packet.first_index, packet.base_vertex);
+		} else {
+			state->draw(packet.count, packet.start_vertex);
+		}
+	}
+
+	clear();
+}
+
+void free(DrawQueue &queue) {
+	free(queue.keys);
+	free(queue.indices);
+	free(queue.packets);
+	free(queue.sorted_keys);
+	free(queue.sorted_indices);
+}
+
+}
+
+#endif
@@ -0,0 +1,730 @@
+#pragma once
+#include "tgraphics.h"
+
+namespace tgraphics {
+
+// Pipelined capture of rendered frames to files or to shared memory.
+//
+// `capture_frame` only starts an asynchronous readback of the texture. Up to `frame_capture_readback_count`
+// readbacks are in flight, a finished one is copied into a CPU buffer and queued for one of the encoder
+// threads, which encode and write frames in parallel. So rendering, readback, encoding and writing of
+// different frames overlap, and throughput is limited by the slowest stage. When every buffer is busy
+// `capture_frame` waits, so a slow stage throttles the render thread instead of growing a queue.
+//
+// Frames are written top row first. The texture must be of Format_rgba_u8n and of `FrameCaptureParams::size`.
+//
+// Shared memory output is a ring another process maps by name, see FrameRingHeader. Encoded frames are
+// written straight into its slots, and raw frames are copied into them from the readback on the render thread,
+// so the consumer reads them in place.
+//
+// Windows only, like the OpenGL backend: encoder threads, locks, directories and the shared memory ring use Win32.
+//
+// Example:
+//
+//   auto capture = create_frame_capture(state, {.size = {1920, 1080}, .encoding = FrameEncoding_qoi, .path = u8"frames"s});
+//   while (...) {
+//       render(target);
+//       capture_frame(state, capture, target->color);
+//   }
+//   free(state, capture);
+
+enum FrameEncoding : u8 {
+	FrameEncoding_raw, // rgba, 4 bytes per pixel
+	FrameEncoding_qoi,
+	FrameEncoding_png,
+};
+
+enum FrameOutput : u8 {
+	FrameOutput_files,         // `path` is a directory, frames are named frame_000000.png and so on
+	FrameOutput_shared_memory, // `path` is the name of the file mapping
+};
+
+inline constexpr u32 frame_capture_readback_count = 3;
+
+struct FrameCaptureParams {
+	v2u size;
+	FrameEncoding encoding = FrameEncoding_png;
+	FrameOutput output = FrameOutput_files;
+	Span<utf8> path;
+
+	// 0 means one less than the number of logical processors.
+	u32 encoder_count = 0;
+
+	// Shared memory only.
+	u32 ring_slot_count = 8;
+	// When the consumer fell `ring_slot_count` frames behind, new frames are dropped instead of waited for.
+	bool drop_when_full = false;
+};
+
+struct FrameCaptureStats {
+	u64 captured_count; // calls to capture_frame
+	u64 written_count;  // frames written to files or published to the ring
+	u64 dropped_count;  // see FrameCaptureParams::drop_when_full
+	u64 failed_count;   // frames that could not be written
+
+	// Time the render thread spent waiting for readbacks, free buffers or ring slots.
+	f64 wait_ms;
+};
+
+// Layout of the shared memory:
+//   FrameRingHeader
+//   `slot_count` slots of `slot_stride` bytes, each a FrameRingSlot followed by the frame.
+//
+// Frame n of the ring is in slot n % slot_count. Frames [read_index, write_index) are complete.
+// The consumer reads them and then stores a new read_index, which makes their slots available again.
+// The event named after the mapping with "_written" appended is signaled after write_index is advanced.
+// The consumer must signal the event with "_read" appended after it stores read_index,
+// the producer waits for it when the ring is full.
+inline constexpr u32 frame_ring_magic = 0x52464754; // "TGFR"
+inline constexpr u32 frame_ring_version = 2;
+
+struct FrameRingHeader {
+	u32 magic;
+	u32 version;
+	u32 slot_count;
+	u32 slot_stride;
+	u32 slot_size; // bytes available for one frame
+	u32 width;
+	u32 height;
+	FrameEncoding encoding;
+
+	alignas(64) u64 volatile write_index; // written by the producer
+	alignas(64) u64 volatile read_index;  // written by the consumer
+};
+
+struct FrameRingSlot {
+	u64 frame_index; // index of the capture_frame call, frames skipped by drop_when_full leave gaps
+	u64 size;
+};
+
+struct FrameCapture;
+
+// Returns null if the output could not be created.
+TGRAPHICS_API FrameCapture *create_frame_capture(State *state, FrameCaptureParams const &params);
+
+// Waits until every captured frame is written, stops the encoders and closes the output.
+// Readbacks stay alive with the state.
+TGRAPHICS_API void free(State *state, FrameCapture *capture);
+
+// Starts reading `texture` back. Call it after the frame is rendered into it.
+TGRAPHICS_API void capture_frame(State *state, FrameCapture *capture, Texture2D *texture);
+
+// Waits until every captured frame is written.
+TGRAPHICS_API void flush(State *state, FrameCapture *capture);
+
+TGRAPHICS_API FrameCaptureStats get_stats(FrameCapture *capture);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+// Static, so the application can compile its own stb_image_write implementation next to this one.
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STBIW_ASSERT assert
+#include <stb_image_write.h>
+
+#include <stdio.h>
+
+namespace tgraphics {
+
+struct FrameCapture {
+	FrameCaptureParams params;
+	Allocator allocator;
+	u32 frame_size; // bytes of one raw frame
+	List<char> path; // null terminated
+
+	struct PendingReadback {
+		Readback *readback;
+		u64 frame_index;
+		bool busy;
+	};
+	PendingReadback readbacks[frame_capture_readback_count];
+	u32 next_readback;
+	u64 next_frame_index;
+
+	// Read back frames. A frame is free, queued or being encoded.
+	struct Frame {
+		u8 *pixels;
+		u64 frame_index;
+		u64 ring_index;
+	};
+	Frame *frames;
+	u32 frame_count;
+	u32 *free_frames;
+	u32 free_frame_count;
+	u32 *queue; // circular, of frame_count
+	u32 queue_start;
+	u32 queue_count;
+
+	SRWLOCK lock;
+	CONDITION_VARIABLE condition; // signaled when a frame is queued or freed
+	bool exit;
+
+	HANDLE *threads;
+	u32 thread_count;
+
+	// Shared memory.
+	HANDLE mapping;
+	HANDLE written_event;
+	HANDLE read_event;
+	FrameRingHeader *ring;
+	u64 next_ring_index;
+	u64 *ring_finished;  // ring index plus one of the frame last finished in each slot
+	SRWLOCK publish_lock;
+
+	FrameCaptureStats stats; // counters other than `captured_count` and `wait_ms` are updated under `lock`
+};
+
+namespace frame_capture {
+
+inline umm get_qoi_max_size(v2u size) {
+	return (umm)size.x * size.y * 5 + 14 + 8;
+}
+
+// https://qoiformat.org/qoi-specification.pdf
+// `output` must have get_qoi_max_size bytes. Returns the written size.
+inline umm encode_qoi(u8 const *pixels, v2u size, u8 *output) {
+	auto cursor = output;
+	auto write_u32_big_endian = [&](u32 value) {
+		*cursor++ = (u8)(value >> 24);
+		*cursor++ = (u8)(value >> 16);
+		*cursor++ = (u8)(value >> 8);
+		*cursor++ = (u8)value;
+	};
+
+	memcpy(cursor, "qoif", 4);
+	cursor += 4;
+	write_u32_big_endian(size.x);
+	write_u32_big_endian(size.y);
+	*cursor++ = 4; // channels
+	*cursor++ = 0; // sRGB with linear alpha
+
+	u32 index[64] = {};
+	u8 previous[4] = {0, 0, 0, 255};
+	u32 run = 0;
+
+	umm pixel_count = (umm)size.x * size.y;
+	for (umm i = 0; i < pixel_count; ++i) {
+		auto pixel = pixels + i * 4;
+
+		if (!memcmp(pixel, previous, 4)) {
+			++run;
+			if (run == 62 || i == pixel_count - 1) {
+				*cursor++ = (u8)(0xc0 | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+
+		if (run) {
+			*cursor++ = (u8)(0xc0 | (run - 1));
+			run = 0;
+		}
+
+		u32 value;
+		memcpy(&value, pixel, 4);
+		u32 hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+		if (index[hash] == value) {
+			*cursor++ = (u8)hash;
+		} else {
+			index[hash] = value;
+			if (pixel[3] == previous[3]) {
+				s8 dr = (s8)(pixel[0] - previous[0]);
+				s8 dg = (s8)(pixel[1] - previous[1]);
+				s8 db = (s8)(pixel[2] - previous[2]);
+				s8 dr_dg = (s8)(dr - dg);
+				s8 db_dg = (s8)(db - dg);
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+					*cursor++ = (u8)(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+				} else if (dr_dg >= -8 && dr_dg <= 7 && dg >= -32 && dg <= 31 && db_dg >= -8 && db_dg <= 7) {
+					*cursor++ = (u8)(0x80 | (dg + 32));
+					*cursor++ = (u8)(((dr_dg + 8) << 4) | (db_dg + 8));
+				} else {
+					*cursor++ = 0xfe;
+					*cursor++ = pixel[0];
+					*cursor++ = pixel[1];
+					*cursor++ = pixel[2];
+				}
+			} else {
+				*cursor++ = 0xff;
+				memcpy(cursor, pixel, 4);
+				cursor += 4;
+			}
+		}
+		memcpy(previous, pixel, 4);
+	}
+
+	u8 const end_marker[] = {0, 0, 0, 0, 0, 0, 0, 1};
+	memcpy(cursor, end_marker, sizeof(end_marker));
+	cursor += sizeof(end_marker);
+	return cursor - output;
+}
+
+inline void append_to_list(void *context, void *data, int size) {
+	auto &list = *(List<u8> *)context;
+	auto offset = list.count;
+	list.resize(offset + size);
+	memcpy(list.data + offset, data, size);
+}
+
+// Upper bound of an encoded frame. stb's deflate may expand incompressible data by an eighth.
+inline umm get_max_encoded_size(FrameEncoding encoding, v2u size) {
+	umm raw_size = (umm)size.x * size.y * 4;
+	switch (encoding) {
+		case FrameEncoding_raw: return raw_size;
+		case FrameEncoding_qoi: return get_qoi_max_size(size);
+		case FrameEncoding_png: return raw_size + raw_size / 8 + size.y + 1024;
+	}
+	invalid_code_path();
+	return 0;
+}
+
+inline char const *get_extension(FrameEncoding encoding) {
+	switch (encoding) {
+		case FrameEncoding_raw: return "rgba";
+		case FrameEncoding_qoi: return "qoi";
+		case FrameEncoding_png: return "png";
+	}
+	invalid_code_path();
+	return "";
+}
+
+inline List<wchar_t> to_wide(Span<utf8> string, wchar_t const *suffix = L"") {
+	List<wchar_t> result;
+	auto length = MultiByteToWideChar(CP_UTF8, 0, (char const *)string.data, (int)string.count, 0, 0);
+	auto suffix_length = wcslen(suffix);
+	result.resize(length + suffix_length + 1);
+	MultiByteToWideChar(CP_UTF8, 0, (char const *)string.data, (int)string.count, result.data, length);
+	memcpy(result.data + length, suffix, suffix_length * sizeof(wchar_t));
+	result[length + suffix_length] = 0;
+	return result;
+}
+
+inline FrameRingSlot *get_ring_slot(FrameCapture &capture, u64 ring_index) {
+	auto &ring = *capture.ring;
+	return (FrameRingSlot *)((u8 *)capture.ring + sizeof(FrameRingHeader) + (umm)(ring_index % ring.slot_count) * ring.slot_stride);
+}
+
+// Frames can finish out of order, write_index advances over the ones finished without a gap.
+inline void publish(FrameCapture &capture, u64 ring_index) {
+	auto &ring = *capture.ring;
+
+	AcquireSRWLockExclusive(&capture.publish_lock);
+	capture.ring_finished[ring_index % ring.slot_count] = ring_index + 1;
+	auto write_index = ring.write_index;
+	while (capture.ring_finished[write_index % ring.slot_count] == write_index + 1)
+		++write_index;
+	MemoryBarrier();
+	ring.write_index = write_index;
+	ReleaseSRWLockExclusive(&capture.publish_lock);
+
+	SetEvent(capture.written_event);
+}
+
+// Writes a frame whose pixels are in `frame` to its file or ring slot. Runs on an encoder thread.
+inline bool write_frame(FrameCapture &capture, FrameCapture::Frame const &frame, List<u8> &scratch) {
+	auto size = capture.params.size;
+
+	if (capture.params.output == FrameOutput_shared_memory) {
+		auto slot = get_ring_slot(capture, frame.ring_index);
+		auto data = (u8 *)(slot + 1);
+		umm encoded_size = 0;
+		switch (capture.params.encoding) {
+			case FrameEncoding_raw: {
+				memcpy(data, frame.pixels, capture.frame_size);
+				encoded_size = capture.frame_size;
+				break;
+			}
+			case FrameEncoding_qoi: {
+				encoded_size = encode_qoi(frame.pixels, size, data);
+				break;
+			}
+			case FrameEncoding_png: {
+				scratch.clear();
+				stbi_write_png_to_func(append_to_list, &scratch, size.x, size.y, 4, frame.pixels, size.x * 4);
+				encoded_size = scratch.count;
+				if (encoded_size <= capture.ring->slot_size)
+					memcpy(data, scratch.data, encoded_size);
+				break;
+			}
+		}
+
+		// An empty slot still has to be published, or later frames would never become visible.
+		bool succeeded = encoded_size && encoded_size <= capture.ring->slot_size;
+		slot->frame_index = frame.frame_index;
+		slot->size = succeeded ? encoded_size : 0;
+		publish(capture, frame.ring_index);
+		return succeeded;
+	}
+
+	Span<u8> encoded = {};
+	switch (capture.params.encoding) {
+		case FrameEncoding_raw: {
+			encoded = {frame.pixels, capture.frame_size};
+			break;
+		}
+		case FrameEncoding_qoi: {
+			scratch.resize(get_qoi_max_size(size));
+			encoded = {scratch.data, encode_qoi(frame.pixels, size, scratch.data)};
+			break;
+		}
+		case FrameEncoding_png: {
+			scratch.clear();
+			stbi_write_png_to_func(append_to_list, &scratch, size.x, size.y, 4, frame.pixels, size.x * 4);
+			encoded = scratch;
+			break;
+		}
+	}
+	if (!encoded.count)
+		return false;
+
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/frame_%06llu.%s", capture.path.data, (unsigned long long)frame.frame_index, get_extension(capture.params.encoding));
+	auto file = fopen(path, "wb");
+	if (!file)
+		return false;
+	auto written = fwrite(encoded.data, 1, encoded.count, file);
+	fclose(file);
+	return written == encoded.count;
+}
+
+inline DWORD WINAPI encoder_thread_proc(void *param) {
+	auto &capture = *(FrameCapture *)param;
+
+	List<u8> scratch;
+	defer { free(scratch); };
+
+	AcquireSRWLockExclusive(&capture.lock);
+	while (true) {
+		while (!capture.queue_count && !capture.exit) {
+			SleepConditionVariableSRW(&capture.condition, &capture.lock, INFINITE, 0);
+		}
+		if (!capture.queue_count)
+			break;
+
+		auto frame_index = capture.queue[capture.queue_start];
+		capture.queue_start = (capture.queue_start + 1) % capture.frame_count;
+		--capture.queue_count;
+		ReleaseSRWLockExclusive(&capture.lock);
+
+		auto succeeded = write_frame(capture, capture.frames[frame_index], scratch);
+
+		AcquireSRWLockExclusive(&capture.lock);
+		if (succeeded)
+			++capture.stats.written_count;
+		else
+			++capture.stats.failed_count;
+		capture.free_frames[capture.free_frame_count++] = frame_index;
+		WakeAllConditionVariable(&capture.condition);
+	}
+	ReleaseSRWLockExclusive(&capture.lock);
+	return 0;
+}
+
+inline f64 get_elapsed_ms(LARGE_INTEGER begin) {
+	LARGE_INTEGER end, frequency;
+	QueryPerformanceCounter(&end);
+	QueryPerformanceFrequency(&frequency);
+	return (end.QuadPart - begin.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+// Acquire, so the consumer is done with slots before the producer sees them as free.
+inline u64 load_read_index(FrameRingHeader &ring) {
+	return (u64)InterlockedCompareExchange64((LONG64 volatile *)&ring.read_index, 0, 0);
+}
+
+// Returns false if the frame is dropped. Waits for the consumer otherwise.
+inline bool reserve_ring_slot(FrameCapture &capture, u64 &ring_index) {
+	auto &ring = *capture.ring;
+	if (capture.next_ring_index - load_read_index(ring) >= ring.slot_count) {
+		if (capture.params.drop_when_full)
+			return false;
+
+		LARGE_INTEGER begin;
+		QueryPerformanceCounter(&begin);
+		while (capture.next_ring_index - load_read_index(ring) >= ring.slot_count)
+			WaitForSingleObject(capture.read_event, INFINITE);
+		capture.stats.wait_ms += get_elapsed_ms(begin);
+	}
+	ring_index = capture.next_ring_index++;
+	return true;
+}
+
+// Copies rows in reverse, OpenGL returns the bottom row first.
+inline void copy_flipped(u8 *destination, u8 const *source, v2u size) {
+	umm row_size = (umm)size.x * 4;
+	for (u32 y = 0; y < size.y; ++y)
+		memcpy(destination + y * row_size, source + (size.y - 1 - y) * row_size, row_size);
+}
+
+// Maps `readback`, counting the time until it is finished as waiting.
+inline u8 const *wait_and_map_readback(State *state, FrameCapture &capture, Readback *readback) {
+	if (state->is_readback_ready(readback))
+		return (u8 const *)state->map_readback(readback);
+
+	LARGE_INTEGER begin;
+	QueryPerformanceCounter(&begin);
+	auto result = (u8 const *)state->map_readback(readback);
+	capture.stats.wait_ms += get_elapsed_ms(begin);
+	return result;
+}
+
+// Moves a finished readback to the encoders. Blocks if the readback or the encoders are not done.
+inline void collect(State *state, FrameCapture &capture, FrameCapture::PendingReadback &pending) {
+	pending.busy = false;
+
+	u64 ring_index = 0;
+	if (capture.params.output == FrameOutput_shared_memory) {
+		if (!reserve_ring_slot(capture, ring_index)) {
+			AcquireSRWLockExclusive(&capture.lock);
+			++capture.stats.dropped_count;
+			ReleaseSRWLockExclusive(&capture.lock);
+			return;
+		}
+
+		// Nothing to encode, copy straight into the slot.
+		if (capture.params.encoding == FrameEncoding_raw) {
+			auto slot = get_ring_slot(capture, ring_index);
+			auto pixels = wait_and_map_readback(state, capture, pending.readback);
+			copy_flipped((u8 *)(slot + 1), pixels, capture.params.size);
+			state->unmap_readback(pending.readback);
+
+			slot->frame_index = pending.frame_index;
+			slot->size = capture.frame_size;
+			publish(capture, ring_index);
+
+			AcquireSRWLockExclusive(&capture.lock);
+			++capture.stats.written_count;
+			ReleaseSRWLockExclusive(&capture.lock);
+			return;
+		}
+	}
+
+	AcquireSRWLockExclusive(&capture.lock);
+	if (!capture.free_frame_count) {
+		LARGE_INTEGER begin;
+		QueryPerformanceCounter(&begin);
+		while (!capture.free_frame_count)
+			SleepConditionVariableSRW(&capture.condition, &capture.lock, INFINITE, 0);
+		capture.stats.wait_ms += get_elapsed_ms(begin);
+	}
+	auto frame_index = capture.free_frames[--capture.free_frame_count];
+	ReleaseSRWLockExclusive(&capture.lock);
+
+	auto &frame = capture.frames[frame_index];
+	frame.frame_index = pending.frame_index;
+	frame.ring_index = ring_index;
+
+	auto pixels = wait_and_map_readback(state, capture, pending.readback);
+	copy_flipped(frame.pixels, pixels, capture.params.size);
+	state->unmap_readback(pending.readback);
+
+	AcquireSRWLockExclusive(&capture.lock);
+	capture.queue[(capture.queue_start + capture.queue_count) % capture.frame_count] = frame_index;
+	++capture.queue_count;
+	WakeAllConditionVariable(&capture.condition);
+	ReleaseSRWLockExclusive(&capture.lock);
+}
+
+}
+
+FrameCapture *create_frame_capture(State *state, FrameCaptureParams const &params) {
+	using namespace frame_capture;
+
+	assert(params.size.x && params.size.y, "create_frame_capture: size is zero");
+	assert(params.ring_slot_count, "create_frame_capture: ring_slot_count is zero");
+
+	auto &capture = *state->allocator.allocate<FrameCapture>();
+	capture = {};
+	capture.params = params;
+	capture.params.path = {};
+	capture.allocator = state->allocator;
+	capture.frame_size = params.size.x * params.size.y * 4;
+	InitializeSRWLock(&capture.lock);
+	InitializeSRWLock(&capture.publish_lock);
+	InitializeConditionVariable(&capture.condition);
+
+	capture.path.resize(params.path.count + 1);
+	memcpy(capture.path.data, params.path.data, params.path.count);
+	capture.path[params.path.count] = 0;
+
+	if (params.output == FrameOutput_shared_memory) {
+		auto slot_size = get_max_encoded_size(params.encoding, params.size);
+		auto slot_stride = (sizeof(FrameRingSlot) + slot_size + 63) & ~(umm)63;
+		auto mapping_size = sizeof(FrameRingHeader) + slot_stride * params.ring_slot_count;
+
+		auto name = to_wide(params.path);
+		auto event_name = to_wide(params.path, L"_written");
+		auto read_event_name = to_wide(params.path, L"_read");
+		defer {
+			free(name);
+			free(event_name);
+			free(read_event_name);
+		};
+
+		capture.mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE, (DWORD)((u64)mapping_size >> 32), (DWORD)mapping_size, name.data);
+		capture.ring = capture.mapping ? (FrameRingHeader *)MapViewOfFile(capture.mapping, FILE_MAP_ALL_ACCESS, 0, 0, mapping_size) : 0;
+		capture.written_event = CreateEventW(0, FALSE, FALSE, event_name.data);
+		capture.read_event = CreateEventW(0, FALSE, FALSE, read_event_name.data);
+		if (!capture.ring || !capture.written_event || !capture.read_event || slot_stride > ~0u) {
+			print(Print_error, "create_frame_capture: failed to create shared memory {}\n", params.path);
+			if (capture.ring)
+				UnmapViewOfFile(capture.ring);
+			if (capture.mapping)
+				CloseHandle(capture.mapping);
+			if (capture.written_event)
+				CloseHandle(capture.written_event);
+			if (capture.read_event)
+				CloseHandle(capture.read_event);
+			free(capture.path);
+			state->allocator.free(&capture);
+			return 0;
+		}
+
+		auto &ring = *capture.ring;
+		ring.version = frame_ring_version;
+		ring.slot_count = params.ring_slot_count;
+		ring.slot_stride = (u32)slot_stride;
+		ring.slot_size = (u32)slot_size;
+		ring.width = params.size.x;
+		ring.height = params.size.y;
+		ring.encoding = params.encoding;
+		ring.write_index = 0;
+		ring.read_index = 0;
+		// Written last, consumers wait for it before reading the rest.
+		MemoryBarrier();
+		ring.magic = frame_ring_magic;
+
+		capture.ring_finished = state->allocator.allocate<u64>(params.ring_slot_count);
+		memset(capture.ring_finished, 0, params.ring_slot_count * sizeof(u64));
+	} else if (!CreateDirectoryA(capture.path.data, 0) && GetLastError() != ERROR_ALREADY_EXISTS) {
+		print(Print_error, "create_frame_capture: failed to create directory {}\n", params.path);
+		free(capture.path);
+		state->allocator.free(&capture);
+		return 0;
+	}
+
+	for (auto &pending : capture.readbacks) {
+		pending.readback = state->create_readback(capture.frame_size);
+		pending.busy = false;
+	}
+
+	capture.thread_count = params.encoder_count;
+	if (!capture.thread_count) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		capture.thread_count = max(info.dwNumberOfProcessors, 2ul) - 1;
+	}
+
+	// Every encoder has one frame to work on and one waiting.
+	capture.frame_count = capture.thread_count * 2;
+	capture.frames = state->allocator.allocate<FrameCapture::Frame>(capture.frame_count);
+	capture.free_frames = state->allocator.allocate<u32>(capture.frame_count);
+	capture.queue = state->allocator.allocate<u32>(capture.frame_count);
+	for (u32 i = 0; i < capture.frame_count; ++i) {
+		capture.frames[i].pixels = state->allocator.allocate<u8>(capture.frame_size);
+		capture.free_frames[i] = i;
+	}
+	capture.free_frame_count = capture.frame_count;
+
+	capture.threads = state->allocator.allocate<HANDLE>(capture.thread_count);
+	for (u32 i = 0; i < capture.thread_count; ++i)
+		capture.threads[i] = CreateThread(0, 0, encoder_thread_proc, &capture, 0, 0);
+
+	return &capture;
+}
+
+void capture_frame(State *state, FrameCapture *_capture, Texture2D *texture) {
+	using namespace frame_capture;
+
+	assert(_capture);
+	assert(texture);
+	auto &capture = *_capture;
+	assert(all_true(texture->size == capture.params.size), "capture_frame: texture size does not match FrameCaptureParams::size");
+	assert(((gl::Texture2DImpl *)texture)->bytes_per_texel == 4, "capture_frame: texture must be of Format_rgba_u8n");
+
+	++capture.stats.captured_count;
+
+	// The oldest readback is reused, it was started frame_capture_readback_count frames ago and is usually done.
+	auto &pending = capture.readbacks[capture.next_readback];
+	if (pending.busy)
+		collect(state, capture, pending);
+
+	state->read_texture_2d_async(texture, 0, pending.readback);
+	pending.frame_index = capture.next_frame_index++;
+	pending.busy = true;
+	capture.next_readback = (capture.next_readback + 1) % frame_capture_readback_count;
+
+	// Hand finished readbacks to the encoders early, oldest first so frames stay in order.
+	for (u32 i = 0; i < frame_capture_readback_count - 1; ++i) {
+		auto &older = capture.readbacks[(capture.next_readback + i) % frame_capture_readback_count];
+		if (!older.busy || !state->is_readback_ready(older.readback))
+			break;
+		collect(state, capture, older);
+	}
+}
+
+void flush(State *state, FrameCapture *_capture) {
+	using namespace frame_capture;
+
+	assert(_capture);
+	auto &capture = *_capture;
+
+	for (u32 i = 0; i < frame_capture_readback_count; ++i) {
+		auto &pending = capture.readbacks[(capture.next_readback + i) % frame_capture_readback_count];
+		if (pending.busy)
+			collect(state, capture, pending);
+	}
+
+	AcquireSRWLockExclusive(&capture.lock);
+	while (capture.free_frame_count != capture.frame_count)
+		SleepConditionVariableSRW(&capture.condition, &capture.lock, INFINITE, 0);
+	ReleaseSRWLockExclusive(&capture.lock);
+}
+
+FrameCaptureStats get_stats(FrameCapture *capture) {
+	assert(capture);
+	AcquireSRWLockShared(&capture->lock);
+	auto result = capture->stats;
+	ReleaseSRWLockShared(&capture->lock);
+	return result;
+}
+
+void free(State *state, FrameCapture *_capture) {
+	assert(_capture);
+	auto &capture = *_capture;
+
+	flush(state, &capture);
+
+	AcquireSRWLockExclusive(&capture.lock);
+	capture.exit = true;
+	WakeAllConditionVariable(&capture.condition);
+	ReleaseSRWLockExclusive(&capture.lock);
+
+	for (u32 i = 0; i < capture.thread_count; ++i) {
+		WaitForSingleObject(capture.threads[i], INFINITE);
+		CloseHandle(capture.threads[i]);
+	}
+
+	if (capture.ring) {
+		UnmapViewOfFile(capture.ring);
+		CloseHandle(capture.mapping);
+		CloseHandle(capture.written_event);
+		CloseHandle(capture.read_event);
+		capture.allocator.free(capture.ring_finished);
+	}
+
+	for (u32 i = 0; i < capture.frame_count; ++i)
+		capture.allocator.free(capture.frames[i].pixels);
+	capture.allocator.free(capture.frames);
+	capture.allocator.free(capture.free_frames);
+	capture.allocator.free(capture.queue);
+	capture.allocator.free(capture.threads);
+	free(capture.path);
+	capture.allocator.free(&capture);
+}
+
+}
+
+#endif
@@ -1,6 +1,12 @@
 state->_set_vsync = [](State *_state, bool enable) -> void { return ((StateGL *)_state)->impl_set_vsync(enable); };
 state->_on_window_resize = [](State *_state, u32 w, u32 h) -> void { return ((StateGL *)_state)->impl_on_window_resize(w, h); };
 state->_present = [](State *_state) -> void { return ((StateGL *)_state)->impl_present(); };
+state->_set_frame_pacing = [](State *_state, u32 max_frames_in_flight, bool low_latency) -> void { return ((StateGL *)_state)->impl_set_frame_pacing(max_frames_in_flight, low_latency); };
+state->_begin_frame = [](State *_state) -> void { return ((StateGL *)_state)->impl_begin_frame(); };
+state->_get_frame_timings = [](State *_state) -> FrameTimings { return ((StateGL *)_state)->impl_get_frame_timings(); };
+state->_insert_fence = [](State *_state) -> Fence { return ((StateGL *)_state)->impl_insert_fence(); };
+state->_is_signaled = [](State *_state, Fence fence) -> bool { return ((StateGL *)_state)->impl_is_signaled(fence); };
+state->_wait = [](State *_state, Fence fence) -> void { return ((StateGL *)_state)->impl_wait(fence); };
 state->_calculate_perspective_matrices = [](State *_state, v3f position, v3f rotation, f32 aspect_ratio, f32 fov_radians, f32 near_plane, f32 far_plane) -> CameraMatrices { return ((StateGL *)_state)->impl_calculate_perspective_matrices(position, rotation, aspect_ratio, fov_radians, near_plane, far_plane); };
 state->_set_blend = [](State *_state, BlendFunction function, Blend source, Blend destination) -> void { return ((StateGL *)_state)->impl_set_blend(function, source, destination); };
 state->_set_topology = [](State *_state, Topology topology) -> void { return ((StateGL *)_state)->impl_set_topology(topology); };
@@ -12,25 +18,54 @@ state->_disable_depth_clip = [](State *_state) -> void { return ((StateGL *)_sta
 state->_enable_depth_clip = [](State *_state) -> void { return ((StateGL *)_state)->impl_enable_depth_clip(); };
 state->_set_viewport = [](State *_state, s32 x, s32 y, u32 w, u32 h) -> void { return ((StateGL *)_state)->impl_set_viewport(x, y, w, h); };
 state->_draw = [](State *_state, u32 vertex_count, u32 start_vertex) -> void { return ((StateGL *)_state)->impl_draw(vertex_count, start_vertex); };
-state->_draw_indexed = [](State *_state, u32 index_count) -> void { return ((StateGL *)_state)->impl_draw_indexed(index_count); };
+state->_draw_instanced = [](State *_state, u32 vertex_count, u32 instance_count, u32 start_vertex, u32 start_instance) -> void { return ((StateGL *)_state)->impl_draw_instanced(vertex_count, instance_count, start_vertex, start_instance); };
+state->_draw_indexed = [](State *_state, u32 index_count, u32 first_index, s32 base_vertex) -> void { return ((StateGL *)_state)->impl_draw_indexed(index_count, first_index, base_vertex); };
+state->_draw_indexed_indirect = [](State *_state, ComputeBuffer * arguments, u32 offset, u32 draw_count, u32 stride) -> void { return ((StateGL *)_state)->impl_draw_indexed_indirect(arguments, offset, draw_count, stride); };
+state->_create_vertex_layout = [](State *_state, Span<VertexStream> streams) -> VertexLayout * { return ((StateGL *)_state)->impl_create_vertex_layout(streams); };
+state->_set_vertex_layout = [](State *_state, VertexLayout * layout) -> void { return ((StateGL *)_state)->impl_set_vertex_layout(layout); };
 state->_create_vertex_buffer = [](State *_state, Span<u8> buffer, Span<ElementType> vertex_descriptor) -> VertexBuffer * { return ((StateGL *)_state)->impl_create_vertex_buffer(buffer, vertex_descriptor); };
 state->_set_vertex_buffer = [](State *_state, VertexBuffer * buffer) -> void { return ((StateGL *)_state)->impl_set_vertex_buffer(buffer); };
+state->_set_vertex_buffers = [](State *_state, u32 slot, VertexBuffer * buffer, u32 offset, u32 stride) -> void { return ((StateGL *)_state)->impl_set_vertex_buffers(slot, buffer, offset, stride); };
 state->_update_vertex_buffer = [](State *_state, VertexBuffer * buffer, Span<u8> data) -> void { return ((StateGL *)_state)->impl_update_vertex_buffer(buffer, data); };
+state->_map_vertex_buffer = [](State *_state, VertexBuffer * buffer, Access access) -> void * { return ((StateGL *)_state)->impl_map_vertex_buffer(buffer, access); };
+state->_unmap_vertex_buffer = [](State *_state, VertexBuffer * buffer) -> void { return ((StateGL *)_state)->impl_unmap_vertex_buffer(buffer); };
 state->_create_index_buffer = [](State *_state, Span<u8> buffer, u32 index_size) -> IndexBuffer * { return ((StateGL *)_state)->impl_create_index_buffer(buffer, index_size); };
+state->_update_index_buffer = [](State *_state, IndexBuffer * buffer, Span<u8> data, u32 first_index) -> void { return ((StateGL *)_state)->impl_update_index_buffer(buffer, data, first_index); };
 state->_set_index_buffer = [](State *_state, IndexBuffer * buffer) -> void { return ((StateGL *)_state)->impl_set_index_buffer(buffer); };
 state->_create_texture_2d = [](State *_state, u32 width, u32 height, void const * data, Format format) -> Texture2D * { return ((StateGL *)_state)->impl_create_texture_2d(width, height, data, format); };
+state->_create_texture_2d_mipmapped = [](State *_state, u32 width, u32 height, u32 mip_count, Format format) -> Texture2D * { return ((StateGL *)_state)->impl_create_texture_2d_mipmapped(width, height, mip_count, format); };
+state->_create_texture_2d_multisampled = [](State *_state, u32 width, u32 height, Format format, u32 sample_count) -> Texture2D * { return ((StateGL *)_state)->impl_create_texture_2d_multisampled(width, height, format, sample_count); };
+state->_create_renderbuffer = [](State *_state, u32 width, u32 height, Format format, u32 sample_count) -> Texture2D * { return ((StateGL *)_state)->impl_create_renderbuffer(width, height, format, sample_count); };
 state->_set_texture_2d = [](State *_state, Texture2D * texture, u32 slot) -> void { return ((StateGL *)_state)->impl_set_texture_2d(texture, slot); };
 state->_resize_texture_2d = [](State *_state, Texture2D * texture, u32 w, u32 h) -> void { return ((StateGL *)_state)->impl_resize_texture_2d(texture, w, h); };
 state->_read_texture_2d = [](State *_state, Texture2D * texture, Span<u8> data) -> void { return ((StateGL *)_state)->impl_read_texture_2d(texture, data); };
+state->_create_readback = [](State *_state, u32 size) -> Readback * { return ((StateGL *)_state)->impl_create_readback(size); };
+state->_read_texture_2d_async = [](State *_state, Texture2D * texture, u32 mip, Readback * readback) -> void { return ((StateGL *)_state)->impl_read_texture_2d_async(texture, mip, readback); };
+state->_is_readback_ready = [](State *_state, Readback * readback) -> bool { return ((StateGL *)_state)->impl_is_readback_ready(readback); };
+state->_map_readback = [](State *_state, Readback * readback) -> void * { return ((StateGL *)_state)->impl_map_readback(readback); };
+state->_unmap_readback = [](State *_state, Readback * readback) -> void { return ((StateGL *)_state)->impl_unmap_readback(readback); };
 state->_update_texture_2d = [](State *_state, Texture2D * texture, u32 width, u32 height, void * data) -> void { return ((StateGL *)_state)->impl_update_texture_2d(texture, width, height, data); };
+state->_update_texture_2d_region = [](State *_state, Texture2D * texture, u32 x, u32 y, u32 width, u32 height, void const * data) -> void { return ((StateGL *)_state)->impl_update_texture_2d_region(texture, x, y, width, height, data); };
 state->_generate_mipmaps_2d = [](State *_state, Texture2D * texture) -> void { return ((StateGL *)_state)->impl_generate_mipmaps_2d(texture); };
 state->_set_sampler = [](State *_state, Filtering filtering, Comparison comparison, u32 slot) -> void { return ((StateGL *)_state)->impl_set_sampler(filtering, comparison, slot); };
 state->_create_render_target = [](State *_state, Texture2D * color, Texture2D * depth) -> RenderTarget * { return ((StateGL *)_state)->impl_create_render_target(color, depth); };
+state->_create_window_render_target = [](State *_state, Format color_format, Format depth_format, f32 scale) -> RenderTarget * { return ((StateGL *)_state)->impl_create_window_render_target(color_format, depth_format, scale); };
+state->_create_render_target_with_attachments = [](State *_state, Span<Texture2D *> colors, Texture2D * depth) -> RenderTarget * { return ((StateGL *)_state)->impl_create_render_target_with_attachments(colors, depth); };
+state->_resolve = [](State *_state, RenderTarget * source, RenderTarget * destination) -> void { return ((StateGL *)_state)->impl_resolve(source, destination); };
 state->_set_render_target = [](State *_state, RenderTarget * target) -> void { return ((StateGL *)_state)->impl_set_render_target(target); };
 state->_clear = [](State *_state, RenderTarget * render_target, ClearFlags flags, v4f color, f32 depth) -> void { return ((StateGL *)_state)->impl_clear(render_target, flags, color, depth); };
+state->_discard = [](State *_state, RenderTarget * render_target, ClearFlags flags) -> void { return ((StateGL *)_state)->impl_discard(render_target, flags); };
 state->_create_texture_cube = [](State *_state, u32 size, void ** data, Format format) -> TextureCube * { return ((StateGL *)_state)->impl_create_texture_cube(size, data, format); };
 state->_set_texture_cube = [](State *_state, TextureCube * texture, u32 slot) -> void { return ((StateGL *)_state)->impl_set_texture_cube(texture, slot); };
 state->_generate_mipmaps_cube = [](State *_state, TextureCube * texture, GenerateCubeMipmapParams params) -> void { return ((StateGL *)_state)->impl_generate_mipmaps_cube(texture, params); };
+state->_create_texture_2d_array = [](State *_state, u32 width, u32 height, u32 layer_count, u32 mip_count, Format format) -> Texture2DArray * { return ((StateGL *)_state)->impl_create_texture_2d_array(width, height, layer_count, mip_count, format); };
+state->_update_texture_2d_array_layer = [](State *_state, Texture2DArray * texture, u32 layer, void const * data) -> void { return ((StateGL *)_state)->impl_update_texture_2d_array_layer(texture, layer, data); };
+state->_generate_mipmaps_2d_array = [](State *_state, Texture2DArray * texture) -> void { return ((StateGL *)_state)->impl_generate_mipmaps_2d_array(texture); };
+state->_set_texture_2d_array = [](State *_state, Texture2DArray * texture, u32 slot) -> void { return ((StateGL *)_state)->impl_set_texture_2d_array(texture, slot); };
+state->_create_texture_cube_array = [](State *_state, u32 size, u32 layer_count, Format format) -> TextureCubeArray * { return ((StateGL *)_state)->impl_create_texture_cube_array(size, layer_count, format); };
+state->_update_texture_cube_array_layer = [](State *_state, TextureCubeArray * texture, u32 layer, void ** data) -> void { return ((StateGL *)_state)->impl_update_texture_cube_array_layer(texture, layer, data); };
+state->_generate_mipmaps_cube_array = [](State *_state, TextureCubeArray * texture) -> void { return ((StateGL *)_state)->impl_generate_mipmaps_cube_array(texture); };
+state->_set_texture_cube_array = [](State *_state, TextureCubeArray * texture, u32 slot) -> void { return ((StateGL *)_state)->impl_set_texture_cube_array(texture, slot); };
 state->_create_shader = [](State *_state, Span<utf8> source) -> Shader * { return ((StateGL *)_state)->impl_create_shader(source); };
 state->_set_shader = [](State *_state, Shader * shader) -> void { return ((StateGL *)_state)->impl_set_shader(shader); };
 state->_create_shader_constants = [](State *_state, umm size) -> ShaderConstants * { return ((StateGL *)_state)->impl_create_shader_constants(size); };
@@ -43,8 +78,11 @@ state->_get_rasterizer = [](State *_state) -> RasterizerState { return ((StateGL
 state->_create_compute_shader = [](State *_state, Span<utf8> source) -> ComputeShader * { return ((StateGL *)_state)->impl_create_compute_shader(source); };
 state->_set_compute_shader = [](State *_state, ComputeShader * shader) -> void { return ((StateGL *)_state)->impl_set_compute_shader(shader); };
 state->_dispatch_compute_shader = [](State *_state, u32 x, u32 y, u32 z) -> void { return ((StateGL *)_state)->impl_dispatch_compute_shader(x, y, z); };
+state->_dispatch_compute_indirect = [](State *_state, ComputeBuffer * arguments, u32 offset) -> void { return ((StateGL *)_state)->impl_dispatch_compute_indirect(arguments, offset); };
+state->_memory_barrier = [](State *_state, Barrier barriers) -> void { return ((StateGL *)_state)->impl_memory_barrier(barriers); };
 state->_create_compute_buffer = [](State *_state, u32 size) -> ComputeBuffer * { return ((StateGL *)_state)->impl_create_compute_buffer(size); };
 state->_read_compute_buffer = [](State *_state, ComputeBuffer * buffer, void * data) -> void { return ((StateGL *)_state)->impl_read_compute_buffer(buffer, data); };
+state->_update_compute_buffer = [](State *_state, ComputeBuffer * buffer, void const * data, u32 offset, u32 size) -> void { return ((StateGL *)_state)->impl_update_compute_buffer(buffer, data, offset, size); };
 state->_set_compute_buffer = [](State *_state, ComputeBuffer * buffer, u32 slot) -> void { return ((StateGL *)_state)->impl_set_compute_buffer(buffer, slot); };
-state->_set_compute_texture = [](State *_state, Texture2D * texture, u32 slot) -> void { return ((StateGL *)_state)->impl_set_compute_texture(texture, slot); };
+state->_set_compute_texture = [](State *_state, Texture2D * texture, u32 slot, u32 mip, Access access) -> void { return ((StateGL *)_state)->impl_set_compute_texture(texture, slot, mip, access); };
 state->_init_colored_rectangle_shader = [](State *_state) -> void { return ((StateGL *)_state)->impl_init_colored_rectangle_shader(); };
@@ -0,0 +1,88 @@
+ApiCall_set_vsync,
+ApiCall_on_window_resize,
+ApiCall_present,
+ApiCall_set_frame_pacing,
+ApiCall_begin_frame,
+ApiCall_get_frame_timings,
+ApiCall_insert_fence,
+ApiCall_is_signaled,
+ApiCall_wait,
+ApiCall_calculate_perspective_matrices,
+ApiCall_set_blend,
+ApiCall_set_topology,
+ApiCall_set_scissor,
+ApiCall_disable_scissor,
+ApiCall_set_cull,
+ApiCall_disable_blend,
+ApiCall_disable_depth_clip,
+ApiCall_enable_depth_clip,
+ApiCall_set_viewport,
+ApiCall_draw,
+ApiCall_draw_instanced,
+ApiCall_draw_indexed,
+ApiCall_draw_indexed_indirect,
+ApiCall_create_vertex_layout,
+ApiCall_set_vertex_layout,
+ApiCall_create_vertex_buffer,
+ApiCall_set_vertex_buffer,
+ApiCall_set_vertex_buffers,
+ApiCall_update_vertex_buffer,
+ApiCall_map_vertex_buffer,
+ApiCall_unmap_vertex_buffer,
+ApiCall_create_index_buffer,
+ApiCall_update_index_buffer,
+ApiCall_set_index_buffer,
+ApiCall_create_texture_2d,
+ApiCall_create_texture_2d_mipmapped,
+ApiCall_create_texture_2d_multisampled,
+ApiCall_create_renderbuffer,
+ApiCall_set_texture_2d,
+ApiCall_resize_texture_2d,
+ApiCall_read_texture_2d,
+ApiCall_create_readback,
+ApiCall_read_texture_2d_async,
+ApiCall_is_readback_ready,
+ApiCall_map_readback,
+ApiCall_unmap_readback,
+ApiCall_update_texture_2d,
+ApiCall_update_texture_2d_region,
+ApiCall_generate_mipmaps_2d,
+ApiCall_set_sampler,
+ApiCall_create_render_target,
+ApiCall_create_window_render_target,
+ApiCall_create_render_target_with_attachments,
+ApiCall_resolve,
+ApiCall_set_render_target,
+ApiCall_clear,
+ApiCall_discard,
+ApiCall_create_texture_cube,
+ApiCall_set_texture_cube,
+ApiCall_generate_mipmaps_cube,
+ApiCall_create_texture_2d_array,
+ApiCall_update_texture_2d_array_layer,
+ApiCall_generate_mipmaps_2d_array,
+ApiCall_set_texture_2d_array,
+ApiCall_create_texture_cube_array,
+ApiCall_update_texture_cube_array_layer,
+ApiCall_generate_mipmaps_cube_array,
+ApiCall_set_texture_cube_array,
+ApiCall_create_shader,
+ApiCall_set_shader,
+ApiCall_create_shader_constants,
+ApiCall_update_shader_constants,
+ApiCall_map_shader_constants,
+ApiCall_unmap_shader_constants,
+ApiCall_set_shader_constants,
+ApiCall_set_rasterizer,
+ApiCall_get_rasterizer,
+ApiCall_create_compute_shader,
+ApiCall_set_compute_shader,
+ApiCall_dispatch_compute_shader,
+ApiCall_dispatch_compute_indirect,
+ApiCall_memory_barrier,
+ApiCall_create_compute_buffer,
+ApiCall_read_compute_buffer,
+ApiCall_update_compute_buffer,
+ApiCall_set_compute_buffer,
+ApiCall_set_compute_texture,
+ApiCall_init_colored_rectangle_shader,
@@ -0,0 +1,84 @@
+state->_set_vsync = [](State *_state, bool enable) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_vsync); if (call.recording) { write_value(capture, enable); } capture.original._set_vsync(_state, enable); };
+state->_on_window_resize = [](State *_state, u32 w, u32 h) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_on_window_resize); if (call.recording) { write_value(capture, w); write_value(capture, h); } capture.original._on_window_resize(_state, w, h); };
+state->_present = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_present); if (call.recording) { } capture.original._present(_state); };
+state->_set_frame_pacing = [](State *_state, u32 max_frames_in_flight, bool low_latency) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_frame_pacing); if (call.recording) { write_value(capture, max_frames_in_flight); write_value(capture, low_latency); } capture.original._set_frame_pacing(_state, max_frames_in_flight, low_latency); };
+state->_begin_frame = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_begin_frame); if (call.recording) { } capture.original._begin_frame(_state); };
+state->_get_frame_timings = [](State *_state) -> FrameTimings { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_get_frame_timings); if (call.recording) { } auto result = capture.original._get_frame_timings(_state); if (call.recording) capture_result(capture, result); return result; };
+state->_insert_fence = [](State *_state) -> Fence { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_insert_fence); if (call.recording) { } auto result = capture.original._insert_fence(_state); if (call.recording) capture_result(capture, result); return result; };
+state->_is_signaled = [](State *_state, Fence fence) -> bool { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_is_signaled); if (call.recording) { write_value(capture, fence); } auto result = capture.original._is_signaled(_state, fence); if (call.recording) capture_result(capture, result); return result; };
+state->_wait = [](State *_state, Fence fence) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_wait); if (call.recording) { write_value(capture, fence); } capture.original._wait(_state, fence); };
+state->_calculate_perspective_matrices = [](State *_state, v3f position, v3f rotation, f32 aspect_ratio, f32 fov_radians, f32 near_plane, f32 far_plane) -> CameraMatrices { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_calculate_perspective_matrices); if (call.recording) { write_value(capture, position); write_value(capture, rotation); write_value(capture, aspect_ratio); write_value(capture, fov_radians); write_value(capture, near_plane); write_value(capture, far_plane); } auto result = capture.original._calculate_perspective_matrices(_state, position, rotation, aspect_ratio, fov_radians, near_plane, far_plane); if (call.recording) capture_result(capture, result); return result; };
+state->_set_blend = [](State *_state, BlendFunction function, Blend source, Blend destination) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_blend); if (call.recording) { write_value(capture, function); write_value(capture, source); write_value(capture, destination); } capture.original._set_blend(_state, function, source, destination); };
+state->_set_topology = [](State *_state, Topology topology) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_topology); if (call.recording) { write_value(capture, topology); } capture.original._set_topology(_state, topology); };
+state->_set_scissor = [](State *_state, s32 x, s32 y, u32 w, u32 h) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_scissor); if (call.recording) { write_value(capture, x); write_value(capture, y); write_value(capture, w); write_value(capture, h); } capture.original._set_scissor(_state, x, y, w, h); };
+state->_disable_scissor = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_disable_scissor); if (call.recording) { } capture.original._disable_scissor(_state); };
+state->_set_cull = [](State *_state, Cull cull) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_cull); if (call.recording) { write_value(capture, cull); } capture.original._set_cull(_state, cull); };
+state->_disable_blend = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_disable_blend); if (call.recording) { } capture.original._disable_blend(_state); };
+state->_disable_depth_clip = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_disable_depth_clip); if (call.recording) { } capture.original._disable_depth_clip(_state); };
+state->_enable_depth_clip = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_enable_depth_clip); if (call.recording) { } capture.original._enable_depth_clip(_state); };
+state->_set_viewport = [](State *_state, s32 x, s32 y, u32 w, u32 h) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_viewport); if (call.recording) { write_value(capture, x); write_value(capture, y); write_value(capture, w); write_value(capture, h); } capture.original._set_viewport(_state, x, y, w, h); };
+state->_draw = [](State *_state, u32 vertex_count, u32 start_vertex) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_draw); if (call.recording) { write_value(capture, vertex_count); write_value(capture, start_vertex); } capture.original._draw(_state, vertex_count, start_vertex); };
+state->_draw_instanced = [](State *_state, u32 vertex_count, u32 instance_count, u32 start_vertex, u32 start_instance) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_draw_instanced); if (call.recording) { write_value(capture, vertex_count); write_value(capture, instance_count); write_value(capture, start_vertex); write_value(capture, start_instance); } capture.original._draw_instanced(_state, vertex_count, instance_count, start_vertex, start_instance); };
+state->_draw_indexed = [](State *_state, u32 index_count, u32 first_index, s32 base_vertex) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_draw_indexed); if (call.recording) { write_value(capture, index_count); write_value(capture, first_index); write_value(capture, base_vertex); } capture.original._draw_indexed(_state, index_count, first_index, base_vertex); };
+state->_draw_indexed_indirect = [](State *_state, ComputeBuffer * arguments, u32 offset, u32 draw_count, u32 stride) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_draw_indexed_indirect); if (call.recording) { write_value(capture, arguments); write_value(capture, offset); write_value(capture, draw_count); write_value(capture, stride); } capture.original._draw_indexed_indirect(_state, arguments, offset, draw_count, stride); };
+state->_create_vertex_layout = [](State *_state, Span<VertexStream> streams) -> VertexLayout * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_vertex_layout); if (call.recording) { write_value(capture, streams); } auto result = capture.original._create_vertex_layout(_state, streams); if (call.recording) capture_result(capture, result); return result; };
+state->_set_vertex_layout = [](State *_state, VertexLayout * layout) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_vertex_layout); if (call.recording) { write_value(capture, layout); } capture.original._set_vertex_layout(_state, layout); };
+state->_create_vertex_buffer = [](State *_state, Span<u8> buffer, Span<ElementType> vertex_descriptor) -> VertexBuffer * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_vertex_buffer); if (call.recording) { write_value(capture, buffer); write_value(capture, vertex_descriptor); } auto result = capture.original._create_vertex_buffer(_state, buffer, vertex_descriptor); if (call.recording) capture_result(capture, result); return result; };
+state->_set_vertex_buffer = [](State *_state, VertexBuffer * buffer) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_vertex_buffer); if (call.recording) { write_value(capture, buffer); } capture.original._set_vertex_buffer(_state, buffer); };
+state->_set_vertex_buffers = [](State *_state, u32 slot, VertexBuffer * buffer, u32 offset, u32 stride) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_vertex_buffers); if (call.recording) { write_value(capture, slot); write_value(capture, buffer); write_value(capture, offset); write_value(capture, stride); } capture.original._set_vertex_buffers(_state, slot, buffer, offset, stride); };
+state->_update_vertex_buffer = [](State *_state, VertexBuffer * buffer, Span<u8> data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_vertex_buffer); if (call.recording) { write_value(capture, buffer); write_value(capture, data); } capture.original._update_vertex_buffer(_state, buffer, data); };
+state->_create_index_buffer = [](State *_state, Span<u8> buffer, u32 index_size) -> IndexBuffer * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_index_buffer); if (call.recording) { write_value(capture, buffer); write_value(capture, index_size); } auto result = capture.original._create_index_buffer(_state, buffer, index_size); if (call.recording) capture_result(capture, result); return result; };
+state->_update_index_buffer = [](State *_state, IndexBuffer * buffer, Span<u8> data, u32 first_index) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_index_buffer); if (call.recording) { write_value(capture, buffer); write_value(capture, data); write_value(capture, first_index); } capture.original._update_index_buffer(_state, buffer, data, first_index); };
+state->_set_index_buffer = [](State *_state, IndexBuffer * buffer) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_index_buffer); if (call.recording) { write_value(capture, buffer); } capture.original._set_index_buffer(_state, buffer); };
+state->_create_texture_2d = [](State *_state, u32 width, u32 height, void const * data, Format format) -> Texture2D * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_texture_2d); if (call.recording) { write_value(capture, width); write_value(capture, height); write_data(capture, data, data_size_create_texture_2d(width, height, data, format)); write_value(capture, format); } auto result = capture.original._create_texture_2d(_state, width, height, data, format); if (call.recording) capture_result(capture, result); return result; };
+state->_create_texture_2d_mipmapped = [](State *_state, u32 width, u32 height, u32 mip_count, Format format) -> Texture2D * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_texture_2d_mipmapped); if (call.recording) { write_value(capture, width); write_value(capture, height); write_value(capture, mip_count); write_value(capture, format); } auto result = capture.original._create_texture_2d_mipmapped(_state, width, height, mip_count, format); if (call.recording) capture_result(capture, result); return result; };
+state->_create_texture_2d_multisampled = [](State *_state, u32 width, u32 height, Format format, u32 sample_count) -> Texture2D * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_texture_2d_multisampled); if (call.recording) { write_value(capture, width); write_value(capture, height); write_value(capture, format); write_value(capture, sample_count); } auto result = capture.original._create_texture_2d_multisampled(_state, width, height, format, sample_count); if (call.recording) capture_result(capture, result); return result; };
+state->_create_renderbuffer = [](State *_state, u32 width, u32 height, Format format, u32 sample_count) -> Texture2D * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_renderbuffer); if (call.recording) { write_value(capture, width); write_value(capture, height); write_value(capture, format); write_value(capture, sample_count); } auto result = capture.original._create_renderbuffer(_state, width, height, format, sample_count); if (call.recording) capture_result(capture, result); return result; };
+state->_set_texture_2d = [](State *_state, Texture2D * texture, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_texture_2d); if (call.recording) { write_value(capture, texture); write_value(capture, slot); } capture.original._set_texture_2d(_state, texture, slot); };
+state->_resize_texture_2d = [](State *_state, Texture2D * texture, u32 w, u32 h) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_resize_texture_2d); if (call.recording) { write_value(capture, texture); write_value(capture, w); write_value(capture, h); } capture.original._resize_texture_2d(_state, texture, w, h); };
+state->_read_texture_2d = [](State *_state, Texture2D * texture, Span<u8> data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_read_texture_2d); if (call.recording) { write_value(capture, texture); write_value(capture, data); } capture.original._read_texture_2d(_state, texture, data); };
+state->_create_readback = [](State *_state, u32 size) -> Readback * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_readback); if (call.recording) { write_value(capture, size); } auto result = capture.original._create_readback(_state, size); if (call.recording) capture_result(capture, result); return result; };
+state->_read_texture_2d_async = [](State *_state, Texture2D * texture, u32 mip, Readback * readback) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_read_texture_2d_async); if (call.recording) { write_value(capture, texture); write_value(capture, mip); write_value(capture, readback); } capture.original._read_texture_2d_async(_state, texture, mip, readback); };
+state->_is_readback_ready = [](State *_state, Readback * readback) -> bool { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_is_readback_ready); if (call.recording) { write_value(capture, readback); } auto result = capture.original._is_readback_ready(_state, readback); if (call.recording) capture_result(capture, result); return result; };
+state->_map_readback = [](State *_state, Readback * readback) -> void * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_map_readback); if (call.recording) { write_value(capture, readback); } auto result = capture.original._map_readback(_state, readback); if (call.recording) capture_result(capture, result); return result; };
+state->_unmap_readback = [](State *_state, Readback * readback) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_unmap_readback); if (call.recording) { write_value(capture, readback); } capture.original._unmap_readback(_state, readback); };
+state->_update_texture_2d = [](State *_state, Texture2D * texture, u32 width, u32 height, void * data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_texture_2d); if (call.recording) { write_value(capture, texture); write_value(capture, width); write_value(capture, height); write_data(capture, data, data_size_update_texture_2d(texture, width, height, data)); } capture.original._update_texture_2d(_state, texture, width, height, data); };
+state->_update_texture_2d_region = [](State *_state, Texture2D * texture, u32 x, u32 y, u32 width, u32 height, void const * data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_texture_2d_region); if (call.recording) { write_value(capture, texture); write_value(capture, x); write_value(capture, y); write_value(capture, width); write_value(capture, height); write_data(capture, data, data_size_update_texture_2d_region(texture, x, y, width, height, data)); } capture.original._update_texture_2d_region(_state, texture, x, y, width, height, data); };
+state->_generate_mipmaps_2d = [](State *_state, Texture2D * texture) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_generate_mipmaps_2d); if (call.recording) { write_value(capture, texture); } capture.original._generate_mipmaps_2d(_state, texture); };
+state->_set_sampler = [](State *_state, Filtering filtering, Comparison comparison, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_sampler); if (call.recording) { write_value(capture, filtering); write_value(capture, comparison); write_value(capture, slot); } capture.original._set_sampler(_state, filtering, comparison, slot); };
+state->_create_render_target = [](State *_state, Texture2D * color, Texture2D * depth) -> RenderTarget * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_render_target); if (call.recording) { write_value(capture, color); write_value(capture, depth); } auto result = capture.original._create_render_target(_state, color, depth); if (call.recording) capture_result(capture, result); return result; };
+state->_create_window_render_target = [](State *_state, Format color_format, Format depth_format, f32 scale) -> RenderTarget * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_window_render_target); if (call.recording) { write_value(capture, color_format); write_value(capture, depth_format); write_value(capture, scale); } auto result = capture.original._create_window_render_target(_state, color_format, depth_format, scale); if (call.recording) capture_result(capture, result); return result; };
+state->_create_render_target_with_attachments = [](State *_state, Span<Texture2D *> colors, Texture2D * depth) -> RenderTarget * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_render_target_with_attachments); if (call.recording) { write_value(capture, colors); write_value(capture, depth); } auto result = capture.original._create_render_target_with_attachments(_state, colors, depth); if (call.recording) capture_result(capture, result); return result; };
+state->_resolve = [](State *_state, RenderTarget * source, RenderTarget * destination) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_resolve); if (call.recording) { write_value(capture, source); write_value(capture, destination); } capture.original._resolve(_state, source, destination); };
+state->_set_render_target = [](State *_state, RenderTarget * target) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_render_target); if (call.recording) { write_value(capture, target); } capture.original._set_render_target(_state, target); };
+state->_clear = [](State *_state, RenderTarget * render_target, ClearFlags flags, v4f color, f32 depth) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_clear); if (call.recording) { write_value(capture, render_target); write_value(capture, flags); write_value(capture, color); write_value(capture, depth); } capture.original._clear(_state, render_target, flags, color, depth); };
+state->_discard = [](State *_state, RenderTarget * render_target, ClearFlags flags) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_discard); if (call.recording) { write_value(capture, render_target); write_value(capture, flags); } capture.original._discard(_state, render_target, flags); };
+state->_create_texture_cube = [](State *_state, u32 size, void ** data, Format format) -> TextureCube * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_texture_cube); if (call.recording) { write_value(capture, size); write_faces(capture, data, data_size_create_texture_cube(size, data, format)); write_value(capture, format); } auto result = capture.original._create_texture_cube(_state, size, data, format); if (call.recording) capture_result(capture, result); return result; };
+state->_set_texture_cube = [](State *_state, TextureCube * texture, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_texture_cube); if (call.recording) { write_value(capture, texture); write_value(capture, slot); } capture.original._set_texture_cube(_state, texture, slot); };
+state->_generate_mipmaps_cube = [](State *_state, TextureCube * texture, GenerateCubeMipmapParams params) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_generate_mipmaps_cube); if (call.recording) { write_value(capture, texture); write_value(capture, params); } capture.original._generate_mipmaps_cube(_state, texture, params); };
+state->_create_texture_2d_array = [](State *_state, u32 width, u32 height, u32 layer_count, u32 mip_count, Format format) -> Texture2DArray * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_texture_2d_array); if (call.recording) { write_value(capture, width); write_value(capture, height); write_value(capture, layer_count); write_value(capture, mip_count); write_value(capture, format); } auto result = capture.original._create_texture_2d_array(_state, width, height, layer_count, mip_count, format); if (call.recording) capture_result(capture, result); return result; };
+state->_update_texture_2d_array_layer = [](State *_state, Texture2DArray * texture, u32 layer, void const * data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_texture_2d_array_layer); if (call.recording) { write_value(capture, texture); write_value(capture, layer); write_data(capture, data, data_size_update_texture_2d_array_layer(texture, layer, data)); } capture.original._update_texture_2d_array_layer(_state, texture, layer, data); };
+state->_generate_mipmaps_2d_array = [](State *_state, Texture2DArray * texture) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_generate_mipmaps_2d_array); if (call.recording) { write_value(capture, texture); } capture.original._generate_mipmaps_2d_array(_state, texture); };
+state->_set_texture_2d_array = [](State *_state, Texture2DArray * texture, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_texture_2d_array); if (call.recording) { write_value(capture, texture); write_value(capture, slot); } capture.original._set_texture_2d_array(_state, texture, slot); };
+state->_create_texture_cube_array = [](State *_state, u32 size, u32 layer_count, Format format) -> TextureCubeArray * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_texture_cube_array); if (call.recording) { write_value(capture, size); write_value(capture, layer_count); write_value(capture, format); } auto result = capture.original._create_texture_cube_array(_state, size, layer_count, format); if (call.recording) capture_result(capture, result); return result; };
+state->_update_texture_cube_array_layer = [](State *_state, TextureCubeArray * texture, u32 layer, void ** data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_texture_cube_array_layer); if (call.recording) { write_value(capture, texture); write_value(capture, layer); write_faces(capture, data, data_size_update_texture_cube_array_layer(texture, layer, data)); } capture.original._update_texture_cube_array_layer(_state, texture, layer, data); };
+state->_generate_mipmaps_cube_array = [](State *_state, TextureCubeArray * texture) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_generate_mipmaps_cube_array); if (call.recording) { write_value(capture, texture); } capture.original._generate_mipmaps_cube_array(_state, texture); };
+state->_set_texture_cube_array = [](State *_state, TextureCubeArray * texture, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_texture_cube_array); if (call.recording) { write_value(capture, texture); write_value(capture, slot); } capture.original._set_texture_cube_array(_state, texture, slot); };
+state->_create_shader = [](State *_state, Span<utf8> source) -> Shader * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_shader); if (call.recording) { write_value(capture, source); } auto result = capture.original._create_shader(_state, source); if (call.recording) capture_result(capture, result); return result; };
+state->_set_shader = [](State *_state, Shader * shader) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_shader); if (call.recording) { write_value(capture, shader); } capture.original._set_shader(_state, shader); };
+state->_create_shader_constants = [](State *_state, umm size) -> ShaderConstants * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_shader_constants); if (call.recording) { write_value(capture, size); } auto result = capture.original._create_shader_constants(_state, size); if (call.recording) capture_result(capture, result); return result; };
+state->_update_shader_constants = [](State *_state, ShaderConstants * constants, void const * source, u32 offset, u32 size) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_shader_constants); if (call.recording) { write_value(capture, constants); write_data(capture, source, data_size_update_shader_constants(constants, source, offset, size)); write_value(capture, offset); write_value(capture, size); } capture.original._update_shader_constants(_state, constants, source, offset, size); };
+state->_set_shader_constants = [](State *_state, ShaderConstants * constants, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_shader_constants); if (call.recording) { write_value(capture, constants); write_value(capture, slot); } capture.original._set_shader_constants(_state, constants, slot); };
+state->_set_rasterizer = [](State *_state, RasterizerState state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_rasterizer); if (call.recording) { write_value(capture, state); } capture.original._set_rasterizer(_state, state); };
+state->_get_rasterizer = [](State *_state) -> RasterizerState { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_get_rasterizer); if (call.recording) { } auto result = capture.original._get_rasterizer(_state); if (call.recording) capture_result(capture, result); return result; };
+state->_create_compute_shader = [](State *_state, Span<utf8> source) -> ComputeShader * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_compute_shader); if (call.recording) { write_value(capture, source); } auto result = capture.original._create_compute_shader(_state, source); if (call.recording) capture_result(capture, result); return result; };
+state->_set_compute_shader = [](State *_state, ComputeShader * shader) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_compute_shader); if (call.recording) { write_value(capture, shader); } capture.original._set_compute_shader(_state, shader); };
+state->_dispatch_compute_shader = [](State *_state, u32 x, u32 y, u32 z) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_dispatch_compute_shader); if (call.recording) { write_value(capture, x); write_value(capture, y); write_value(capture, z); } capture.original._dispatch_compute_shader(_state, x, y, z); };
+state->_dispatch_compute_indirect = [](State *_state, ComputeBuffer * arguments, u32 offset) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_dispatch_compute_indirect); if (call.recording) { write_value(capture, arguments); write_value(capture, offset); } capture.original._dispatch_compute_indirect(_state, arguments, offset); };
+state->_memory_barrier = [](State *_state, Barrier barriers) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_memory_barrier); if (call.recording) { write_value(capture, barriers); } capture.original._memory_barrier(_state, barriers); };
+state->_create_compute_buffer = [](State *_state, u32 size) -> ComputeBuffer * { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_create_compute_buffer); if (call.recording) { write_value(capture, size); } auto result = capture.original._create_compute_buffer(_state, size); if (call.recording) capture_result(capture, result); return result; };
+state->_read_compute_buffer = [](State *_state, ComputeBuffer * buffer, void * data) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_read_compute_buffer); if (call.recording) { write_value(capture, buffer); write_data(capture, data, data_size_read_compute_buffer(buffer, data)); } capture.original._read_compute_buffer(_state, buffer, data); };
+state->_update_compute_buffer = [](State *_state, ComputeBuffer * buffer, void const * data, u32 offset, u32 size) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_update_compute_buffer); if (call.recording) { write_value(capture, buffer); write_data(capture, data, data_size_update_compute_buffer(buffer, data, offset, size)); write_value(capture, offset); write_value(capture, size); } capture.original._update_compute_buffer(_state, buffer, data, offset, size); };
+state->_set_compute_buffer = [](State *_state, ComputeBuffer * buffer, u32 slot) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_compute_buffer); if (call.recording) { write_value(capture, buffer); write_value(capture, slot); } capture.original._set_compute_buffer(_state, buffer, slot); };
+state->_set_compute_texture = [](State *_state, Texture2D * texture, u32 slot, u32 mip, Access access) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_set_compute_texture); if (call.recording) { write_value(capture, texture); write_value(capture, slot); write_value(capture, mip); write_value(capture, access); } capture.original._set_compute_texture(_state, texture, slot, mip, access); };
+state->_init_colored_rectangle_shader = [](State *_state) -> void { auto &capture = *_state->capture; TraceCall call(capture, ApiCall_init_colored_rectangle_shader); if (call.recording) { } capture.original._init_colored_rectangle_shader(_state); };
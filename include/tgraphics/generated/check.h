@@ -1,6 +1,12 @@
 if(!state->_set_vsync){print("set_vsync was not initialized.\n");result=false;}
 if(!state->_on_window_resize){print("on_window_resize was not initialized.\n");result=false;}
 if(!state->_present){print("present was not initialized.\n");result=false;}
+if(!state->_set_frame_pacing){print("set_frame_pacing was not initialized.\n");result=false;}
+if(!state->_begin_frame){print("begin_frame was not initialized.\n");result=false;}
+if(!state->_get_frame_timings){print("get_frame_timings was not initialized.\n");result=false;}
+if(!state->_insert_fence){print("insert_fence was not initialized.\n");result=false;}
+if(!state->_is_signaled){print("is_signaled was not initialized.\n");result=false;}
+if(!state->_wait){print("wait was not initialized.\n");result=false;}
 if(!state->_calculate_perspective_matrices){print("calculate_perspective_matrices was not initialized.\n");result=false;}
 if(!state->_set_blend){print("set_blend was not initialized.\n");result=false;}
 if(!state->_set_topology){print("set_topology was not initialized.\n");result=false;}
@@ -12,25 +18,54 @@ if(!state->_disable_depth_clip){print("disable_depth_clip was not initialized.\n
 if(!state->_enable_depth_clip){print("enable_depth_clip was not initialized.\n");result=false;}
 if(!state->_set_viewport){print("set_viewport was not initialized.\n");result=false;}
 if(!state->_draw){print("draw was not initialized.\n");result=false;}
+if(!state->_draw_instanced){print("draw_instanced was not initialized.\n");result=false;}
 if(!state->_draw_indexed){print("draw_indexed was not initialized.\n");result=false;}
+if(!state->_draw_indexed_indirect){print("draw_indexed_indirect was not initialized.\n");result=false;}
+if(!state->_create_vertex_layout){print("create_vertex_layout was not initialized.\n");result=false;}
+if(!state->_set_vertex_layout){print("set_vertex_layout was not initialized.\n");result=false;}
 if(!state->_create_vertex_buffer){print("create_vertex_buffer was not initialized.\n");result=false;}
 if(!state->_set_vertex_buffer){print("set_vertex_buffer was not initialized.\n");result=false;}
+if(!state->_set_vertex_buffers){print("set_vertex_buffers was not initialized.\n");result=false;}
 if(!state->_update_vertex_buffer){print("update_vertex_buffer was not initialized.\n");result=false;}
+if(!state->_map_vertex_buffer){print("map_vertex_buffer was not initialized.\n");result=false;}
+if(!state->_unmap_vertex_buffer){print("unmap_vertex_buffer was not initialized.\n");result=false;}
 if(!state->_create_index_buffer){print("create_index_buffer was not initialized.\n");result=false;}
+if(!state->_update_index_buffer){print("update_index_buffer was not initialized.\n");result=false;}
 if(!state->_set_index_buffer){print("set_index_buffer was not initialized.\n");result=false;}
 if(!state->_create_texture_2d){print("create_texture_2d was not initialized.\n");result=false;}
+if(!state->_create_texture_2d_mipmapped){print("create_texture_2d_mipmapped was not initialized.\n");result=false;}
+if(!state->_create_texture_2d_multisampled){print("create_texture_2d_multisampled was not initialized.\n");result=false;}
+if(!state->_create_renderbuffer){print("create_renderbuffer was not initialized.\n");result=false;}
 if(!state->_set_texture_2d){print("set_texture_2d was not initialized.\n");result=false;}
 if(!state->_resize_texture_2d){print("resize_texture_2d was not initialized.\n");result=false;}
 if(!state->_read_texture_2d){print("read_texture_2d was not initialized.\n");result=false;}
+if(!state->_create_readback){print("create_readback was not initialized.\n");result=false;}
+if(!state->_read_texture_2d_async){print("read_texture_2d_async was not initialized.\n");result=false;}
+if(!state->_is_readback_ready){print("is_readback_ready was not initialized.\n");result=false;}
+if(!state->_map_readback){print("map_readback was not initialized.\n");result=false;}
+if(!state->_unmap_readback){print("unmap_readback was not initialized.\n");result=false;}
 if(!state->_update_texture_2d){print("update_texture_2d was not initialized.\n");result=false;}
+if(!state->_update_texture_2d_region){print("update_texture_2d_region was not initialized.\n");result=false;}
 if(!state->_generate_mipmaps_2d){print("generate_mipmaps_2d was not initialized.\n");result=false;}
 if(!state->_set_sampler){print("set_sampler was not initialized.\n");result=false;}
 if(!state->_create_render_target){print("create_render_target was not initialized.\n");result=false;}
+if(!state->_create_window_render_target){print("create_window_render_target was not initialized.\n");result=false;}
+if(!state->_create_render_target_with_attachments){print("create_render_target_with_attachments was not initialized.\n");result=false;}
+if(!state->_resolve){print("resolve was not initialized.\n");result=false;}
 if(!state->_set_render_target){print("set_render_target was not initialized.\n");result=false;}
 if(!state->_clear){print("clear was not initialized.\n");result=false;}
+if(!state->_discard){print("discard was not initialized.\n");result=false;}
 if(!state->_create_texture_cube){print("create_texture_cube was not initialized.\n");result=false;}
 if(!state->_set_texture_cube){print("set_texture_cube was not initialized.\n");result=false;}
 if(!state->_generate_mipmaps_cube){print("generate_mipmaps_cube was not initialized.\n");result=false;}
+if(!state->_create_texture_2d_array){print("create_texture_2d_array was not initialized.\n");result=false;}
+if(!state->_update_texture_2d_array_layer){print("update_texture_2d_array_layer was not initialized.\n");result=false;}
+if(!state->_generate_mipmaps_2d_array){print("generate_mipmaps_2d_array was not initialized.\n");result=false;}
+if(!state->_set_texture_2d_array){print("set_texture_2d_array was not initialized.\n");result=false;}
+if(!state->_create_texture_cube_array){print("create_texture_cube_array was not initialized.\n");result=false;}
+if(!state->_update_texture_cube_array_layer){print("update_texture_cube_array_layer was not initialized.\n");result=false;}
+if(!state->_generate_mipmaps_cube_array){print("generate_mipmaps_cube_array was not initialized.\n");result=false;}
+if(!state->_set_texture_cube_array){print("set_texture_cube_array was not initialized.\n");result=false;}
 if(!state->_create_shader){print("create_shader was not initialized.\n");result=false;}
 if(!state->_set_shader){print("set_shader was not initialized.\n");result=false;}
 if(!state->_create_shader_constants){print("create_shader_constants was not initialized.\n");result=false;}
@@ -43,8 +78,11 @@ if(!state->_get_rasterizer){print("get_rasterizer was not initialized.\n");resul
 if(!state->_create_compute_shader){print("create_compute_shader was not initialized.\n");result=false;}
 if(!state->_set_compute_shader){print("set_compute_shader was not initialized.\n");result=false;}
 if(!state->_dispatch_compute_shader){print("dispatch_compute_shader was not initialized.\n");result=false;}
+if(!state->_dispatch_compute_indirect){print("dispatch_compute_indirect was not initialized.\n");result=false;}
+if(!state->_memory_barrier){print("memory_barrier was not initialized.\n");result=false;}
 if(!state->_create_compute_buffer){print("create_compute_buffer was not initialized.\n");result=false;}
 if(!state->_read_compute_buffer){print("read_compute_buffer was not initialized.\n");result=false;}
+if(!state->_update_compute_buffer){print("update_compute_buffer was not initialized.\n");result=false;}
 if(!state->_set_compute_buffer){print("set_compute_buffer was not initialized.\n");result=false;}
 if(!state->_set_compute_texture){print("set_compute_texture was not initialized.\n");result=false;}
 if(!state->_init_colored_rectangle_shader){print("init_colored_rectangle_shader was not initialized.\n");result=false;}
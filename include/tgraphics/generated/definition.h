@@ -4,6 +4,18 @@ void (*_on_window_resize)(State *_state, u32 w, u32 h);
 void on_window_resize(u32 w, u32 h) { return _on_window_resize(this, w, h); }
 void (*_present)(State *_state);
 void present() { return _present(this); }
+void (*_set_frame_pacing)(State *_state, u32 max_frames_in_flight, bool low_latency);
+void set_frame_pacing(u32 max_frames_in_flight, bool low_latency) { return _set_frame_pacing(this, max_frames_in_flight, low_latency); }
+void (*_begin_frame)(State *_state);
+void begin_frame() { return _begin_frame(this); }
+FrameTimings (*_get_frame_timings)(State *_state);
+FrameTimings get_frame_timings() { return _get_frame_timings(this); }
+Fence (*_insert_fence)(State *_state);
+Fence insert_fence() { return _insert_fence(this); }
+bool (*_is_signaled)(State *_state, Fence fence);
+bool is_signaled(Fence fence) { return _is_signaled(this, fence); }
+void (*_wait)(State *_state, Fence fence);
+void wait(Fence fence) { return _wait(this, fence); }
 CameraMatrices (*_calculate_perspective_matrices)(State *_state, v3f position, v3f rotation, f32 aspect_ratio, f32 fov_radians, f32 near_plane, f32 far_plane);
 CameraMatrices calculate_perspective_matrices(v3f position, v3f rotation, f32 aspect_ratio, f32 fov_radians, f32 near_plane, f32 far_plane) { return _calculate_perspective_matrices(this, position, rotation, aspect_ratio, fov_radians, near_plane, far_plane); }
 void (*_set_blend)(State *_state, BlendFunction function, Blend source, Blend destination);
@@ -26,44 +38,102 @@ void (*_set_viewport)(State *_state, s32 x, s32 y, u32 w, u32 h);
 void set_viewport(s32 x, s32 y, u32 w, u32 h) { return _set_viewport(this, x, y, w, h); }
 void (*_draw)(State *_state, u32 vertex_count, u32 start_vertex);
 void draw(u32 vertex_count, u32 start_vertex) { return _draw(this, vertex_count, start_vertex); }
-void (*_draw_indexed)(State *_state, u32 index_count);
-void draw_indexed(u32 index_count) { return _draw_indexed(this, index_count); }
+void (*_draw_instanced)(State *_state, u32 vertex_count, u32 instance_count, u32 start_vertex, u32 start_instance);
+void draw_instanced(u32 vertex_count, u32 instance_count, u32 start_vertex, u32 start_instance) { return _draw_instanced(this, vertex_count, instance_count, start_vertex, start_instance); }
+void (*_draw_indexed)(State *_state, u32 index_count, u32 first_index, s32 base_vertex);
+void draw_indexed(u32 index_count, u32 first_index, s32 base_vertex) { return _draw_indexed(this, index_count, first_index, base_vertex); }
+void (*_draw_indexed_indirect)(State *_state, ComputeBuffer * arguments, u32 offset, u32 draw_count, u32 stride);
+void draw_indexed_indirect(ComputeBuffer * arguments, u32 offset, u32 draw_count, u32 stride) { return _draw_indexed_indirect(this, arguments, offset, draw_count, stride); }
+VertexLayout * (*_create_vertex_layout)(State *_state, Span<VertexStream> streams);
+VertexLayout * create_vertex_layout(Span<VertexStream> streams) { return _create_vertex_layout(this, streams); }
+void (*_set_vertex_layout)(State *_state, VertexLayout * layout);
+void set_vertex_layout(VertexLayout * layout) { return _set_vertex_layout(this, layout); }
 VertexBuffer * (*_create_vertex_buffer)(State *_state, Span<u8> buffer, Span<ElementType> vertex_descriptor);
 VertexBuffer * create_vertex_buffer(Span<u8> buffer, Span<ElementType> vertex_descriptor) { return _create_vertex_buffer(this, buffer, vertex_descriptor); }
 void (*_set_vertex_buffer)(State *_state, VertexBuffer * buffer);
 void set_vertex_buffer(VertexBuffer * buffer) { return _set_vertex_buffer(this, buffer); }
+void (*_set_vertex_buffers)(State *_state, u32 slot, VertexBuffer * buffer, u32 offset, u32 stride);
+void set_vertex_buffers(u32 slot, VertexBuffer * buffer, u32 offset, u32 stride) { return _set_vertex_buffers(this, slot, buffer, offset, stride); }
 void (*_update_vertex_buffer)(State *_state, VertexBuffer * buffer, Span<u8> data);
 void update_vertex_buffer(VertexBuffer * buffer, Span<u8> data) { return _update_vertex_buffer(this, buffer, data); }
+void * (*_map_vertex_buffer)(State *_state, VertexBuffer * buffer, Access access);
+void * map_vertex_buffer(VertexBuffer * buffer, Access access) { return _map_vertex_buffer(this, buffer, access); }
+void (*_unmap_vertex_buffer)(State *_state, VertexBuffer * buffer);
+void unmap_vertex_buffer(VertexBuffer * buffer) { return _unmap_vertex_buffer(this, buffer); }
 IndexBuffer * (*_create_index_buffer)(State *_state, Span<u8> buffer, u32 index_size);
 IndexBuffer * create_index_buffer(Span<u8> buffer, u32 index_size) { return _create_index_buffer(this, buffer, index_size); }
+void (*_update_index_buffer)(State *_state, IndexBuffer * buffer, Span<u8> data, u32 first_index);
+void update_index_buffer(IndexBuffer * buffer, Span<u8> data, u32 first_index) { return _update_index_buffer(this, buffer, data, first_index); }
 void (*_set_index_buffer)(State *_state, IndexBuffer * buffer);
 void set_index_buffer(IndexBuffer * buffer) { return _set_index_buffer(this, buffer); }
 Texture2D * (*_create_texture_2d)(State *_state, u32 width, u32 height, void const * data, Format format);
 Texture2D * create_texture_2d(u32 width, u32 height, void const * data, Format format) { return _create_texture_2d(this, width, height, data, format); }
+Texture2D * (*_create_texture_2d_mipmapped)(State *_state, u32 width, u32 height, u32 mip_count, Format format);
+Texture2D * create_texture_2d_mipmapped(u32 width, u32 height, u32 mip_count, Format format) { return _create_texture_2d_mipmapped(this, width, height, mip_count, format); }
+Texture2D * (*_create_texture_2d_multisampled)(State *_state, u32 width, u32 height, Format format, u32 sample_count);
+Texture2D * create_texture_2d_multisampled(u32 width, u32 height, Format format, u32 sample_count) { return _create_texture_2d_multisampled(this, width, height, format, sample_count); }
+Texture2D * (*_create_renderbuffer)(State *_state, u32 width, u32 height, Format format, u32 sample_count);
+Texture2D * create_renderbuffer(u32 width, u32 height, Format format, u32 sample_count) { return _create_renderbuffer(this, width, height, format, sample_count); }
 void (*_set_texture_2d)(State *_state, Texture2D * texture, u32 slot);
 void set_texture_2d(Texture2D * texture, u32 slot) { return _set_texture_2d(this, texture, slot); }
 void (*_resize_texture_2d)(State *_state, Texture2D * texture, u32 w, u32 h);
 void resize_texture_2d(Texture2D * texture, u32 w, u32 h) { return _resize_texture_2d(this, texture, w, h); }
 void (*_read_texture_2d)(State *_state, Texture2D * texture, Span<u8> data);
 void read_texture_2d(Texture2D * texture, Span<u8> data) { return _read_texture_2d(this, texture, data); }
+Readback * (*_create_readback)(State *_state, u32 size);
+Readback * create_readback(u32 size) { return _create_readback(this, size); }
+void (*_read_texture_2d_async)(State *_state, Texture2D * texture, u32 mip, Readback * readback);
+void read_texture_2d_async(Texture2D * texture, u32 mip, Readback * readback) { return _read_texture_2d_async(this, texture, mip, readback); }
+bool (*_is_readback_ready)(State *_state, Readback * readback);
+bool is_readback_ready(Readback * readback) { return _is_readback_ready(this, readback); }
+void * (*_map_readback)(State *_state, Readback * readback);
+void * map_readback(Readback * readback) { return _map_readback(this, readback); }
+void (*_unmap_readback)(State *_state, Readback * readback);
+void unmap_readback(Readback * readback) { return _unmap_readback(this, readback); }
 void (*_update_texture_2d)(State *_state, Texture2D * texture, u32 width, u32 height, void * data);
 void update_texture_2d(Texture2D * texture, u32 width, u32 height, void * data) { return _update_texture_2d(this, texture, width, height, data); }
+void (*_update_texture_2d_region)(State *_state, Texture2D * texture, u32 x, u32 y, u32 width, u32 height, void const * data);
+void update_texture_2d_region(Texture2D * texture, u32 x, u32 y, u32 width, u32 height, void const * data) { return _update_texture_2d_region(this, texture, x, y, width, height, data); }
 void (*_generate_mipmaps_2d)(State *_state, Texture2D * texture);
 void generate_mipmaps_2d(Texture2D * texture) { return _generate_mipmaps_2d(this, texture); }
 void (*_set_sampler)(State *_state, Filtering filtering, Comparison comparison, u32 slot);
 void set_sampler(Filtering filtering, Comparison comparison, u32 slot) { return _set_sampler(this, filtering, comparison, slot); }
 RenderTarget * (*_create_render_target)(State *_state, Texture2D * color, Texture2D * depth);
 RenderTarget * create_render_target(Texture2D * color, Texture2D * depth) { return _create_render_target(this, color, depth); }
+RenderTarget * (*_create_window_render_target)(State *_state, Format color_format, Format depth_format, f32 scale);
+RenderTarget * create_window_render_target(Format color_format, Format depth_format, f32 scale) { return _create_window_render_target(this, color_format, depth_format, scale); }
+RenderTarget * (*_create_render_target_with_attachments)(State *_state, Span<Texture2D *> colors, Texture2D * depth);
+RenderTarget * create_render_target_with_attachments(Span<Texture2D *> colors, Texture2D * depth) { return _create_render_target_with_attachments(this, colors, depth); }
+void (*_resolve)(State *_state, RenderTarget * source, RenderTarget * destination);
+void resolve(RenderTarget * source, RenderTarget * destination) { return _resolve(this, source, destination); }
 void (*_set_render_target)(State *_state, RenderTarget * target);
 void set_render_target(RenderTarget * target) { return _set_render_target(this, target); }
 void (*_clear)(State *_state, RenderTarget * render_target, ClearFlags flags, v4f color, f32 depth);
 void clear(RenderTarget * render_target, ClearFlags flags, v4f color, f32 depth) { return _clear(this, render_target, flags, color, depth); }
+void (*_discard)(State *_state, RenderTarget * render_target, ClearFlags flags);
+void discard(RenderTarget * render_target, ClearFlags flags) { return _discard(this, render_target, flags); }
 TextureCube * (*_create_texture_cube)(State *_state, u32 size, void ** data, Format format);
 TextureCube * create_texture_cube(u32 size, void ** data, Format format) { return _create_texture_cube(this, size, data, format); }
 void (*_set_texture_cube)(State *_state, TextureCube * texture, u32 slot);
 void set_texture_cube(TextureCube * texture, u32 slot) { return _set_texture_cube(this, texture, slot); }
 void (*_generate_mipmaps_cube)(State *_state, TextureCube * texture, GenerateCubeMipmapParams params);
 void generate_mipmaps_cube(TextureCube * texture, GenerateCubeMipmapParams params) { return _generate_mipmaps_cube(this, texture, params); }
+Texture2DArray * (*_create_texture_2d_array)(State *_state, u32 width, u32 height, u32 layer_count, u32 mip_count, Format format);
+Texture2DArray * create_texture_2d_array(u32 width, u32 height, u32 layer_count, u32 mip_count, Format format) { return _create_texture_2d_array(this, width, height, layer_count, mip_count, format); }
+void (*_update_texture_2d_array_layer)(State *_state, Texture2DArray * texture, u32 layer, void const * data);
+void update_texture_2d_array_layer(Texture2DArray * texture, u32 layer, void const * data) { return _update_texture_2d_array_layer(this, texture, layer, data); }
+void (*_generate_mipmaps_2d_array)(State *_state, Texture2DArray * texture);
+void generate_mipmaps_2d_array(Texture2DArray * texture) { return _generate_mipmaps_2d_array(this, texture); }
+void (*_set_texture_2d_array)(State *_state, Texture2DArray * texture, u32 slot);
+void set_texture_2d_array(Texture2DArray * texture, u32 slot) { return _set_texture_2d_array(this, texture, slot); }
+TextureCubeArray * (*_create_texture_cube_array)(State *_state, u32 size, u32 layer_count, Format format);
+TextureCubeArray * create_texture_cube_array(u32 size, u32 layer_count, Format format) { return _create_texture_cube_array(this, size, layer_count, format); }
+void (*_update_texture_cube_array_layer)(State *_state, TextureCubeArray * texture, u32 layer, void ** data);
+void update_texture_cube_array_layer(TextureCubeArray * texture, u32 layer, void ** data) { return _update_texture_cube_array_layer(this, texture, layer, data); }
+void (*_generate_mipmaps_cube_array)(State *_state, TextureCubeArray * texture);
+void generate_mipmaps_cube_array(TextureCubeArray * texture) { return _generate_mipmaps_cube_array(this, texture); }
+void (*_set_texture_cube_array)(State *_state, TextureCubeArray * texture, u32 slot);
+void set_texture_cube_array(TextureCubeArray * texture, u32 slot) { return _set_texture_cube_array(this, texture, slot); }
 Shader * (*_create_shader)(State *_state, Span<utf8> source);
 Shader * create_shader(Span<utf8> source) { return _create_shader(this, source); }
 void (*_set_shader)(State *_state, Shader * shader);
@@ -88,13 +158,19 @@ void (*_set_compute_shader)(State *_state, ComputeShader * shader);
 void set_compute_shader(ComputeShader * shader) { return _set_compute_shader(this, shader); }
 void (*_dispatch_compute_shader)(State *_state, u32 x, u32 y, u32 z);
 void dispatch_compute_shader(u32 x, u32 y, u32 z) { return _dispatch_compute_shader(this, x, y, z); }
+void (*_dispatch_compute_indirect)(State *_state, ComputeBuffer * arguments, u32 offset);
+void dispatch_compute_indirect(ComputeBuffer * arguments, u32 offset) { return _dispatch_compute_indirect(this, arguments, offset); }
+void (*_memory_barrier)(State *_state, Barrier barriers);
+void memory_barrier(Barrier barriers) { return _memory_barrier(this, barriers); }
 ComputeBuffer * (*_create_compute_buffer)(State *_state, u32 size);
 ComputeBuffer * create_compute_buffer(u32 size) { return _create_compute_buffer(this, size); }
 void (*_read_compute_buffer)(State *_state, ComputeBuffer * buffer, void * data);
 void read_compute_buffer(ComputeBuffer * buffer, void * data) { return _read_compute_buffer(this, buffer, data); }
+void (*_update_compute_buffer)(State *_state, ComputeBuffer * buffer, void const * data, u32 offset, u32 size);
+void update_compute_buffer(ComputeBuffer * buffer, void const * data, u32 offset, u32 size) { return _update_compute_buffer(this, buffer, data, offset, size); }
 void (*_set_compute_buffer)(State *_state, ComputeBuffer * buffer, u32 slot);
 void set_compute_buffer(ComputeBuffer * buffer, u32 slot) { return _set_compute_buffer(this, buffer, slot); }
-void (*_set_compute_texture)(State *_state, Texture2D * texture, u32 slot);
-void set_compute_texture(Texture2D * texture, u32 slot) { return _set_compute_texture(this, texture, slot); }
+void (*_set_compute_texture)(State *_state, Texture2D * texture, u32 slot, u32 mip, Access access);
+void set_compute_texture(Texture2D * texture, u32 slot, u32 mip, Access access) { return _set_compute_texture(this, texture, slot, mip, access); }
 void (*_init_colored_rectangle_shader)(State *_state);
 void init_colored_rectangle_shader() { return _init_colored_rectangle_shader(this); }
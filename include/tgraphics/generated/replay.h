@@ -0,0 +1,84 @@
+case ApiCall_set_vsync: { bool enable = {}; read_value(replay, enable); _state->set_vsync(enable); break; }
+case ApiCall_on_window_resize: { u32 w = {}; read_value(replay, w); u32 h = {}; read_value(replay, h); _state->on_window_resize(w, h); break; }
+case ApiCall_present: { _state->present(); break; }
+case ApiCall_set_frame_pacing: { u32 max_frames_in_flight = {}; read_value(replay, max_frames_in_flight); bool low_latency = {}; read_value(replay, low_latency); _state->set_frame_pacing(max_frames_in_flight, low_latency); break; }
+case ApiCall_begin_frame: { _state->begin_frame(); break; }
+case ApiCall_get_frame_timings: { auto result = _state->get_frame_timings(); replay_result(replay, result); break; }
+case ApiCall_insert_fence: { auto result = _state->insert_fence(); replay_result(replay, result); break; }
+case ApiCall_is_signaled: { Fence fence = {}; read_value(replay, fence); auto result = _state->is_signaled(fence); replay_result(replay, result); break; }
+case ApiCall_wait: { Fence fence = {}; read_value(replay, fence); _state->wait(fence); break; }
+case ApiCall_calculate_perspective_matrices: { v3f position = {}; read_value(replay, position); v3f rotation = {}; read_value(replay, rotation); f32 aspect_ratio = {}; read_value(replay, aspect_ratio); f32 fov_radians = {}; read_value(replay, fov_radians); f32 near_plane = {}; read_value(replay, near_plane); f32 far_plane = {}; read_value(replay, far_plane); auto result = _state->calculate_perspective_matrices(position, rotation, aspect_ratio, fov_radians, near_plane, far_plane); replay_result(replay, result); break; }
+case ApiCall_set_blend: { BlendFunction function = {}; read_value(replay, function); Blend source = {}; read_value(replay, source); Blend destination = {}; read_value(replay, destination); _state->set_blend(function, source, destination); break; }
+case ApiCall_set_topology: { Topology topology = {}; read_value(replay, topology); _state->set_topology(topology); break; }
+case ApiCall_set_scissor: { s32 x = {}; read_value(replay, x); s32 y = {}; read_value(replay, y); u32 w = {}; read_value(replay, w); u32 h = {}; read_value(replay, h); _state->set_scissor(x, y, w, h); break; }
+case ApiCall_disable_scissor: { _state->disable_scissor(); break; }
+case ApiCall_set_cull: { Cull cull = {}; read_value(replay, cull); _state->set_cull(cull); break; }
+case ApiCall_disable_blend: { _state->disable_blend(); break; }
+case ApiCall_disable_depth_clip: { _state->disable_depth_clip(); break; }
+case ApiCall_enable_depth_clip: { _state->enable_depth_clip(); break; }
+case ApiCall_set_viewport: { s32 x = {}; read_value(replay, x); s32 y = {}; read_value(replay, y); u32 w = {}; read_value(replay, w); u32 h = {}; read_value(replay, h); _state->set_viewport(x, y, w, h); break; }
+case ApiCall_draw: { u32 vertex_count = {}; read_value(replay, vertex_count); u32 start_vertex = {}; read_value(replay, start_vertex); _state->draw(vertex_count, start_vertex); break; }
+case ApiCall_draw_instanced: { u32 vertex_count = {}; read_value(replay, vertex_count); u32 instance_count = {}; read_value(replay, instance_count); u32 start_vertex = {}; read_value(replay, start_vertex); u32 start_instance = {}; read_value(replay, start_instance); _state->draw_instanced(vertex_count, instance_count, start_vertex, start_instance); break; }
+case ApiCall_draw_indexed: { u32 index_count = {}; read_value(replay, index_count); u32 first_index = {}; read_value(replay, first_index); s32 base_vertex = {}; read_value(replay, base_vertex); _state->draw_indexed(index_count, first_index, base_vertex); break; }
+case ApiCall_draw_indexed_indirect: { ComputeBuffer * arguments = {}; read_value(replay, arguments); u32 offset = {}; read_value(replay, offset); u32 draw_count = {}; read_value(replay, draw_count); u32 stride = {}; read_value(replay, stride); _state->draw_indexed_indirect(arguments, offset, draw_count, stride); break; }
+case ApiCall_create_vertex_layout: { Span<VertexStream> streams = {}; read_value(replay, streams); auto result = _state->create_vertex_layout(streams); replay_result(replay, result); break; }
+case ApiCall_set_vertex_layout: { VertexLayout * layout = {}; read_value(replay, layout); _state->set_vertex_layout(layout); break; }
+case ApiCall_create_vertex_buffer: { Span<u8> buffer = {}; read_value(replay, buffer); Span<ElementType> vertex_descriptor = {}; read_value(replay, vertex_descriptor); auto result = _state->create_vertex_buffer(buffer, vertex_descriptor); replay_result(replay, result); break; }
+case ApiCall_set_vertex_buffer: { VertexBuffer * buffer = {}; read_value(replay, buffer); _state->set_vertex_buffer(buffer); break; }
+case ApiCall_set_vertex_buffers: { u32 slot = {}; read_value(replay, slot); VertexBuffer * buffer = {}; read_value(replay, buffer); u32 offset = {}; read_value(replay, offset); u32 stride = {}; read_value(replay, stride); _state->set_vertex_buffers(slot, buffer, offset, stride); break; }
+case ApiCall_update_vertex_buffer: { VertexBuffer * buffer = {}; read_value(replay, buffer); Span<u8> data = {}; read_value(replay, data); _state->update_vertex_buffer(buffer, data); break; }
+case ApiCall_create_index_buffer: { Span<u8> buffer = {}; read_value(replay, buffer); u32 index_size = {}; read_value(replay, index_size); auto result = _state->create_index_buffer(buffer, index_size); replay_result(replay, result); break; }
+case ApiCall_update_index_buffer: { IndexBuffer * buffer = {}; read_value(replay, buffer); Span<u8> data = {}; read_value(replay, data); u32 first_index = {}; read_value(replay, first_index); _state->update_index_buffer(buffer, data, first_index); break; }
+case ApiCall_set_index_buffer: { IndexBuffer * buffer = {}; read_value(replay, buffer); _state->set_index_buffer(buffer); break; }
+case ApiCall_create_texture_2d: { u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); void const * data = {}; read_data(replay, data); Format format = {}; read_value(replay, format); auto result = _state->create_texture_2d(width, height, data, format); replay_result(replay, result); break; }
+case ApiCall_create_texture_2d_mipmapped: { u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); u32 mip_count = {}; read_value(replay, mip_count); Format format = {}; read_value(replay, format); auto result = _state->create_texture_2d_mipmapped(width, height, mip_count, format); replay_result(replay, result); break; }
+case ApiCall_create_texture_2d_multisampled: { u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); Format format = {}; read_value(replay, format); u32 sample_count = {}; read_value(replay, sample_count); auto result = _state->create_texture_2d_multisampled(width, height, format, sample_count); replay_result(replay, result); break; }
+case ApiCall_create_renderbuffer: { u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); Format format = {}; read_value(replay, format); u32 sample_count = {}; read_value(replay, sample_count); auto result = _state->create_renderbuffer(width, height, format, sample_count); replay_result(replay, result); break; }
+case ApiCall_set_texture_2d: { Texture2D * texture = {}; read_value(replay, texture); u32 slot = {}; read_value(replay, slot); _state->set_texture_2d(texture, slot); break; }
+case ApiCall_resize_texture_2d: { Texture2D * texture = {}; read_value(replay, texture); u32 w = {}; read_value(replay, w); u32 h = {}; read_value(replay, h); _state->resize_texture_2d(texture, w, h); break; }
+case ApiCall_read_texture_2d: { Texture2D * texture = {}; read_value(replay, texture); Span<u8> data = {}; read_value(replay, data); _state->read_texture_2d(texture, data); break; }
+case ApiCall_create_readback: { u32 size = {}; read_value(replay, size); auto result = _state->create_readback(size); replay_result(replay, result); break; }
+case ApiCall_read_texture_2d_async: { Texture2D * texture = {}; read_value(replay, texture); u32 mip = {}; read_value(replay, mip); Readback * readback = {}; read_value(replay, readback); _state->read_texture_2d_async(texture, mip, readback); break; }
+case ApiCall_is_readback_ready: { Readback * readback = {}; read_value(replay, readback); auto result = _state->is_readback_ready(readback); replay_result(replay, result); break; }
+case ApiCall_map_readback: { Readback * readback = {}; read_value(replay, readback); auto result = _state->map_readback(readback); replay_result(replay, result); break; }
+case ApiCall_unmap_readback: { Readback * readback = {}; read_value(replay, readback); _state->unmap_readback(readback); break; }
+case ApiCall_update_texture_2d: { Texture2D * texture = {}; read_value(replay, texture); u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); void * data = {}; read_data(replay, data); _state->update_texture_2d(texture, width, height, data); break; }
+case ApiCall_update_texture_2d_region: { Texture2D * texture = {}; read_value(replay, texture); u32 x = {}; read_value(replay, x); u32 y = {}; read_value(replay, y); u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); void const * data = {}; read_data(replay, data); _state->update_texture_2d_region(texture, x, y, width, height, data); break; }
+case ApiCall_generate_mipmaps_2d: { Texture2D * texture = {}; read_value(replay, texture); _state->generate_mipmaps_2d(texture); break; }
+case ApiCall_set_sampler: { Filtering filtering = {}; read_value(replay, filtering); Comparison comparison = {}; read_value(replay, comparison); u32 slot = {}; read_value(replay, slot); _state->set_sampler(filtering, comparison, slot); break; }
+case ApiCall_create_render_target: { Texture2D * color = {}; read_value(replay, color); Texture2D * depth = {}; read_value(replay, depth); auto result = _state->create_render_target(color, depth); replay_result(replay, result); break; }
+case ApiCall_create_window_render_target: { Format color_format = {}; read_value(replay, color_format); Format depth_format = {}; read_value(replay, depth_format); f32 scale = {}; read_value(replay, scale); auto result = _state->create_window_render_target(color_format, depth_format, scale); replay_result(replay, result); break; }
+case ApiCall_create_render_target_with_attachments: { Span<Texture2D *> colors = {}; read_value(replay, colors); Texture2D * depth = {}; read_value(replay, depth); auto result = _state->create_render_target_with_attachments(colors, depth); replay_result(replay, result); break; }
+case ApiCall_resolve: { RenderTarget * source = {}; read_value(replay, source); RenderTarget * destination = {}; read_value(replay, destination); _state->resolve(source, destination); break; }
+case ApiCall_set_render_target: { RenderTarget * target = {}; read_value(replay, target); _state->set_render_target(target); break; }
+case ApiCall_clear: { RenderTarget * render_target = {}; read_value(replay, render_target); ClearFlags flags = {}; read_value(replay, flags); v4f color = {}; read_value(replay, color); f32 depth = {}; read_value(replay, depth); _state->clear(render_target, flags, color, depth); break; }
+case ApiCall_discard: { RenderTarget * render_target = {}; read_value(replay, render_target); ClearFlags flags = {}; read_value(replay, flags); _state->discard(render_target, flags); break; }
+case ApiCall_create_texture_cube: { u32 size = {}; read_value(replay, size); void *data[6] = {}; read_faces(replay, data); Format format = {}; read_value(replay, format); auto result = _state->create_texture_cube(size, data, format); replay_result(replay, result); break; }
+case ApiCall_set_texture_cube: { TextureCube * texture = {}; read_value(replay, texture); u32 slot = {}; read_value(replay, slot); _state->set_texture_cube(texture, slot); break; }
+case ApiCall_generate_mipmaps_cube: { TextureCube * texture = {}; read_value(replay, texture); GenerateCubeMipmapParams params = {}; read_value(replay, params); _state->generate_mipmaps_cube(texture, params); break; }
+case ApiCall_create_texture_2d_array: { u32 width = {}; read_value(replay, width); u32 height = {}; read_value(replay, height); u32 layer_count = {}; read_value(replay, layer_count); u32 mip_count = {}; read_value(replay, mip_count); Format format = {}; read_value(replay, format); auto result = _state->create_texture_2d_array(width, height, layer_count, mip_count, format); replay_result(replay, result); break; }
+case ApiCall_update_texture_2d_array_layer: { Texture2DArray * texture = {}; read_value(replay, texture); u32 layer = {}; read_value(replay, layer); void const * data = {}; read_data(replay, data); _state->update_texture_2d_array_layer(texture, layer, data); break; }
+case ApiCall_generate_mipmaps_2d_array: { Texture2DArray * texture = {}; read_value(replay, texture); _state->generate_mipmaps_2d_array(texture); break; }
+case ApiCall_set_texture_2d_array: { Texture2DArray * texture = {}; read_value(replay, texture); u32 slot = {}; read_value(replay, slot); _state->set_texture_2d_array(texture, slot); break; }
+case ApiCall_create_texture_cube_array: { u32 size = {}; read_value(replay, size); u32 layer_count = {}; read_value(replay, layer_count); Format format = {}; read_value(replay, format); auto result = _state->create_texture_cube_array(size, layer_count, format); replay_result(replay, result); break; }
+case ApiCall_update_texture_cube_array_layer: { TextureCubeArray * texture = {}; read_value(replay, texture); u32 layer = {}; read_value(replay, layer); void *data[6] = {}; read_faces(replay, data); _state->update_texture_cube_array_layer(texture, layer, data); break; }
+case ApiCall_generate_mipmaps_cube_array: { TextureCubeArray * texture = {}; read_value(replay, texture); _state->generate_mipmaps_cube_array(texture); break; }
+case ApiCall_set_texture_cube_array: { TextureCubeArray * texture = {}; read_value(replay, texture); u32 slot = {}; read_value(replay, slot); _state->set_texture_cube_array(texture, slot); break; }
+case ApiCall_create_shader: { Span<utf8> source = {}; read_value(replay, source); auto result = _state->create_shader(source); replay_result(replay, result); break; }
+case ApiCall_set_shader: { Shader * shader = {}; read_value(replay, shader); _state->set_shader(shader); break; }
+case ApiCall_create_shader_constants: { umm size = {}; read_value(replay, size); auto result = _state->create_shader_constants(size); replay_result(replay, result); break; }
+case ApiCall_update_shader_constants: { ShaderConstants * constants = {}; read_value(replay, constants); void const * source = {}; read_data(replay, source); u32 offset = {}; read_value(replay, offset); u32 size = {}; read_value(replay, size); _state->update_shader_constants(constants, source, offset, size); break; }
+case ApiCall_set_shader_constants: { ShaderConstants * constants = {}; read_value(replay, constants); u32 slot = {}; read_value(replay, slot); _state->set_shader_constants(constants, slot); break; }
+case ApiCall_set_rasterizer: { RasterizerState state = {}; read_value(replay, state); _state->set_rasterizer(state); break; }
+case ApiCall_get_rasterizer: { auto result = _state->get_rasterizer(); replay_result(replay, result); break; }
+case ApiCall_create_compute_shader: { Span<utf8> source = {}; read_value(replay, source); auto result = _state->create_compute_shader(source); replay_result(replay, result); break; }
+case ApiCall_set_compute_shader: { ComputeShader * shader = {}; read_value(replay, shader); _state->set_compute_shader(shader); break; }
+case ApiCall_dispatch_compute_shader: { u32 x = {}; read_value(replay, x); u32 y = {}; read_value(replay, y); u32 z = {}; read_value(replay, z); _state->dispatch_compute_shader(x, y, z); break; }
+case ApiCall_dispatch_compute_indirect: { ComputeBuffer * arguments = {}; read_value(replay, arguments); u32 offset = {}; read_value(replay, offset); _state->dispatch_compute_indirect(arguments, offset); break; }
+case ApiCall_memory_barrier: { Barrier barriers = {}; read_value(replay, barriers); _state->memory_barrier(barriers); break; }
+case ApiCall_create_compute_buffer: { u32 size = {}; read_value(replay, size); auto result = _state->create_compute_buffer(size); replay_result(replay, result); break; }
+case ApiCall_read_compute_buffer: { ComputeBuffer * buffer = {}; read_value(replay, buffer); void * data = {}; read_data(replay, data); _state->read_compute_buffer(buffer, data); break; }
+case ApiCall_update_compute_buffer: { ComputeBuffer * buffer = {}; read_value(replay, buffer); void const * data = {}; read_data(replay, data); u32 offset = {}; read_value(replay, offset); u32 size = {}; read_value(replay, size); _state->update_compute_buffer(buffer, data, offset, size); break; }
+case ApiCall_set_compute_buffer: { ComputeBuffer * buffer = {}; read_value(replay, buffer); u32 slot = {}; read_value(replay, slot); _state->set_compute_buffer(buffer, slot); break; }
+case ApiCall_set_compute_texture: { Texture2D * texture = {}; read_value(replay, texture); u32 slot = {}; read_value(replay, slot); u32 mip = {}; read_value(replay, mip); Access access = {}; read_value(replay, access); _state->set_compute_texture(texture, slot, mip, access); break; }
+case ApiCall_init_colored_rectangle_shader: { _state->init_colored_rectangle_shader(); break; }
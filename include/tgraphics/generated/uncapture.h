@@ -0,0 +1,88 @@
+state->_set_vsync = capture.original._set_vsync;
+state->_on_window_resize = capture.original._on_window_resize;
+state->_present = capture.original._present;
+state->_set_frame_pacing = capture.original._set_frame_pacing;
+state->_begin_frame = capture.original._begin_frame;
+state->_get_frame_timings = capture.original._get_frame_timings;
+state->_insert_fence = capture.original._insert_fence;
+state->_is_signaled = capture.original._is_signaled;
+state->_wait = capture.original._wait;
+state->_calculate_perspective_matrices = capture.original._calculate_perspective_matrices;
+state->_set_blend = capture.original._set_blend;
+state->_set_topology = capture.original._set_topology;
+state->_set_scissor = capture.original._set_scissor;
+state->_disable_scissor = capture.original._disable_scissor;
+state->_set_cull = capture.original._set_cull;
+state->_disable_blend = capture.original._disable_blend;
+state->_disable_depth_clip = capture.original._disable_depth_clip;
+state->_enable_depth_clip = capture.original._enable_depth_clip;
+state->_set_viewport = capture.original._set_viewport;
+state->_draw = capture.original._draw;
+state->_draw_instanced = capture.original._draw_instanced;
+state->_draw_indexed = capture.original._draw_indexed;
+state->_draw_indexed_indirect = capture.original._draw_indexed_indirect;
+state->_create_vertex_layout = capture.original._create_vertex_layout;
+state->_set_vertex_layout = capture.original._set_vertex_layout;
+state->_create_vertex_buffer = capture.original._create_vertex_buffer;
+state->_set_vertex_buffer = capture.original._set_vertex_buffer;
+state->_set_vertex_buffers = capture.original._set_vertex_buffers;
+state->_update_vertex_buffer = capture.original._update_vertex_buffer;
+state->_map_vertex_buffer = capture.original._map_vertex_buffer;
+state->_unmap_vertex_buffer = capture.original._unmap_vertex_buffer;
+state->_create_index_buffer = capture.original._create_index_buffer;
+state->_update_index_buffer = capture.original._update_index_buffer;
+state->_set_index_buffer = capture.original._set_index_buffer;
+state->_create_texture_2d = capture.original._create_texture_2d;
+state->_create_texture_2d_mipmapped = capture.original._create_texture_2d_mipmapped;
+state->_create_texture_2d_multisampled = capture.original._create_texture_2d_multisampled;
+state->_create_renderbuffer = capture.original._create_renderbuffer;
+state->_set_texture_2d = capture.original._set_texture_2d;
+state->_resize_texture_2d = capture.original._resize_texture_2d;
+state->_read_texture_2d = capture.original._read_texture_2d;
+state->_create_readback = capture.original._create_readback;
+state->_read_texture_2d_async = capture.original._read_texture_2d_async;
+state->_is_readback_ready = capture.original._is_readback_ready;
+state->_map_readback = capture.original._map_readback;
+state->_unmap_readback = capture.original._unmap_readback;
+state->_update_texture_2d = capture.original._update_texture_2d;
+state->_update_texture_2d_region = capture.original._update_texture_2d_region;
+state->_generate_mipmaps_2d = capture.original._generate_mipmaps_2d;
+state->_set_sampler = capture.original._set_sampler;
+state->_create_render_target = capture.original._create_render_target;
+state->_create_window_render_target = capture.original._create_window_render_target;
+state->_create_render_target_with_attachments = capture.original._create_render_target_with_attachments;
+state->_resolve = capture.original._resolve;
+state->_set_render_target = capture.original._set_render_target;
+state->_clear = capture.original._clear;
+state->_discard = capture.original._discard;
+state->_create_texture_cube = capture.original._create_texture_cube;
+state->_set_texture_cube = capture.original._set_texture_cube;
+state->_generate_mipmaps_cube = capture.original._generate_mipmaps_cube;
+state->_create_texture_2d_array = capture.original._create_texture_2d_array;
+state->_update_texture_2d_array_layer = capture.original._update_texture_2d_array_layer;
+state->_generate_mipmaps_2d_array = capture.original._generate_mipmaps_2d_array;
+state->_set_texture_2d_array = capture.original._set_texture_2d_array;
+state->_create_texture_cube_array = capture.original._create_texture_cube_array;
+state->_update_texture_cube_array_layer = capture.original._update_texture_cube_array_layer;
+state->_generate_mipmaps_cube_array = capture.original._generate_mipmaps_cube_array;
+state->_set_texture_cube_array = capture.original._set_texture_cube_array;
+state->_create_shader = capture.original._create_shader;
+state->_set_shader = capture.original._set_shader;
+state->_create_shader_constants = capture.original._create_shader_constants;
+state->_update_shader_constants = capture.original._update_shader_constants;
+state->_map_shader_constants = capture.original._map_shader_constants;
+state->_unmap_shader_constants = capture.original._unmap_shader_constants;
+state->_set_shader_constants = capture.original._set_shader_constants;
+state->_set_rasterizer = capture.original._set_rasterizer;
+state->_get_rasterizer = capture.original._get_rasterizer;
+state->_create_compute_shader = capture.original._create_compute_shader;
+state->_set_compute_shader = capture.original._set_compute_shader;
+state->_dispatch_compute_shader = capture.original._dispatch_compute_shader;
+state->_dispatch_compute_indirect = capture.original._dispatch_compute_indirect;
+state->_memory_barrier = capture.original._memory_barrier;
+state->_create_compute_buffer = capture.original._create_compute_buffer;
+state->_read_compute_buffer = capture.original._read_compute_buffer;
+state->_update_compute_buffer = capture.original._update_compute_buffer;
+state->_set_compute_buffer = capture.original._set_compute_buffer;
+state->_set_compute_texture = capture.original._set_compute_texture;
+state->_init_colored_rectangle_shader = capture.original._init_colored_rectangle_shader;
@@ -0,0 +1,244 @@
+#pragma once
+#include "tgraphics.h"
+#include "culling.h"
+
+namespace tgraphics {
+
+// GPU driven culling. Bounding spheres of all instances live in compute buffers.
+// A compute pass tests them against the frustum and optionally a depth pyramid,
+// appends visible instances to per-draw regions of a compacted list and counts them
+// in indirect draw arguments. One `draw_indexed_indirect` then draws every mesh.
+// CPU cost does not depend on the number of instances.
+//
+// All draws share one index buffer and vertex layout, meshes are selected with `first_index` and `base_vertex`.
+// Instances of draw `d` are written to `visible_instances[base_instance + i]`, so the vertex shader finds its instance with
+//
+//   #extension GL_ARB_shader_draw_parameters : require
+//   layout(std430, binding = N) readonly buffer VisibleInstances { uint visible_instances[]; };
+//   uint instance = visible_instances[gl_BaseInstanceARB + gl_InstanceID];
+//
+// and uses it to index its own per-instance data (e.g. InstanceMatrices from transforms.h).
+
+struct GpuCullDraw {
+	u32 index_count;
+	u32 first_index;
+	s32 base_vertex;
+	u32 instance_count; // number of instances that refer to this draw
+};
+
+// Matches the layout expected by glMultiDrawElementsIndirect.
+struct DrawIndexedIndirectCommand {
+	u32 index_count;
+	u32 instance_count;
+	u32 first_index;
+	s32 base_vertex;
+	u32 base_instance;
+};
+static_assert(sizeof(DrawIndexedIndirectCommand) == 20);
+
+// Red channel of every texel holds the farthest depth (in [0, 1]) covered by it.
+// Level 0 covers the whole viewport.
+struct GpuCullOcclusion {
+	Texture2D *depth_pyramid;
+	v2u size;
+	u32 mip_count;
+};
+
+struct GpuCullConstants {
+	v4f planes[6];
+	m4 view_projection;
+	v2f pyramid_size;
+	u32 instance_count;
+	u32 occlusion_enabled;
+	u32 pyramid_mip_count;
+	u32 padding[3];
+};
+
+struct GpuCulling {
+	ComputeShader *shader;
+	TypedShaderConstants<GpuCullConstants> constants;
+	ComputeBuffer *spheres;           // v4f per instance: center and radius in world space
+	ComputeBuffer *instance_draws;    // u32 per instance: index of its GpuCullDraw
+	ComputeBuffer *commands;          // DrawIndexedIndirectCommand per draw
+	ComputeBuffer *visible_instances; // u32 per instance
+	List<DrawIndexedIndirectCommand> initial_commands;
+	u32 instance_count;
+};
+
+// Instances are numbered from 0 to the sum of instance counts of `draws`.
+TGRAPHICS_API GpuCulling create_gpu_culling(State *state, Span<GpuCullDraw> draws);
+TGRAPHICS_API void free(GpuCulling &culling);
+
+// Uploads bounding spheres and draw indices of instances starting at `first_instance`.
+// Each draw must be referred to by exactly as many instances as its `instance_count`.
+TGRAPHICS_API void update_gpu_culling_instances(State *state, GpuCulling &culling, u32 first_instance, Span<v4f> spheres, Span<u32> draw_indices);
+
+// Fills the indirect arguments and the visible instance list.
+// Overwrites the current compute shader, shader constants slot 0, compute buffer slots 0 to 3 and texture slot 0.
+// `occlusion` is optional. The pyramid is usually built from the previous frame's depth.
+TGRAPHICS_API void cull_on_gpu(State *state, GpuCulling &culling, m4 const &view_projection, GpuCullOcclusion const *occlusion = 0);
+
+// Binds the visible instance list to `visible_instances_slot` and draws everything that passed `cull_on_gpu`.
+// Shader, index buffer and vertex layout must be set by the caller.
+inline void draw_culled(State *state, GpuCulling &culling, u32 visible_instances_slot) {
+	state->memory_barrier(Barrier_indirect_command | Barrier_compute_buffer);
+	state->set_compute_buffer(culling.visible_instances, visible_instances_slot);
+	state->draw_indexed_indirect(culling.commands, 0, (u32)culling.initial_commands.count, sizeof(DrawIndexedIndirectCommand));
+}
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+namespace gpu_culling {
+
+inline constexpr u32 group_size = 64;
+
+inline Span<utf8> const cull_shader_source = u8R"(
+layout(local_size_x = 64) in;
+
+layout(std140, binding = 0) uniform CullConstants {
+	vec4 planes[6];
+	mat4 view_projection;
+	vec2 pyramid_size;
+	uint instance_count;
+	uint occlusion_enabled;
+	uint pyramid_mip_count;
+};
+
+layout(std430, binding = 0) readonly  buffer Spheres          { vec4 spheres[]; };
+layout(std430, binding = 1) readonly  buffer InstanceDraws    { uint instance_draws[]; };
+layout(std430, binding = 2)           buffer Commands         { uint commands[]; };
+layout(std430, binding = 3) writeonly buffer VisibleInstances { uint visible_instances[]; };
+
+layout(binding = 0) uniform sampler2D depth_pyramid;
+
+bool is_occluded(vec4 sphere) {
+	// Screen space bounds and nearest depth of the sphere's bounding box.
+	vec3 ndc_min = vec3( 1e30);
+	vec3 ndc_max = vec3(-1e30);
+	for (int i = 0; i < 8; ++i) {
+		vec3 corner = sphere.xyz + sphere.w * vec3((i & 1) != 0 ? 1 : -1, (i & 2) != 0 ? 1 : -1, (i & 4) != 0 ? 1 : -1);
+		vec4 clip = view_projection * vec4(corner, 1);
+		if (clip.w <= 0)
+			return false; // crosses the camera plane
+		vec3 ndc = clip.xyz / clip.w;
+		ndc_min = min(ndc_min, ndc);
+		ndc_max = max(ndc_max, ndc);
+	}
+
+	vec2 uv_min = clamp(ndc_min.xy * 0.5 + 0.5, 0, 1);
+	vec2 uv_max = clamp(ndc_max.xy * 0.5 + 0.5, 0, 1);
+	float nearest_depth = ndc_min.z * 0.5 + 0.5;
+
+	// Pick the level where the bounds are at most one texel wide, so they cover at most 2x2 texels.
+	vec2 extent = (uv_max - uv_min) * pyramid_size;
+	int level = int(min(ceil(log2(max(max(extent.x, extent.y), 1))), float(pyramid_mip_count - 1)));
+
+	ivec2 level_size = textureSize(depth_pyramid, level);
+	ivec2 texel_min = min(ivec2(uv_min * level_size), level_size - 1);
+	ivec2 texel_max = min(ivec2(uv_max * level_size), level_size - 1);
+
+	float farthest_depth = max(
+		max(texelFetch(depth_pyramid, texel_min, level).r,                           texelFetch(depth_pyramid, ivec2(texel_max.x, texel_min.y), level).r),
+		max(texelFetch(depth_pyramid, ivec2(texel_min.x, texel_max.y), level).r,     texelFetch(depth_pyramid, texel_max, level).r)
+	);
+	return nearest_depth > farthest_depth;
+}
+
+void main() {
+	uint instance = gl_GlobalInvocationID.x;
+	if (instance >= instance_count)
+		return;
+
+	vec4 sphere = spheres[instance];
+	for (int i = 0; i < 6; ++i) {
+		if (dot(planes[i].xyz, sphere.xyz) + planes[i].w < -sphere.w)
+			return;
+	}
+
+	if (occlusion_enabled != 0 && is_occluded(sphere))
+		return;
+
+	// Commands are five uints: index_count, instance_count, first_index, base_vertex, base_instance.
+	uint draw = instance_draws[instance];
+	uint slot = atomicAdd(commands[draw * 5 + 1], 1);
+	visible_instances[commands[draw * 5 + 4] + slot] = instance;
+}
+)"s;
+
+}
+
+GpuCulling create_gpu_culling(State *state, Span<GpuCullDraw> draws) {
+	GpuCulling result = {};
+
+	u32 instance_count = 0;
+	for (auto &draw : draws) {
+		result.initial_commands.add({
+			.index_count = draw.index_count,
+			.instance_count = 0,
+			.first_index = draw.first_index,
+			.base_vertex = draw.base_vertex,
+			.base_instance = instance_count,
+		});
+		instance_count += draw.instance_count;
+	}
+	result.instance_count = instance_count;
+
+	result.shader            = state->create_compute_shader(gpu_culling::cull_shader_source);
+	result.constants         = state->create_shader_constants<GpuCullConstants>();
+	result.spheres           = state->create_compute_buffer(max(instance_count, 1u) * sizeof(v4f));
+	result.instance_draws    = state->create_compute_buffer(max(instance_count, 1u) * sizeof(u32));
+	result.visible_instances = state->create_compute_buffer(max(instance_count, 1u) * sizeof(u32));
+	result.commands          = state->create_compute_buffer(max((u32)draws.count, 1u) * sizeof(DrawIndexedIndirectCommand));
+	return result;
+}
+
+void free(GpuCulling &culling) {
+	free(culling.initial_commands);
+}
+
+void update_gpu_culling_instances(State *state, GpuCulling &culling, u32 first_instance, Span<v4f> spheres, Span<u32> draw_indices) {
+	assert(spheres.count == draw_indices.count);
+	assert(first_instance + spheres.count <= culling.instance_count, "update_gpu_culling_instances: instance is out of range");
+	state->update_compute_buffer(culling.spheres,        spheres,      first_instance * (u32)sizeof(v4f));
+	state->update_compute_buffer(culling.instance_draws, draw_indices, first_instance * (u32)sizeof(u32));
+}
+
+void cull_on_gpu(State *state, GpuCulling &culling, m4 const &view_projection, GpuCullOcclusion const *occlusion) {
+	if (!culling.instance_count)
+		return;
+
+	// Reset instance counts. Uploads are ordered after the previous frame's indirect draw.
+	state->update_compute_buffer(culling.commands, culling.initial_commands.data, 0, (u32)(culling.initial_commands.count * sizeof(DrawIndexedIndirectCommand)));
+
+	auto frustum = extract_frustum(view_projection);
+
+	GpuCullConstants constants = {};
+	memcpy(constants.planes, frustum.planes, sizeof(frustum.planes));
+	constants.view_projection = view_projection;
+	constants.instance_count = culling.instance_count;
+	if (occlusion) {
+		assert(occlusion->depth_pyramid);
+		assert(occlusion->mip_count);
+		constants.occlusion_enabled = 1;
+		constants.pyramid_size = {(f32)occlusion->size.x, (f32)occlusion->size.y};
+		constants.pyramid_mip_count = occlusion->mip_count;
+		state->set_texture_2d(occlusion->depth_pyramid, 0);
+	}
+	state->update_shader_constants(culling.constants, constants);
+
+	state->set_compute_shader(culling.shader);
+	state->set_shader_constants(culling.constants, 0);
+	state->set_compute_buffer(culling.spheres, 0);
+	state->set_compute_buffer(culling.instance_draws, 1);
+	state->set_compute_buffer(culling.commands, 2);
+	state->set_compute_buffer(culling.visible_instances, 3);
+	state->dispatch_compute_shader((culling.instance_count + gpu_culling::group_size - 1) / gpu_culling::group_size, 1, 1);
+}
+
+}
+
+#endif
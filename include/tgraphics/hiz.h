@@ -0,0 +1,305 @@
+#pragma once
+#include "tgraphics.h"
+#include "gpu_culling.h"
+
+namespace tgraphics {
+
+// Hierarchical depth pyramid for occlusion culling.
+//
+// Every level stores the farthest (red) and the nearest (green) depth of the texels it covers,
+// level 0 is half the size of the depth buffer. Levels are reduced with a compute shader, odd sized
+// levels include the extra row and column of their source, so the result stays conservative.
+//
+// A small level is also copied to the CPU without stalling: copies go through a ring of readbacks
+// and are picked up a few frames later, together with the view-projection they were rendered with.
+//
+// Example:
+//
+//   cull_on_gpu(state, culling, view_projection, &occlusion); // pyramid of the previous frame
+//   ... draw the scene ...
+//   build_hiz_pyramid(state, pyramid, depth, view_projection);
+//   occlusion = get_occlusion(pyramid);
+
+inline constexpr u32 hiz_max_mip_count = 16;
+inline constexpr u32 hiz_readback_count = 3;
+
+struct HiZConstants {
+	v2u source_size;
+	v2u destination_size;
+	u32 source_level;
+	u32 source_is_depth;
+	u32 padding[2];
+};
+
+struct HiZPyramid {
+	ComputeShader *shader;
+	TypedShaderConstants<HiZConstants> constants;
+
+	Texture2D *texture; // Format_rg_f32
+	v2u size;           // of level 0
+	u32 mip_count;
+
+	// CPU copy.
+	u32 cpu_max_size;
+	Readback *readbacks[hiz_readback_count];
+	m4 readback_view_projections[hiz_readback_count];
+	v2u readback_sizes[hiz_readback_count];
+	u32 first_pending_readback;
+	u32 pending_readback_count;
+
+	List<v2f> cpu_texels;
+	v2u cpu_size;
+	m4 cpu_view_projection;
+};
+
+// The CPU copy is the largest level whose both dimensions are not greater than `cpu_max_size`.
+// Zero disables it.
+TGRAPHICS_API HiZPyramid create_hiz_pyramid(State *state, u32 cpu_max_size = 64);
+TGRAPHICS_API void free(HiZPyramid &pyramid);
+
+// Reduces `depth`, which must not be multisampled, into the pyramid, resizing it if the size of `depth` changed, and starts a CPU copy.
+// Overwrites the current compute shader, shader constants slot 0, texture and sampler slot 0 and compute texture slot 0.
+TGRAPHICS_API void build_hiz_pyramid(State *state, HiZPyramid &pyramid, Texture2D *depth, m4 const &view_projection);
+
+inline GpuCullOcclusion get_occlusion(HiZPyramid const &pyramid) {
+	return {
+		.depth_pyramid = pyramid.texture,
+		.size = pyramid.size,
+		.mip_count = pyramid.mip_count,
+	};
+}
+
+// Farthest (x) and nearest (y) depth of the CPU copy at `uv`. Returns {1, 0} if there is no copy yet.
+TGRAPHICS_API v2f sample_hiz_cpu(HiZPyramid const &pyramid, v2f uv);
+
+// Tests a world space sphere against the CPU copy, using the view-projection the copy was rendered with.
+// The copy is a few frames old, so fast moving cameras and objects may be culled for a frame too long.
+TGRAPHICS_API bool is_sphere_occluded_cpu(HiZPyramid const &pyramid, v3f center, f32 radius);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+namespace hiz {
+
+inline constexpr u32 group_size = 8;
+
+inline Span<utf8> const reduce_shader_source = u8R"(
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(std140, binding = 0) uniform HiZConstants {
+	uvec2 source_size;
+	uvec2 destination_size;
+	uint source_level;
+	uint source_is_depth;
+};
+
+layout(binding = 0) uniform sampler2D source;
+layout(rg32f, binding = 0) writeonly uniform image2D destination;
+
+vec2 load(ivec2 texel) {
+	vec4 value = texelFetch(source, texel, int(source_level));
+	return source_is_depth != 0 ? value.rr : value.rg;
+}
+
+void main() {
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, ivec2(destination_size))))
+		return;
+
+	// Each texel covers 2x2 source texels. The last row and column also cover the remainder of odd sizes.
+	ivec2 last = ivec2(source_size) - 1;
+	ivec2 begin = min(texel * 2, last);
+	ivec2 end = min(begin + 1, last);
+	if (texel.x == int(destination_size.x) - 1) end.x = last.x;
+	if (texel.y == int(destination_size.y) - 1) end.y = last.y;
+
+	vec2 result = vec2(0, 1);
+	for (int y = begin.y; y <= end.y; ++y) {
+		for (int x = begin.x; x <= end.x; ++x) {
+			vec2 depth = load(ivec2(x, y));
+			result.x = max(result.x, depth.x);
+			result.y = min(result.y, depth.y);
+		}
+	}
+	imageStore(destination, texel, vec4(result, 0, 0));
+}
+)"s;
+
+inline v2u get_level_size(v2u size, u32 level) {
+	return {max(1u, size.x >> level), max(1u, size.y >> level)};
+}
+
+inline void resize(State *state, HiZPyramid &pyramid, v2u depth_size) {
+	pyramid.size = get_level_size(depth_size, 1);
+
+	pyramid.mip_count = 1;
+	while (pyramid.mip_count < hiz_max_mip_count && max(pyramid.size.x, pyramid.size.y) >> pyramid.mip_count)
+		++pyramid.mip_count;
+
+	if (pyramid.texture) {
+		state->resize_texture_2d(pyramid.texture, pyramid.size);
+	} else {
+		pyramid.texture = state->create_texture_2d_mipmapped(pyramid.size, hiz_max_mip_count, Format_rg_f32);
+	}
+}
+
+// Copies finished readbacks into `cpu_texels`. Waits for the oldest one only if the ring is full.
+inline void receive_readbacks(State *state, HiZPyramid &pyramid) {
+	while (pyramid.pending_readback_count) {
+		auto index = pyramid.first_pending_readback;
+		auto readback = pyramid.readbacks[index];
+		if (pyramid.pending_readback_count < hiz_readback_count && !state->is_readback_ready(readback))
+			break;
+
+		auto size = pyramid.readback_sizes[index];
+		pyramid.cpu_texels.resize(size.x * size.y);
+		memcpy(pyramid.cpu_texels.data, state->map_readback(readback), size.x * size.y * sizeof(v2f));
+		state->unmap_readback(readback);
+		pyramid.cpu_size = size;
+		pyramid.cpu_view_projection = pyramid.readback_view_projections[index];
+
+		pyramid.first_pending_readback = (index + 1) % hiz_readback_count;
+		--pyramid.pending_readback_count;
+	}
+}
+
+inline v4f transform(m4 const &m, v3f p) {
+	return {
+		m.s[0] * p.x + m.s[4] * p.y + m.s[8]  * p.z + m.s[12],
+		m.s[1] * p.x + m.s[5] * p.y + m.s[9]  * p.z + m.s[13],
+		m.s[2] * p.x + m.s[6] * p.y + m.s[10] * p.z + m.s[14],
+		m.s[3] * p.x + m.s[7] * p.y + m.s[11] * p.z + m.s[15],
+	};
+}
+
+}
+
+HiZPyramid create_hiz_pyramid(State *state, u32 cpu_max_size) {
+	HiZPyramid result = {};
+	result.shader = state->create_compute_shader(hiz::reduce_shader_source);
+	result.constants = state->create_shader_constants<HiZConstants>();
+	result.cpu_max_size = cpu_max_size;
+	if (cpu_max_size) {
+		for (auto &readback : result.readbacks) {
+			readback = state->create_readback(cpu_max_size * cpu_max_size * (u32)sizeof(v2f));
+		}
+	}
+	return result;
+}
+
+void free(HiZPyramid &pyramid) {
+	free(pyramid.cpu_texels);
+}
+
+void build_hiz_pyramid(State *state, HiZPyramid &pyramid, Texture2D *depth, m4 const &view_projection) {
+	using namespace hiz;
+
+	assert(depth);
+
+	if (!pyramid.texture || !all_true(get_level_size(depth->size, 1) == pyramid.size))
+		resize(state, pyramid, depth->size);
+
+	state->set_compute_shader(pyramid.shader);
+	state->set_shader_constants(pyramid.constants, 0);
+	state->set_sampler(Filtering_nearest, Comparison_none, 0);
+
+	for (u32 level = 0; level < pyramid.mip_count; ++level) {
+		HiZConstants constants = {};
+		constants.destination_size = get_level_size(pyramid.size, level);
+		if (level == 0) {
+			constants.source_size = depth->size;
+			constants.source_level = 0;
+			constants.source_is_depth = 1;
+			state->set_texture_2d(depth, 0);
+		} else {
+			constants.source_size = get_level_size(pyramid.size, level - 1);
+			constants.source_level = level - 1;
+			constants.source_is_depth = 0;
+			state->set_texture_2d(pyramid.texture, 0);
+		}
+		state->update_shader_constants(pyramid.constants, constants);
+		state->set_compute_texture(pyramid.texture, 0, level, Access_write);
+		state->dispatch_compute_shader(
+			(constants.destination_size.x + group_size - 1) / group_size,
+			(constants.destination_size.y + group_size - 1) / group_size,
+			1
+		);
+		state->memory_barrier(Barrier_texture_fetch | Barrier_compute_texture);
+	}
+
+	if (!pyramid.cpu_max_size)
+		return;
+
+	receive_readbacks(state, pyramid);
+
+	u32 cpu_level = 0;
+	while (cpu_level + 1 < pyramid.mip_count && max(get_level_size(pyramid.size, cpu_level).x, get_level_size(pyramid.size, cpu_level).y) > pyramid.cpu_max_size)
+		++cpu_level;
+
+	auto cpu_size = get_level_size(pyramid.size, cpu_level);
+	if (max(cpu_size.x, cpu_size.y) > pyramid.cpu_max_size)
+		return;
+
+	auto index = (pyramid.first_pending_readback + pyramid.pending_readback_count) % hiz_readback_count;
+	state->memory_barrier(Barrier_texture_transfer);
+	state->read_texture_2d_async(pyramid.texture, cpu_level, pyramid.readbacks[index]);
+	pyramid.readback_view_projections[index] = view_projection;
+	pyramid.readback_sizes[index] = cpu_size;
+	++pyramid.pending_readback_count;
+}
+
+v2f sample_hiz_cpu(HiZPyramid const &pyramid, v2f uv) {
+	if (!pyramid.cpu_texels.count)
+		return {1, 0};
+
+	u32 x = min((u32)max(uv.x * pyramid.cpu_size.x, 0.0f), pyramid.cpu_size.x - 1);
+	u32 y = min((u32)max(uv.y * pyramid.cpu_size.y, 0.0f), pyramid.cpu_size.y - 1);
+	return pyramid.cpu_texels[y * pyramid.cpu_size.x + x];
+}
+
+bool is_sphere_occluded_cpu(HiZPyramid const &pyramid, v3f center, f32 radius) {
+	if (!pyramid.cpu_texels.count)
+		return false;
+
+	// Screen space bounds and nearest depth of the sphere's bounding box.
+	v3f ndc_min = { 1e30f,  1e30f,  1e30f};
+	v3f ndc_max = {-1e30f, -1e30f, -1e30f};
+	for (u32 i = 0; i < 8; ++i) {
+		v3f corner = {
+			center.x + ((i & 1) ? radius : -radius),
+			center.y + ((i & 2) ? radius : -radius),
+			center.z + ((i & 4) ? radius : -radius),
+		};
+		auto clip = hiz::transform(pyramid.cpu_view_projection, corner);
+		if (clip.w <= 0)
+			return false; // crosses the camera plane
+		v3f ndc = {clip.x / clip.w, clip.y / clip.w, clip.z / clip.w};
+		ndc_min = {min(ndc_min.x, ndc.x), min(ndc_min.y, ndc.y), min(ndc_min.z, ndc.z)};
+		ndc_max = {max(ndc_max.x, ndc.x), max(ndc_max.y, ndc.y), max(ndc_max.z, ndc.z)};
+	}
+
+	auto size = pyramid.cpu_size;
+	auto to_texel = [&](f32 ndc, u32 count) {
+		return min((u32)clamp((ndc * 0.5f + 0.5f) * count, 0.0f, (f32)count), count - 1);
+	};
+	u32 x_min = to_texel(ndc_min.x, size.x);
+	u32 x_max = to_texel(ndc_max.x, size.x);
+	u32 y_min = to_texel(ndc_min.y, size.y);
+	u32 y_max = to_texel(ndc_max.y, size.y);
+	f32 nearest_depth = ndc_min.z * 0.5f + 0.5f;
+
+	for (u32 y = y_min; y <= y_max; ++y) {
+		for (u32 x = x_min; x <= x_max; ++x) {
+			if (nearest_depth <= pyramid.cpu_texels[y * size.x + x].x)
+				return false;
+		}
+	}
+	return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,574 @@
+#pragma once
+#include "tgraphics.h"
+
+namespace tgraphics {
+
+// Mesh processing to run before create_vertex_buffer / create_index_buffer.
+// All index lists are triangle lists. A typical pipeline is
+//
+//   deduplicate_vertices -> optimize_vertex_cache -> optimize_overdraw -> optimize_vertex_fetch
+//
+// Functions that take a `destination` and a `source` allow them to be the same.
+
+struct VertexCacheStatistics {
+	u32 transformed_vertex_count;
+	f32 acmr;      // average cache miss ratio, transformed vertices per triangle. 0.5 is ideal for big grids, 3 is the worst.
+	f32 atvr;      // average transformed vertex ratio, transformed vertices per vertex. 1 is ideal.
+	f32 overfetch; // bytes read from the vertex buffer divided by its size. 1 is ideal.
+};
+
+// Simulates a fifo post-transform cache of `cache_size` vertices
+// and a small cache of 64 byte lines for vertex fetch.
+TGRAPHICS_API VertexCacheStatistics analyze_vertex_cache(Span<u32> indices, u32 vertex_count, u32 vertex_size, u32 cache_size = 16);
+
+// Finds identical vertices in `vertices` (`vertex_count` vertices of `vertex_size` bytes each)
+// and fills `remap` so that remap[old_index] is the new index. The first occurrence of a vertex keeps the lowest new index.
+// Returns the number of unique vertices.
+// Use it on an unindexed vertex stream to build an index buffer: the remap table is the index buffer.
+TGRAPHICS_API u32 deduplicate_vertices(Span<u32> remap, void const *vertices, u32 vertex_count, u32 vertex_size);
+
+// Moves vertices to the positions given by `remap`. `destination` must have room for the unique vertices.
+TGRAPHICS_API void remap_vertices(void *destination, void const *vertices, u32 vertex_count, u32 vertex_size, Span<u32> remap);
+
+// Replaces every index i with remap[i].
+TGRAPHICS_API void remap_indices(Span<u32> destination, Span<u32> indices, Span<u32> remap);
+
+// Reorders triangles to maximize post-transform cache hits (Forsyth, "Linear-speed vertex cache optimisation").
+TGRAPHICS_API void optimize_vertex_cache(Span<u32> destination, Span<u32> indices, u32 vertex_count);
+
+// Reorders clusters of a cache optimized index list so outward facing parts of the mesh come first,
+// which reduces overdraw when it is drawn with a depth test (Sander et al., "Fast triangle reordering").
+// Clusters are split only where that costs at most `threshold` times the current ACMR, so 1.05 keeps 95% of the cache efficiency.
+// `positions` points to the first vertex position, `position_stride` is the byte distance between positions.
+TGRAPHICS_API void optimize_overdraw(Span<u32> destination, Span<u32> indices, f32 const *positions, u32 position_stride, u32 vertex_count, f32 threshold = 1.05f);
+
+// Reorders vertices in the order they are first used by `indices` and updates `indices` in place.
+// Vertices are written to `destination`, which must not overlap `vertices`.
+// Returns the number of vertices that are referenced.
+TGRAPHICS_API u32 optimize_vertex_fetch(void *destination, Span<u32> indices, void const *vertices, u32 vertex_count, u32 vertex_size);
+
+// Binary file written by the mesh_optimizer tool:
+//
+//   MeshFileHeader
+//   ElementType elements[element_count]
+//   u8 vertices[vertex_count * vertex_size]   (starts at vertex_offset)
+//   u8 indices[index_count * index_size]      (starts at index_offset)
+//
+inline constexpr u32 mesh_file_magic   = 'T' | ('M' << 8) | ('S' << 16) | ('H' << 24);
+inline constexpr u32 mesh_file_version = 1;
+
+struct MeshFileHeader {
+	u32 magic;
+	u32 version;
+	u32 element_count;
+	u32 vertex_count;
+	u32 vertex_size;
+	u32 index_count;
+	u32 index_size;
+	u32 vertex_offset;
+	u32 index_offset;
+};
+
+struct MeshFile {
+	Span<ElementType> elements;
+	Span<u8> vertices;
+	Span<u8> indices;
+	u32 index_size;
+};
+
+// Returns an empty MeshFile if `data` is not a valid mesh file. The result points into `data`.
+TGRAPHICS_API MeshFile parse_mesh_file(Span<u8> data);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+VertexCacheStatistics analyze_vertex_cache(Span<u32> indices, u32 vertex_count, u32 vertex_size, u32 cache_size) {
+	assert(indices.count % 3 == 0);
+
+	VertexCacheStatistics result = {};
+
+	constexpr u32 line_size = 64;
+	constexpr u32 line_cache_size = 32;
+
+	// Fifo caches are simulated with timestamps: an entry is still cached
+	// if fewer than `cache_size` entries were inserted after it.
+	List<u32> vertex_timestamps;
+	List<u32> line_timestamps;
+	defer {
+		free(vertex_timestamps);
+		free(line_timestamps);
+	};
+	vertex_timestamps.resize(vertex_count);
+	line_timestamps.resize(((umm)vertex_count * vertex_size + line_size - 1) / line_size);
+	memset(vertex_timestamps.data, 0, vertex_timestamps.count * sizeof(u32));
+	memset(line_timestamps.data, 0, line_timestamps.count * sizeof(u32));
+
+	u32 vertex_time = cache_size + 1;
+	u32 line_time = line_cache_size + 1;
+	umm fetched_bytes = 0;
+
+	for (auto index : indices) {
+		assert(index < vertex_count);
+		if (vertex_time - vertex_timestamps[index] <= cache_size)
+			continue;
+
+		vertex_timestamps[index] = vertex_time++;
+		++result.transformed_vertex_count;
+
+		umm first_line = (umm)index * vertex_size / line_size;
+		umm last_line = ((umm)index * vertex_size + vertex_size - 1) / line_size;
+		for (umm line = first_line; line <= last_line; ++line) {
+			if (line_time - line_timestamps[line] > line_cache_size) {
+				line_timestamps[line] = line_time++;
+				fetched_bytes += line_size;
+			}
+		}
+	}
+
+	u32 triangle_count = indices.count / 3;
+	result.acmr = triangle_count ? (f32)result.transformed_vertex_count / triangle_count : 0;
+	result.atvr = vertex_count ? (f32)result.transformed_vertex_count / vertex_count : 0;
+	result.overfetch = vertex_count ? (f32)fetched_bytes / ((umm)vertex_count * vertex_size) : 0;
+	return result;
+}
+
+namespace mesh {
+
+inline u32 hash_bytes(void const *data, u32 size) {
+	// FNV-1a
+	u32 hash = 2166136261;
+	for (u32 i = 0; i < size; ++i) {
+		hash ^= ((u8 const *)data)[i];
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+}
+
+u32 deduplicate_vertices(Span<u32> remap, void const *vertices, u32 vertex_count, u32 vertex_size) {
+	assert(remap.count >= vertex_count);
+
+	// Open addressing table of indices of unique vertices, at most half full.
+	u32 table_size = 1;
+	while (table_size < vertex_count * 2)
+		table_size *= 2;
+
+	constexpr u32 empty = ~0u;
+
+	List<u32> table;
+	defer { free(table); };
+	table.resize(table_size);
+	memset(table.data, 0xff, table_size * sizeof(u32));
+
+	auto vertex = [&](u32 index) {
+		return (u8 const *)vertices + (umm)index * vertex_size;
+	};
+
+	u32 unique_count = 0;
+	for (u32 vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+		u32 slot = mesh::hash_bytes(vertex(vertex_index), vertex_size) & (table_size - 1);
+		while (1) {
+			auto existing = table[slot];
+			if (existing == empty) {
+				table[slot] = vertex_index;
+				remap[vertex_index] = unique_count++;
+				break;
+			}
+			if (memcmp(vertex(existing), vertex(vertex_index), vertex_size) == 0) {
+				remap[vertex_index] = remap[existing];
+				break;
+			}
+			slot = (slot + 1) & (table_size - 1);
+		}
+	}
+	return unique_count;
+}
+
+void remap_vertices(void *destination, void const *vertices, u32 vertex_count, u32 vertex_size, Span<u32> remap) {
+	for (u32 vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+		memcpy((u8 *)destination + (umm)remap[vertex_index] * vertex_size, (u8 const *)vertices + (umm)vertex_index * vertex_size, vertex_size);
+	}
+}
+
+void remap_indices(Span<u32> destination, Span<u32> indices, Span<u32> remap) {
+	assert(destination.count >= indices.count);
+	for (umm i = 0; i < indices.count; ++i) {
+		destination[i] = remap[indices[i]];
+	}
+}
+
+namespace mesh {
+
+inline constexpr u32 forsyth_cache_size = 32;
+
+// Scores from Forsyth's article.
+inline f32 forsyth_vertex_score(s32 cache_position, u32 remaining_triangle_count) {
+	if (remaining_triangle_count == 0)
+		return -1;
+
+	f32 score = 0;
+	if (cache_position >= 0) {
+		if (cache_position < 3) {
+			// The last triangle's vertices get a fixed score so its neighbours are not preferred too strongly.
+			score = 0.75f;
+		} else {
+			f32 scale = 1.0f / (forsyth_cache_size - 3);
+			score = powf(1.0f - (cache_position - 3) * scale, 1.5f);
+		}
+	}
+
+	// Prefer vertices with few remaining triangles, to finish them off and let them leave the cache.
+	score += 2.0f * powf((f32)remaining_triangle_count, -0.5f);
+	return score;
+}
+
+}
+
+void optimize_vertex_cache(Span<u32> destination, Span<u32> source, u32 vertex_count) {
+	assert(source.count % 3 == 0);
+	assert(destination.count >= source.count);
+
+	u32 triangle_count = source.count / 3;
+
+	List<u32> indices;
+	List<u32> vertex_triangle_offsets;
+	List<u32> vertex_triangles;
+	List<u32> remaining_triangle_counts;
+	List<s32> cache_positions;
+	List<f32> vertex_scores;
+	List<f32> triangle_scores;
+	List<bool> triangle_emitted;
+	defer {
+		free(indices);
+		free(vertex_triangle_offsets);
+		free(vertex_triangles);
+		free(remaining_triangle_counts);
+		free(cache_positions);
+		free(vertex_scores);
+		free(triangle_scores);
+		free(triangle_emitted);
+	};
+
+	// Copy the source so destination can alias it.
+	indices.resize(source.count);
+	memcpy(indices.data, source.data, source.count * sizeof(u32));
+
+	// Triangles using each vertex, as offsets into one array.
+	remaining_triangle_counts.resize(vertex_count);
+	memset(remaining_triangle_counts.data, 0, vertex_count * sizeof(u32));
+	for (auto index : indices) {
+		++remaining_triangle_counts[index];
+	}
+
+	vertex_triangle_offsets.resize(vertex_count + 1);
+	vertex_triangle_offsets[0] = 0;
+	for (u32 vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+		vertex_triangle_offsets[vertex_index + 1] = vertex_triangle_offsets[vertex_index] + remaining_triangle_counts[vertex_index];
+	}
+
+	vertex_triangles.resize(indices.count);
+	{
+		List<u32> fill;
+		defer { free(fill); };
+		fill.resize(vertex_count);
+		memcpy(fill.data, vertex_triangle_offsets.data, vertex_count * sizeof(u32));
+		for (u32 i = 0; i < indices.count; ++i) {
+			vertex_triangles[fill[indices[i]]++] = i / 3;
+		}
+	}
+
+	cache_positions.resize(vertex_count);
+	vertex_scores.resize(vertex_count);
+	for (u32 vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+		cache_positions[vertex_index] = -1;
+		vertex_scores[vertex_index] = mesh::forsyth_vertex_score(-1, remaining_triangle_counts[vertex_index]);
+	}
+
+	triangle_scores.resize(triangle_count);
+	triangle_emitted.resize(triangle_count);
+	for (u32 triangle_index = 0; triangle_index < triangle_count; ++triangle_index) {
+		auto t = indices.data + triangle_index * 3;
+		triangle_scores[triangle_index] = vertex_scores[t[0]] + vertex_scores[t[1]] + vertex_scores[t[2]];
+		triangle_emitted[triangle_index] = false;
+	}
+
+	// LRU cache, with room for the three vertices pushed in front of it.
+	u32 cache[mesh::forsyth_cache_size + 3];
+	u32 cache_count = 0;
+
+	// Triangles are searched only among those using cached vertices.
+	// When that finds nothing, all triangles not emitted yet are scored, as in Forsyth's article.
+	// Emitted triangles before `scan_cursor` are skipped, so the scan shrinks as the mesh is consumed.
+	u32 scan_cursor = 0;
+	u32 best_triangle = ~0u;
+	f32 best_score = -1;
+	for (u32 triangle_index = 0; triangle_index < triangle_count; ++triangle_index) {
+		if (triangle_scores[triangle_index] > best_score) {
+			best_score = triangle_scores[triangle_index];
+			best_triangle = triangle_index;
+		}
+	}
+
+	for (u32 emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+		if (best_triangle == ~0u) {
+			while (triangle_emitted[scan_cursor])
+				++scan_cursor;
+			for (u32 triangle_index = scan_cursor; triangle_index < triangle_count; ++triangle_index) {
+				if (triangle_emitted[triangle_index])
+					continue;
+				auto t = indices.data + triangle_index * 3;
+				auto score = vertex_scores[t[0]] + vertex_scores[t[1]] + vertex_scores[t[2]];
+				if (score > best_score) {
+					best_score = score;
+					best_triangle = triangle_index;
+				}
+			}
+		}
+
+		auto triangle = indices.data + best_triangle * 3;
+		memcpy(destination.data + emitted_count * 3, triangle, 3 * sizeof(u32));
+		triangle_emitted[best_triangle] = true;
+
+		// Remove the triangle from its vertices' lists.
+		for (u32 corner = 0; corner < 3; ++corner) {
+			auto vertex_index = triangle[corner];
+			auto begin = vertex_triangles.data + vertex_triangle_offsets[vertex_index];
+			auto end = begin + remaining_triangle_counts[vertex_index];
+			for (auto it = begin; it != end; ++it) {
+				if (*it == best_triangle) {
+					*it = end[-1];
+					break;
+				}
+			}
+			--remaining_triangle_counts[vertex_index];
+		}
+
+		// Move the triangle's vertices to the front of the cache.
+		u32 new_cache[mesh::forsyth_cache_size + 3];
+		u32 new_cache_count = 0;
+		for (u32 corner = 0; corner < 3; ++corner) {
+			new_cache[new_cache_count++] = triangle[corner];
+		}
+		for (u32 i = 0; i < cache_count; ++i) {
+			auto vertex_index = cache[i];
+			if (vertex_index != triangle[0] && vertex_index != triangle[1] && vertex_index != triangle[2]) {
+				new_cache[new_cache_count++] = vertex_index;
+			}
+		}
+
+		// Vertices that fell out of the cache.
+		for (u32 i = mesh::forsyth_cache_size; i < new_cache_count; ++i) {
+			cache_positions[new_cache[i]] = -1;
+			vertex_scores[new_cache[i]] = mesh::forsyth_vertex_score(-1, remaining_triangle_counts[new_cache[i]]);
+		}
+
+		cache_count = min(new_cache_count, mesh::forsyth_cache_size);
+		memcpy(cache, new_cache, cache_count * sizeof(u32));
+
+		// Update scores of the cached vertices and their triangles, picking the next best triangle on the way.
+		for (u32 i = 0; i < cache_count; ++i) {
+			auto vertex_index = cache[i];
+			cache_positions[vertex_index] = i;
+			vertex_scores[vertex_index] = mesh::forsyth_vertex_score(i, remaining_triangle_counts[vertex_index]);
+		}
+
+		best_triangle = ~0u;
+		best_score = -1;
+		for (u32 i = 0; i < cache_count; ++i) {
+			auto vertex_index = cache[i];
+			auto begin = vertex_triangles.data + vertex_triangle_offsets[vertex_index];
+			auto end = begin + remaining_triangle_counts[vertex_index];
+			for (auto it = begin; it != end; ++it) {
+				auto t = indices.data + *it * 3;
+				auto score = triangle_scores[*it] = vertex_scores[t[0]] + vertex_scores[t[1]] + vertex_scores[t[2]];
+				if (score > best_score) {
+					best_score = score;
+					best_triangle = *it;
+				}
+			}
+		}
+	}
+}
+
+void optimize_overdraw(Span<u32> destination, Span<u32> source, f32 const *positions, u32 position_stride, u32 vertex_count, f32 threshold) {
+	assert(source.count % 3 == 0);
+	assert(destination.count >= source.count);
+
+	u32 triangle_count = source.count / 3;
+	if (!triangle_count)
+		return;
+
+	List<u32> indices;
+	List<u32> cluster_starts;
+	List<u32> vertex_timestamps;
+	defer {
+		free(indices);
+		free(cluster_starts);
+		free(vertex_timestamps);
+	};
+
+	indices.resize(source.count);
+	memcpy(indices.data, source.data, source.count * sizeof(u32));
+
+	auto position = [&](u32 index) {
+		auto p = (f32 const *)((u8 const *)positions + (umm)index * position_stride);
+		return v3f{p[0], p[1], p[2]};
+	};
+
+	// Split into clusters. Boundaries are allowed only at triangles that miss the cache entirely,
+	// where restarting costs nothing. A boundary is taken when the cluster so far is at most
+	// `threshold` times worse than the whole mesh.
+	constexpr u32 cache_size = 16;
+	vertex_timestamps.resize(vertex_count);
+	memset(vertex_timestamps.data, 0, vertex_count * sizeof(u32));
+	u32 time = cache_size + 1;
+
+	auto mesh_acmr = analyze_vertex_cache(indices, vertex_count, 1, cache_size).acmr;
+
+	u32 cluster_misses = 0;
+	u32 cluster_triangle_count = 0;
+	cluster_starts.add(0);
+	for (u32 triangle_index = 0; triangle_index < triangle_count; ++triangle_index) {
+		u32 misses = 0;
+		for (u32 corner = 0; corner < 3; ++corner) {
+			auto index = indices[triangle_index * 3 + corner];
+			if (time - vertex_timestamps[index] > cache_size) {
+				vertex_timestamps[index] = time++;
+				++misses;
+			}
+		}
+
+		if (misses == 3 && cluster_triangle_count && (f32)cluster_misses / cluster_triangle_count <= mesh_acmr * threshold) {
+			cluster_starts.add(triangle_index);
+			cluster_misses = 0;
+			cluster_triangle_count = 0;
+		}
+
+		cluster_misses += misses;
+		++cluster_triangle_count;
+	}
+
+	u32 cluster_count = cluster_starts.count;
+	cluster_starts.add(triangle_count);
+
+	// Sort clusters by how much they occlude: centroid offset from the mesh center along the cluster's normal.
+	v3f mesh_center = {};
+	f32 mesh_area = 0;
+
+	struct Cluster {
+		v3f center;
+		v3f normal;
+		f32 area;
+		f32 sort_key;
+		u32 index;
+	};
+
+	List<Cluster> clusters;
+	defer { free(clusters); };
+	clusters.resize(cluster_count);
+
+	for (u32 cluster_index = 0; cluster_index < cluster_count; ++cluster_index) {
+		auto &cluster = clusters[cluster_index];
+		cluster = {};
+		cluster.index = cluster_index;
+
+		for (u32 triangle_index = cluster_starts[cluster_index]; triangle_index < cluster_starts[cluster_index + 1]; ++triangle_index) {
+			auto a = position(indices[triangle_index * 3 + 0]);
+			auto b = position(indices[triangle_index * 3 + 1]);
+			auto c = position(indices[triangle_index * 3 + 2]);
+
+			// Length of the cross product is twice the area, weighting by it makes big triangles matter more.
+			auto n = cross(b - a, c - a);
+			auto area = length(n);
+
+			cluster.center += (a + b + c) * (area / 3);
+			cluster.normal += n;
+			cluster.area += area;
+		}
+
+		mesh_center += cluster.center;
+		mesh_area += cluster.area;
+
+		if (cluster.area > 0)
+			cluster.center /= cluster.area;
+		auto normal_length = length(cluster.normal);
+		if (normal_length > 0)
+			cluster.normal /= normal_length;
+	}
+
+	if (mesh_area > 0)
+		mesh_center /= mesh_area;
+
+	for (auto &cluster : clusters) {
+		cluster.sort_key = dot(cluster.center - mesh_center, cluster.normal);
+	}
+
+	// Insertion sort, descending. Cluster counts are small and the order is often close already.
+	for (u32 i = 1; i < cluster_count; ++i) {
+		auto cluster = clusters[i];
+		u32 j = i;
+		while (j && clusters[j - 1].sort_key < cluster.sort_key) {
+			clusters[j] = clusters[j - 1];
+			--j;
+		}
+		clusters[j] = cluster;
+	}
+
+	u32 cursor = 0;
+	for (auto &cluster : clusters) {
+		auto begin = cluster_starts[cluster.index] * 3;
+		auto end = cluster_starts[cluster.index + 1] * 3;
+		memcpy(destination.data + cursor, indices.data + begin, (end - begin) * sizeof(u32));
+		cursor += end - begin;
+	}
+}
+
+u32 optimize_vertex_fetch(void *destination, Span<u32> indices, void const *vertices, u32 vertex_count, u32 vertex_size) {
+	assert(destination != vertices);
+
+	List<u32> remap;
+	defer { free(remap); };
+	remap.resize(vertex_count);
+	memset(remap.data, 0xff, vertex_count * sizeof(u32));
+
+	u32 next_vertex = 0;
+	for (auto &index : indices) {
+		auto &new_index = remap[index];
+		if (new_index == ~0u) {
+			new_index = next_vertex++;
+			memcpy((u8 *)destination + (umm)new_index * vertex_size, (u8 const *)vertices + (umm)index * vertex_size, vertex_size);
+		}
+		index = new_index;
+	}
+	return next_vertex;
+}
+
+MeshFile parse_mesh_file(Span<u8> data) {
+	if (data.count < sizeof(MeshFileHeader))
+		return {};
+
+	auto &header = *(MeshFileHeader *)data.data;
+	if (header.magic != mesh_file_magic || header.version != mesh_file_version)
+		return {};
+
+	umm elements_end = sizeof(MeshFileHeader) + header.element_count * sizeof(ElementType);
+	umm vertices_end = header.vertex_offset + (umm)header.vertex_count * header.vertex_size;
+	umm indices_end  = header.index_offset  + (umm)header.index_count  * header.index_size;
+	if (elements_end > data.count || vertices_end > data.count || indices_end > data.count)
+		return {};
+
+	MeshFile result;
+	result.elements   = {(ElementType *)(data.data + sizeof(MeshFileHeader)), header.element_count};
+	result.vertices   = {data.data + header.vertex_offset, (umm)header.vertex_count * header.vertex_size};
+	result.indices    = {data.data + header.index_offset,  (umm)header.index_count  * header.index_size};
+	result.index_size = header.index_size;
+	return result;
+}
+
+}
+
+#endif
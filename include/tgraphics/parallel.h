@@ -0,0 +1,43 @@
+#pragma once
+#include <tl/common.h>
+#include <tl/thread.h>
+
+using namespace tl;
+
+namespace tgraphics {
+
+// Upper bound on the number of chunks a range is split into.
+// Callers that keep per-chunk data can size their arrays with this.
+inline constexpr u32 max_parallel_chunk_count = 64;
+
+// Number of chunks `parallel_for` will split `count` items into.
+// Always 1 when `pool` is null or there is not enough work to split.
+inline u32 get_parallel_chunk_count(ThreadPool *pool, umm count, umm min_items_per_chunk) {
+	if (!pool || count < min_items_per_chunk * 2)
+		return 1;
+	return (u32)min<umm>(count / min_items_per_chunk, max_parallel_chunk_count);
+}
+
+// Calls `fn(chunk_index, begin, end)` for each chunk of [0, count).
+// Chunks are pushed to `pool` and this function returns after all of them are finished.
+// With no pool or a small range everything runs on the calling thread.
+template <class Fn>
+void parallel_for(ThreadPool *pool, umm count, umm min_items_per_chunk, Fn &&fn) {
+	auto chunk_count = get_parallel_chunk_count(pool, count, min_items_per_chunk);
+	if (chunk_count == 1) {
+		fn((u32)0, (umm)0, count);
+		return;
+	}
+
+	auto queue = make_work_queue(*pool);
+	for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+		umm begin = count *  chunk_index      / chunk_count;
+		umm end   = count * (chunk_index + 1) / chunk_count;
+		queue.push([&fn, chunk_index, begin, end] {
+			fn(chunk_index, begin, end);
+		});
+	}
+	queue.wait_for_completion();
+}
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include "tgraphics.h"
+
+namespace tgraphics {
+
+// Helpers for converting float vertex data into packed ElementTypes.
+//
+// Every function reads `count` vectors from tightly packed floats in `source`
+// and writes them `destination_stride` bytes apart, so one call fills one attribute
+// of an interleaved vertex buffer. Pass the element size as the stride for a separate stream.
+// Values are clamped to the representable range and rounded to nearest.
+
+TGRAPHICS_API void quantize_u8x4n (f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_s8x4n (f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_u16x2n(f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_s16x2n(f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_u16x4n(f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_s16x4n(f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_f16x2  (f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_f16x4  (f32 const *source, umm count, void *destination, umm destination_stride);
+
+// Source vectors have four components, w is stored in the 2 bit field.
+TGRAPHICS_API void quantize_u10x3_u2n(f32 const *source, umm count, void *destination, umm destination_stride);
+TGRAPHICS_API void quantize_s10x3_s2n(f32 const *source, umm count, void *destination, umm destination_stride);
+
+TGRAPHICS_API u16 f32_to_f16(f32 value);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+#include <immintrin.h>
+
+namespace tgraphics {
+
+// Round to nearest even, overflow goes to infinity, NaN stays NaN.
+u16 f32_to_f16(f32 value) {
+	u32 f;
+	memcpy(&f, &value, 4);
+
+	u32 sign = f & 0x80000000;
+	f ^= sign;
+
+	u32 result;
+	if (f >= (127 + 16) << 23) {
+		result = f > (255 << 23) ? 0x7e00 : 0x7c00;
+	} else if (f < (113 << 23)) {
+		// Subnormal or zero. Adding this constant makes the FPU do the rounding.
+		u32 denormal_magic_bits = ((127 - 15) + (23 - 10) + 1) << 23;
+		f32 denormal_magic;
+		memcpy(&denormal_magic, &denormal_magic_bits, 4);
+
+		f32 shifted;
+		memcpy(&shifted, &f, 4);
+		shifted += denormal_magic;
+		memcpy(&f, &shifted, 4);
+		result = f - denormal_magic_bits;
+	} else {
+		u32 mantissa_odd = (f >> 13) & 1;
+		f += ((15 - 127) << 23) + 0xfff + mantissa_odd;
+		result = f >> 13;
+	}
+	return (u16)(result | (sign >> 16));
+}
+
+namespace quantize {
+
+inline void store_u32(void *destination, umm index, umm stride, u32 value) {
+	memcpy((u8 *)destination + index * stride, &value, 4);
+}
+
+// Clamps four floats to [min, max], scales and rounds them to 32 bit integers.
+inline __m128i scale_and_round(__m128 v, f32 minimum, f32 maximum, f32 scale) {
+	v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(minimum)), _mm_set1_ps(maximum));
+	return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(scale)));
+}
+
+// Packs eight 32 bit integers in [0, 65535] to unsigned 16 bits with SSE2 only (no packus_epi32).
+inline __m128i pack_u16(__m128i a, __m128i b) {
+	auto bias = _mm_set1_epi32(0x8000);
+	auto packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+	return _mm_xor_si128(packed, _mm_set1_epi16((short)0x8000));
+}
+
+// Converts 4 component vectors into 4 bytes each.
+template <bool is_signed>
+void quantize_8x4(f32 const *source, umm count, void *destination, umm stride) {
+	f32 minimum = is_signed ? -1.0f : 0.0f;
+	f32 scale   = is_signed ? 127.0f : 255.0f;
+
+	umm i = 0;
+	for (; i + 4 <= count; i += 4) {
+		auto a = scale_and_round(_mm_loadu_ps(source + i * 4 +  0), minimum, 1, scale);
+		auto b = scale_and_round(_mm_loadu_ps(source + i * 4 +  4), minimum, 1, scale);
+		auto c = scale_and_round(_mm_loadu_ps(source + i * 4 +  8), minimum, 1, scale);
+		auto d = scale_and_round(_mm_loadu_ps(source + i * 4 + 12), minimum, 1, scale);
+
+		auto ab = _mm_packs_epi32(a, b);
+		auto cd = _mm_packs_epi32(c, d);
+		auto packed = is_signed ? _mm_packs_epi16(ab, cd) : _mm_packus_epi16(ab, cd);
+
+		alignas(16) u32 vectors[4];
+		_mm_store_si128((__m128i *)vectors, packed);
+		for (u32 j = 0; j < 4; ++j) {
+			store_u32(destination, i + j, stride, vectors[j]);
+		}
+	}
+	for (; i < count; ++i) {
+		u32 packed = 0;
+		for (u32 j = 0; j < 4; ++j) {
+			auto v = (s32)roundf(clamp(source[i * 4 + j], minimum, 1.0f) * scale);
+			packed |= (u32)(v & 0xff) << (j * 8);
+		}
+		store_u32(destination, i, stride, packed);
+	}
+}
+
+// Converts vectors of `component_count` floats into 16 bits per component.
+template <bool is_signed, u32 component_count>
+void quantize_16(f32 const *source, umm count, void *destination, umm stride) {
+	f32 minimum = is_signed ? -1.0f : 0.0f;
+	f32 scale   = is_signed ? 32767.0f : 65535.0f;
+
+	constexpr u32 vector_size = component_count * 2;
+	constexpr u32 vectors_per_iteration = 8 / component_count;
+
+	umm scalar_count = count * component_count;
+	umm i = 0;
+	for (; i + 8 <= scalar_count; i += 8) {
+		auto a = scale_and_round(_mm_loadu_ps(source + i + 0), minimum, 1, scale);
+		auto b = scale_and_round(_mm_loadu_ps(source + i + 4), minimum, 1, scale);
+		auto packed = is_signed ? _mm_packs_epi32(a, b) : pack_u16(a, b);
+
+		alignas(16) u8 bytes[16];
+		_mm_store_si128((__m128i *)bytes, packed);
+		for (u32 j = 0; j < vectors_per_iteration; ++j) {
+			memcpy((u8 *)destination + (i / component_count + j) * stride, bytes + j * vector_size, vector_size);
+		}
+	}
+	for (; i < scalar_count; ++i) {
+		auto v = (s32)roundf(clamp(source[i], minimum, 1.0f) * scale);
+		u16 value = (u16)v;
+		memcpy((u8 *)destination + (i / component_count) * stride + (i % component_count) * 2, &value, 2);
+	}
+}
+
+template <u32 component_count>
+void quantize_f16(f32 const *source, umm count, void *destination, umm stride) {
+	constexpr u32 vector_size = component_count * 2;
+
+	umm scalar_count = count * component_count;
+	umm i = 0;
+#if defined(__F16C__) || defined(__AVX2__)
+	constexpr u32 vectors_per_iteration = 4 / component_count;
+	for (; i + 4 <= scalar_count; i += 4) {
+		alignas(16) u8 bytes[16];
+		_mm_storel_epi64((__m128i *)bytes, _mm_cvtps_ph(_mm_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT));
+		for (u32 j = 0; j < vectors_per_iteration; ++j) {
+			memcpy((u8 *)destination + (i / component_count + j) * stride, bytes + j * vector_size, vector_size);
+		}
+	}
+#endif
+	for (; i < scalar_count; ++i) {
+		u16 value = f32_to_f16(source[i]);
+		memcpy((u8 *)destination + (i / component_count) * stride + (i % component_count) * 2, &value, 2);
+	}
+}
+
+// x, y, z go to bits 0-9, 10-19, 20-29 and w to bits 30-31.
+template <bool is_signed>
+void quantize_10_10_10_2(f32 const *source, umm count, void *destination, umm stride) {
+	f32 minimum = is_signed ? -1.0f : 0.0f;
+	auto minimum4 = _mm_set1_ps(minimum);
+	auto maximum4 = _mm_set1_ps(1.0f);
+	auto scale    = is_signed ? _mm_setr_ps(511, 511, 511, 1) : _mm_setr_ps(1023, 1023, 1023, 3);
+	auto mask     = _mm_setr_epi32(0x3ff, 0x3ff, 0x3ff, 0x3);
+
+	for (umm i = 0; i < count; ++i) {
+		auto v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i * 4), minimum4), maximum4);
+		auto fields = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(v, scale)), mask);
+
+		alignas(16) u32 f[4];
+		_mm_store_si128((__m128i *)f, fields);
+		store_u32(destination, i, stride, f[0] | (f[1] << 10) | (f[2] << 20) | (f[3] << 30));
+	}
+}
+
+}
+
+void quantize_u8x4n (f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_8x4<false>(source, count, destination, stride); }
+void quantize_s8x4n (f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_8x4<true >(source, count, destination, stride); }
+void quantize_u16x2n(f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_16<false, 2>(source, count, destination, stride); }
+void quantize_s16x2n(f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_16<true , 2>(source, count, destination, stride); }
+void quantize_u16x4n(f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_16<false, 4>(source, count, destination, stride); }
+void quantize_s16x4n(f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_16<true , 4>(source, count, destination, stride); }
+void quantize_f16x2  (f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_f16<2>(source, count, destination, stride); }
+void quantize_f16x4  (f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_f16<4>(source, count, destination, stride); }
+void quantize_u10x3_u2n(f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_10_10_10_2<false>(source, count, destination, stride); }
+void quantize_s10x3_s2n(f32 const *source, umm count, void *destination, umm stride) { quantize::quantize_10_10_10_2<true >(source, count, destination, stride); }
+
+}
+
+#endif
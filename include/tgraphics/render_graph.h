@@ -0,0 +1,362 @@
+#pragma once
+#include "tgraphics.h"
+
+namespace tgraphics {
+
+// Frame graph for offscreen passes.
+//
+// Every frame passes are added with the textures they read and write, then `execute` runs them.
+// Passes whose results are not used by an output are skipped.
+// Transient textures live only from the first to the last pass that uses them, and textures
+// of the same size and format whose lifetimes do not overlap share one physical texture.
+// Physical textures are kept between frames. When the size changes, stale ones are resized
+// instead of allocating new ones, so a window resize reallocates the pool once.
+//
+// Example:
+//
+//   auto scene = create_texture(graph, {.format = Format_rgba_f16});
+//   auto depth = create_texture(graph, {.format = Format_depth});
+//   auto bloom = create_texture(graph, {.format = Format_rgba_f16, .scale = {.5f, .5f}});
+//   add_pass(graph, {.name = u8"scene"s,     .color = scene, .depth = depth, .execute = draw_scene});
+//   add_pass(graph, {.name = u8"bloom"s,     .reads = {&scene, 1}, .color = bloom, .execute = draw_bloom});
+//   add_pass(graph, {.name = u8"composite"s, .reads = reads, .target = state->back_buffer, .execute = composite});
+//   execute(state, graph);
+
+using RenderGraphTexture = u32;
+inline constexpr RenderGraphTexture render_graph_none = ~0u;
+
+struct RenderGraphTextureDesc {
+	Format format = Format_rgba_u8n;
+
+	// If `size` is zero the texture is `scale` times `RenderGraph::reference_size`.
+	v2u size = {};
+	v2f scale = {1, 1};
+};
+
+struct RenderGraph;
+
+struct RenderGraphContext {
+	RenderGraph *graph;
+	void *user_data;
+
+	// Physical texture of `texture`, valid only during this pass.
+	Texture2D *get_texture(RenderGraphTexture texture);
+};
+
+struct RenderGraphPass {
+	Span<utf8> name;
+	Span<RenderGraphTexture> reads;
+
+	// Bound as the render target before `execute` is called.
+	RenderGraphTexture color = render_graph_none;
+	RenderGraphTexture depth = render_graph_none;
+
+	// Render target outside of the graph, e.g. the back buffer. Used instead of `color` and `depth`.
+	// Passes that write to it are outputs and are never culled.
+	RenderTarget *target = 0;
+
+	// Keep the pass even if nothing reads its results, e.g. for readbacks.
+	bool has_side_effects = false;
+
+	void (*execute)(State *state, RenderGraphContext &context) = 0;
+	void *user_data = 0;
+};
+
+struct RenderGraph {
+	struct TextureNode {
+		RenderGraphTextureDesc desc;
+		v2u size;
+		Texture2D *imported;
+		u32 first_pass;
+		u32 last_pass;
+		u32 physical; // index into `pool`
+	};
+	struct PassNode {
+		RenderGraphPass pass;
+		u32 first_read; // index into `reads`
+		u32 read_count;
+		bool alive;
+	};
+	struct PooledTexture {
+		Texture2D *texture;
+		Format format;
+		u64 last_used_frame;
+		v2u reference_size; // `RenderGraph::reference_size` when it was last used
+		bool relative;      // last used by a texture sized relative to `reference_size`
+		bool in_use;
+	};
+	struct CachedRenderTarget {
+		Texture2D *color;
+		Texture2D *depth;
+		RenderTarget *target;
+	};
+
+	// Size that relative textures are scaled from, usually the window size.
+	v2u reference_size = {};
+
+	// Declarations of the current frame, cleared by `execute`.
+	List<TextureNode> textures;
+	List<PassNode> passes;
+	List<RenderGraphTexture> reads;
+
+	// Kept between frames.
+	List<PooledTexture> pool;
+	List<CachedRenderTarget> render_targets;
+	u64 frame_index = 0;
+};
+
+TGRAPHICS_API RenderGraphTexture create_texture(RenderGraph &graph, RenderGraphTextureDesc desc);
+
+// Makes a texture created outside of the graph usable by passes.
+// Passes that write imported textures are outputs and are never culled.
+TGRAPHICS_API RenderGraphTexture import_texture(RenderGraph &graph, Texture2D *texture);
+
+TGRAPHICS_API void add_pass(RenderGraph &graph, RenderGraphPass const &pass);
+
+// Culls, allocates and runs the passes added since the last call.
+TGRAPHICS_API void execute(State *state, RenderGraph &graph);
+
+// Frees CPU side memory. GPU resources stay alive with the state.
+TGRAPHICS_API void free(RenderGraph &graph);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+Texture2D *RenderGraphContext::get_texture(RenderGraphTexture texture) {
+	assert(texture < graph->textures.count);
+	auto &node = graph->textures[texture];
+	if (node.imported)
+		return node.imported;
+	assert(node.physical < graph->pool.count, "RenderGraphContext::get_texture: texture is not used by this pass");
+	return graph->pool[node.physical].texture;
+}
+
+RenderGraphTexture create_texture(RenderGraph &graph, RenderGraphTextureDesc desc) {
+	RenderGraph::TextureNode node = {};
+	node.desc = desc;
+	node.physical = ~0u;
+	graph.textures.add(node);
+	return (RenderGraphTexture)(graph.textures.count - 1);
+}
+
+RenderGraphTexture import_texture(RenderGraph &graph, Texture2D *texture) {
+	assert(texture);
+	RenderGraph::TextureNode node = {};
+	node.imported = texture;
+	node.size = texture->size;
+	node.physical = ~0u;
+	graph.textures.add(node);
+	return (RenderGraphTexture)(graph.textures.count - 1);
+}
+
+void add_pass(RenderGraph &graph, RenderGraphPass const &pass) {
+	assert(pass.execute, "add_pass: pass has no execute function");
+	assert(pass.color == render_graph_none || pass.color < graph.textures.count);
+	assert(pass.depth == render_graph_none || pass.depth < graph.textures.count);
+
+	RenderGraph::PassNode node = {};
+	node.pass = pass;
+	// `reads` may point to caller's temporary memory, keep a copy.
+	node.pass.reads = {};
+	node.first_read = (u32)graph.reads.count;
+	node.read_count = (u32)pass.reads.count;
+	for (auto read : pass.reads) {
+		assert(read < graph.textures.count);
+		graph.reads.add(read);
+	}
+	graph.passes.add(node);
+}
+
+namespace render_graph {
+
+inline bool is_output(RenderGraph &graph, RenderGraph::PassNode &node) {
+	auto &pass = node.pass;
+	if (pass.target || pass.has_side_effects)
+		return true;
+	if (pass.color != render_graph_none && graph.textures[pass.color].imported)
+		return true;
+	if (pass.depth != render_graph_none && graph.textures[pass.depth].imported)
+		return true;
+	return false;
+}
+
+inline Span<RenderGraphTexture> get_reads(RenderGraph &graph, RenderGraph::PassNode &node) {
+	return {graph.reads.data + node.first_read, node.read_count};
+}
+
+// Returns an idle pooled texture of this format and size, resizing or creating one if needed.
+// Textures used in the last two frames are not resized so differently sized textures do not thrash,
+// unless they were sized relative to a reference size that changed since, then their size is outdated anyway.
+// `relative` tells whether `size` was computed from the reference size.
+inline u32 acquire(State *state, RenderGraph &graph, Format format, v2u size, bool relative) {
+	auto use = [&](RenderGraph::PooledTexture &entry) {
+		entry.in_use = true;
+		entry.last_used_frame = graph.frame_index;
+		entry.reference_size = graph.reference_size;
+		entry.relative = relative;
+	};
+
+	u32 stale = ~0u;
+	for (u32 i = 0; i < graph.pool.count; ++i) {
+		auto &entry = graph.pool[i];
+		if (entry.in_use || entry.format != format)
+			continue;
+		if (all_true(entry.texture->size == size)) {
+			use(entry);
+			return i;
+		}
+		if (stale == ~0u && (entry.last_used_frame + 2 <= graph.frame_index || (entry.relative && any_true(entry.reference_size != graph.reference_size))))
+			stale = i;
+	}
+
+	if (stale != ~0u) {
+		auto &entry = graph.pool[stale];
+		state->resize_texture_2d(entry.texture, size);
+		use(entry);
+		return stale;
+	}
+
+	RenderGraph::PooledTexture entry = {};
+	entry.texture = state->create_texture_2d(size, 0, format);
+	entry.format = format;
+	use(entry);
+	graph.pool.add(entry);
+	return (u32)(graph.pool.count - 1);
+}
+
+inline RenderTarget *get_render_target(State *state, RenderGraph &graph, Texture2D *color, Texture2D *depth) {
+	for (auto &cached : graph.render_targets) {
+		if (cached.color == color && cached.depth == depth)
+			return cached.target;
+	}
+	RenderGraph::CachedRenderTarget cached = {};
+	cached.color = color;
+	cached.depth = depth;
+	cached.target = state->create_render_target(color, depth);
+	graph.render_targets.add(cached);
+	return cached.target;
+}
+
+}
+
+void execute(State *state, RenderGraph &graph) {
+	using namespace render_graph;
+
+	defer {
+		graph.textures.clear();
+		graph.passes.clear();
+		graph.reads.clear();
+		++graph.frame_index;
+	};
+
+	// Cull: walk backwards from the outputs, keeping every pass that writes a texture a kept pass reads.
+	// A written texture stays needed by earlier writers too, because a pass may draw on top of previous contents.
+	Span<bool> needed = {state->frame_alloc<bool>(graph.textures.count), graph.textures.count};
+	for (auto &n : needed)
+		n = false;
+
+	for (umm pass_index = graph.passes.count; pass_index--;) {
+		auto &node = graph.passes[pass_index];
+		auto &pass = node.pass;
+
+		node.alive = is_output(graph, node)
+			|| (pass.color != render_graph_none && needed[pass.color])
+			|| (pass.depth != render_graph_none && needed[pass.depth]);
+
+		if (node.alive) {
+			for (auto read : get_reads(graph, node))
+				needed[read] = true;
+		}
+	}
+
+	// Lifetimes of transient textures, in indices of alive passes.
+	for (auto &texture : graph.textures) {
+		texture.first_pass = ~0u;
+		texture.last_pass = 0;
+		if (!texture.imported) {
+			texture.size = texture.desc.size;
+			if (!texture.size.x || !texture.size.y) {
+				texture.size = {
+					max(1u, (u32)(graph.reference_size.x * texture.desc.scale.x)),
+					max(1u, (u32)(graph.reference_size.y * texture.desc.scale.y)),
+				};
+			}
+		}
+	}
+	auto use = [&](RenderGraphTexture texture, u32 pass_index) {
+		if (texture == render_graph_none)
+			return;
+		auto &node = graph.textures[texture];
+		node.first_pass = min(node.first_pass, pass_index);
+		node.last_pass  = max(node.last_pass,  pass_index);
+	};
+	for (u32 pass_index = 0; pass_index < graph.passes.count; ++pass_index) {
+		auto &node = graph.passes[pass_index];
+		if (!node.alive)
+			continue;
+		use(node.pass.color, pass_index);
+		use(node.pass.depth, pass_index);
+		for (auto read : get_reads(graph, node))
+			use(read, pass_index);
+	}
+
+	for (auto &entry : graph.pool)
+		entry.in_use = false;
+
+	// Passes run in the order they were added. A pass can only read what earlier passes wrote,
+	// so that order already satisfies every dependency.
+	for (u32 pass_index = 0; pass_index < graph.passes.count; ++pass_index) {
+		auto &node = graph.passes[pass_index];
+		if (!node.alive)
+			continue;
+
+		auto &pass = node.pass;
+
+		for (u32 texture_index = 0; texture_index < graph.textures.count; ++texture_index) {
+			auto &texture = graph.textures[texture_index];
+			if (!texture.imported && texture.first_pass == pass_index) {
+				texture.physical = acquire(state, graph, texture.desc.format, texture.size, !texture.desc.size.x || !texture.desc.size.y);
+			}
+		}
+
+		RenderGraphContext context = {
+			.graph = &graph,
+			.user_data = pass.user_data,
+		};
+
+		if (pass.target) {
+			state->set_render_target(pass.target);
+			auto size = pass.target->color ? pass.target->color->size : pass.target->depth->size;
+			state->set_viewport(size);
+		} else if (pass.color != render_graph_none || pass.depth != render_graph_none) {
+			auto color = pass.color != render_graph_none ? context.get_texture(pass.color) : 0;
+			auto depth = pass.depth != render_graph_none ? context.get_texture(pass.depth) : 0;
+			state->set_render_target(get_render_target(state, graph, color, depth));
+			state->set_viewport((color ? color : depth)->size);
+		}
+
+		pass.execute(state, context);
+
+		// Free textures whose last reader was this pass, so later passes can alias them.
+		for (auto &texture : graph.textures) {
+			if (!texture.imported && texture.first_pass != ~0u && texture.last_pass == pass_index) {
+				graph.pool[texture.physical].in_use = false;
+			}
+		}
+	}
+}
+
+void free(RenderGraph &graph) {
+	free(graph.textures);
+	free(graph.passes);
+	free(graph.reads);
+	free(graph.pool);
+	free(graph.render_targets);
+}
+
+}
+
+#endif
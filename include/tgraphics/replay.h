@@ -0,0 +1,311 @@
+#pragma once
+#include "tgraphics.h"
+#include "capture.h"
+
+namespace tgraphics {
+
+// Executes `data`, a trace recorded with `start_capture` against `state`, which should be freshly initialized.
+// Resources created by the trace stay alive with the state.
+
+struct ReplayParams {
+	// Waits before every present until as much time passed as when the trace was captured.
+	// Otherwise calls are executed as fast as possible.
+	bool paced = false;
+};
+
+struct ReplayStats {
+	u32 frame_count;
+	u64 call_count;
+	f64 seconds;
+};
+
+// Returns false if the trace is malformed or was written for a different api.
+TGRAPHICS_API bool replay_trace(State *state, Span<u8> data, ReplayParams params = {}, ReplayStats *stats = 0);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+struct Replay {
+	u8 *cursor;
+	u8 *end;
+	bool failed;
+
+	State *state;
+	List<void *> handles; // in creation order
+
+	// Shader constants and vertex buffers that are currently mapped.
+	struct MappedBuffer {
+		void *buffer;
+		void *data;
+	};
+	List<MappedBuffer> mapped_buffers;
+};
+
+namespace trace {
+
+// Returns null and marks the replay as failed if the trace ends early.
+inline u8 *read_bytes(Replay &replay, umm size) {
+	if ((umm)(replay.end - replay.cursor) < size) {
+		replay.failed = true;
+		replay.cursor = replay.end;
+		return 0;
+	}
+	auto result = replay.cursor;
+	replay.cursor += size;
+	return result;
+}
+
+template <class T>
+void read_raw(Replay &replay, T &value) {
+	if (auto bytes = read_bytes(replay, sizeof(value)))
+		memcpy(&value, bytes, sizeof(value));
+}
+
+template <class T>
+void read_value(Replay &replay, T &value) {
+	read_raw(replay, value);
+}
+
+template <class T>
+void read_value(Replay &replay, T *&pointer) {
+	u32 handle = trace_null_handle;
+	read_raw(replay, handle);
+	pointer = 0;
+	if (handle == trace_null_handle)
+		return;
+	if (handle >= replay.handles.count) {
+		replay.failed = true;
+		return;
+	}
+	pointer = (T *)replay.handles[handle];
+}
+
+// Byte sized elements are used in place, others are copied so they are aligned.
+template <class T>
+void read_value(Replay &replay, Span<T> &span) {
+	u64 count = 0;
+	read_raw(replay, count);
+	auto bytes = read_bytes(replay, count * sizeof(T));
+	if (!bytes) {
+		span = {};
+		return;
+	}
+	if constexpr (alignof(T) == 1) {
+		span = {(T *)bytes, (umm)count};
+	} else {
+		span = {replay.state->frame_alloc<T>(count), (umm)count};
+		memcpy(span.data, bytes, count * sizeof(T));
+	}
+}
+
+inline void read_value(Replay &replay, Span<Texture2D *> &textures) {
+	u64 count = 0;
+	read_raw(replay, count);
+	if (count > (umm)(replay.end - replay.cursor) / sizeof(u32)) {
+		replay.failed = true;
+		textures = {};
+		return;
+	}
+	textures = {replay.state->frame_alloc<Texture2D *>(count), (umm)count};
+	for (auto &texture : textures)
+		read_value(replay, texture);
+}
+
+inline void read_value(Replay &replay, Span<VertexStream> &streams) {
+	u64 count = 0;
+	read_raw(replay, count);
+	if (count > (umm)(replay.end - replay.cursor)) {
+		replay.failed = true;
+		streams = {};
+		return;
+	}
+	streams = {replay.state->frame_alloc<VertexStream>(count), (umm)count};
+	for (auto &stream : streams) {
+		read_value(replay, stream.elements);
+		read_raw(replay, stream.step_rate);
+	}
+}
+
+inline void read_data(Replay &replay, void *&data) {
+	u64 size = 0;
+	read_raw(replay, size);
+	data = size ? read_bytes(replay, size) : 0;
+}
+inline void read_data(Replay &replay, void const *&data) {
+	void *mutable_data;
+	read_data(replay, mutable_data);
+	data = mutable_data;
+}
+
+inline void read_faces(Replay &replay, void **faces) {
+	for (u32 i = 0; i < 6; ++i)
+		read_data(replay, faces[i]);
+}
+
+template <class T>
+void replay_result(Replay &replay, T *result) {
+	replay.handles.add(result);
+}
+inline void replay_result(Replay &replay, void *result) {}
+template <class T>
+void replay_result(Replay &replay, T const &result) {}
+
+// Same order as capture_result.
+inline void replay_result(Replay &replay, RenderTarget *result) {
+	replay.handles.add(result);
+	if (!result)
+		return;
+	replay.handles.add(result->color);
+	for (u32 i = 1; i < result->color_count; ++i)
+		replay.handles.add(result->colors[i]);
+	replay.handles.add(result->depth);
+}
+
+// Copies the range recorded on unmap into the pointer `buffer` was mapped to and forgets it.
+// `size` is the size of the buffer, a range outside of it fails the replay.
+inline void replay_unmap(Replay &replay, void *buffer, u64 offset, void const *data, u64 data_size, umm size) {
+	if (offset > size || data_size > size - offset) {
+		replay.failed = true;
+		return;
+	}
+	for (umm i = 0; i < replay.mapped_buffers.count; ++i) {
+		auto mapped = replay.mapped_buffers[i];
+		if (mapped.buffer == buffer) {
+			if (data && mapped.data)
+				memcpy((u8 *)mapped.data + offset, data, data_size);
+			replay.mapped_buffers[i] = replay.mapped_buffers[replay.mapped_buffers.count - 1];
+			replay.mapped_buffers.count -= 1;
+			break;
+		}
+	}
+}
+
+}
+
+bool replay_trace(State *state, Span<u8> data, ReplayParams params, ReplayStats *stats) {
+	using namespace trace;
+
+	TraceHeader header = {};
+	if (data.count < sizeof(header)) {
+		print(Print_error, "replay_trace: trace is too small\n");
+		return false;
+	}
+	memcpy(&header, data.data, sizeof(header));
+	if (header.magic != trace_magic || header.version != trace_version || header.call_count != ApiCall_count) {
+		print(Print_error, "replay_trace: trace was written by a different version\n");
+		return false;
+	}
+
+	Replay replay = {};
+	replay.cursor = data.data + sizeof(header);
+	replay.end = data.data + data.count;
+	replay.state = state;
+	defer {
+		free(replay.handles);
+		free(replay.mapped_buffers);
+	};
+
+	replay_result(replay, state->back_buffer);
+
+	LARGE_INTEGER frequency, start_time;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start_time);
+
+	ReplayStats result = {};
+
+	// Generated cases call through `_state`, arguments may be named `state`.
+	auto _state = state;
+
+	while (replay.cursor < replay.end && !replay.failed) {
+		u16 call = 0;
+		read_raw(replay, call);
+
+		if (call == ApiCall_present) {
+			u64 captured_time = 0;
+			read_raw(replay, captured_time);
+			if (params.paced) {
+				while (true) {
+					LARGE_INTEGER now;
+					QueryPerformanceCounter(&now);
+					auto elapsed = (u64)((now.QuadPart - start_time.QuadPart) * 1'000'000 / frequency.QuadPart);
+					if (elapsed >= captured_time)
+						break;
+					if (captured_time - elapsed > 2000)
+						Sleep(1);
+				}
+			}
+			++result.frame_count;
+		}
+
+		switch (call) {
+			#include "generated/replay.h"
+
+			case ApiCall_map_shader_constants: {
+				ShaderConstants *constants = {};
+				Access access = {};
+				read_value(replay, constants);
+				read_value(replay, access);
+				replay.mapped_buffers.add({constants, _state->map_shader_constants(constants, access)});
+				break;
+			}
+			case ApiCall_unmap_shader_constants: {
+				ShaderConstants *constants = {};
+				u64 offset = 0;
+				u64 size = 0;
+				read_value(replay, constants);
+				read_raw(replay, offset);
+				read_raw(replay, size);
+				auto data = size ? read_bytes(replay, size) : 0;
+				if (constants)
+					replay_unmap(replay, constants, offset, data, size, ((gl::ShaderConstantsImpl *)constants)->values_size);
+				_state->unmap_shader_constants(constants);
+				break;
+			}
+			case ApiCall_map_vertex_buffer: {
+				VertexBuffer *buffer = {};
+				Access access = {};
+				read_value(replay, buffer);
+				read_value(replay, access);
+				replay.mapped_buffers.add({buffer, _state->map_vertex_buffer(buffer, access)});
+				break;
+			}
+			case ApiCall_unmap_vertex_buffer: {
+				VertexBuffer *buffer = {};
+				u64 offset = 0;
+				u64 size = 0;
+				read_value(replay, buffer);
+				read_raw(replay, offset);
+				read_raw(replay, size);
+				auto data = size ? read_bytes(replay, size) : 0;
+				if (buffer)
+					replay_unmap(replay, buffer, offset, data, size, ((gl::VertexBufferImpl *)buffer)->size);
+				_state->unmap_vertex_buffer(buffer);
+				break;
+			}
+			default: {
+				print(Print_error, "replay_trace: unknown call {}\n", call);
+				return false;
+			}
+		}
+		++result.call_count;
+	}
+
+	LARGE_INTEGER end_time;
+	QueryPerformanceCounter(&end_time);
+	result.seconds = (f64)(end_time.QuadPart - start_time.QuadPart) / frequency.QuadPart;
+	if (stats)
+		*stats = result;
+
+	if (replay.failed) {
+		print(Print_error, "replay_trace: trace ends in the middle of a call\n");
+		return false;
+	}
+	return true;
+}
+
+}
+
+#endif
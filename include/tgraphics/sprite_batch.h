@@ -0,0 +1,259 @@
+#pragma once
+#include "tgraphics.h"
+#include "atlas.h"
+#include "draw_queue.h"
+
+namespace tgraphics {
+
+// Batched 2D sprites drawn from a TextureAtlas.
+//
+// Sprites are collected during the frame, then `flush` sorts them by layer, blend mode and
+// atlas page, uploads all of them into one streaming instance buffer and issues one
+// instanced draw per run of equal keys. Within a run sprites keep the order they were added in.
+//
+// Positions are in pixels of the current render target with the origin in the bottom left corner.
+// `flush` overwrites the current shader, vertex layout, shader constants slot 0, texture and sampler slot 0 and blend state.
+//
+// Example:
+//
+//   add_sprite(batch, {.position = {10, 10}, .size = {32, 32}, .region = icon});
+//   flush(state, batch, atlas, window_size);
+
+enum SpriteBlend : u8 {
+	SpriteBlend_alpha,    // straight alpha
+	SpriteBlend_additive,
+	SpriteBlend_opaque,
+};
+
+struct Sprite {
+	v2f position; // bottom left corner
+	v2f size;
+	AtlasRegion region;
+	u32 color = 0xffffffff; // multiplies the texture, bytes are r, g, b, a
+	u16 layer = 0;          // higher layers are drawn later
+	SpriteBlend blend = SpriteBlend_alpha;
+};
+
+// One instance of the quad. Matches `sprite_instance_elements`.
+struct SpriteInstance {
+	v4f rect; // x, y, width, height
+	v4f uv;   // u0, v0, u1, v1
+	u32 color;
+};
+
+inline ElementType sprite_instance_elements[] = {Element_f32x4, Element_f32x4, Element_u8x4n};
+
+struct SpriteConstants {
+	v2f inverse_target_size;
+	v2f padding;
+};
+
+struct SpriteBatch {
+	Shader *shader;
+	TypedShaderConstants<SpriteConstants> constants;
+	VertexLayout *layout;
+	VertexBuffer *instances;
+
+	// Cleared by `flush`.
+	List<SpriteInstance> sprites;
+	List<u64> keys;
+
+	List<SpriteInstance> sorted;
+
+	// Statistics of the last `flush`.
+	u32 draw_count;
+	u32 sprite_count;
+};
+
+// `fragment_shader_source` replaces the default textured one. It receives `vertex_uv` and `vertex_color`
+// and samples the page from `uniform sampler2D atlas` at binding 0. Used e.g. for distance field text.
+TGRAPHICS_API SpriteBatch create_sprite_batch(State *state, Span<utf8> fragment_shader_source = {});
+
+// Frees CPU side memory. GPU resources stay alive with the state.
+TGRAPHICS_API void free(SpriteBatch &batch);
+
+TGRAPHICS_API void add_sprite(SpriteBatch &batch, Sprite const &sprite);
+
+// Draws and clears the sprites added since the last call. `target_size` is the size of the current render target.
+TGRAPHICS_API void flush(State *state, SpriteBatch &batch, TextureAtlas const &atlas, v2u target_size);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+namespace tgraphics {
+
+namespace sprite_batch {
+
+inline constexpr u32 page_bits  = 24;
+inline constexpr u32 blend_bits = 8;
+
+inline Span<utf8> const vertex_shader_source = u8R"(
+layout(binding = 0) uniform SpriteConstants {
+	vec2 inverse_target_size;
+};
+
+#ifdef VERTEX_SHADER
+layout(location = 0) in vec4 rect;
+layout(location = 1) in vec4 uv;
+layout(location = 2) in vec4 color;
+
+out vec2 vertex_uv;
+out vec4 vertex_color;
+
+void main() {
+	// Two counter-clockwise triangles.
+	vec2 corners[] = vec2[](
+		vec2(0, 0), vec2(1, 0), vec2(0, 1),
+		vec2(0, 1), vec2(1, 0), vec2(1, 1)
+	);
+	vec2 corner = corners[gl_VertexID];
+
+	vec2 position = rect.xy + corner * rect.zw;
+	gl_Position = vec4(position * inverse_target_size * 2 - 1, 0, 1);
+
+	// v0 is the first row of the image, which is its top.
+	vertex_uv = vec2(mix(uv.x, uv.z, corner.x), mix(uv.w, uv.y, corner.y));
+	vertex_color = color;
+}
+#endif
+)"s;
+
+inline Span<utf8> const fragment_shader_source = u8R"(
+#ifdef FRAGMENT_SHADER
+layout(binding = 0) uniform sampler2D atlas;
+
+in vec2 vertex_uv;
+in vec4 vertex_color;
+
+out vec4 fragment_color;
+
+void main() {
+	fragment_color = texture(atlas, vertex_uv) * vertex_color;
+}
+#endif
+)"s;
+
+inline u64 make_key(u16 layer, SpriteBlend blend, u32 page) {
+	assert(page < (1u << page_bits), "add_sprite: atlas page index is too big");
+	return ((u64)layer << (page_bits + blend_bits)) | ((u64)blend << page_bits) | page;
+}
+
+inline void set_blend(State *state, SpriteBlend blend) {
+	switch (blend) {
+		case SpriteBlend_alpha:    return state->set_blend(BlendFunction_add, Blend_source_alpha, Blend_one_minus_source_alpha);
+		case SpriteBlend_additive: return state->set_blend(BlendFunction_add, Blend_source_alpha, Blend_one);
+		case SpriteBlend_opaque:   return state->disable_blend();
+	}
+	invalid_code_path();
+}
+
+}
+
+SpriteBatch create_sprite_batch(State *state, Span<utf8> fragment_shader_source) {
+	using namespace sprite_batch;
+
+	if (!fragment_shader_source.count)
+		fragment_shader_source = sprite_batch::fragment_shader_source;
+
+	List<utf8> source;
+	defer { free(source); };
+	source.resize(vertex_shader_source.count + fragment_shader_source.count);
+	memcpy(source.data, vertex_shader_source.data, vertex_shader_source.count);
+	memcpy(source.data + vertex_shader_source.count, fragment_shader_source.data, fragment_shader_source.count);
+
+	SpriteBatch result = {};
+	result.shader = state->create_shader(source);
+	result.constants = state->create_shader_constants<SpriteConstants>();
+
+	VertexStream stream = {
+		.elements = {sprite_instance_elements, sizeof(sprite_instance_elements) / sizeof(sprite_instance_elements[0])},
+		.step_rate = 1,
+	};
+	result.layout = state->create_vertex_layout(Span(&stream, 1));
+
+	// Refilled every flush. No descriptor, it is bound through `layout`.
+	result.instances = state->create_vertex_buffer({}, {});
+	return result;
+}
+
+void free(SpriteBatch &batch) {
+	free(batch.sprites);
+	free(batch.keys);
+	free(batch.sorted);
+}
+
+void add_sprite(SpriteBatch &batch, Sprite const &sprite) {
+	batch.sprites.add({
+		.rect = {sprite.position.x, sprite.position.y, sprite.size.x, sprite.size.y},
+		.uv = sprite.region.uv,
+		.color = sprite.color,
+	});
+	batch.keys.add(sprite_batch::make_key(sprite.layer, sprite.blend, sprite.region.page));
+}
+
+void flush(State *state, SpriteBatch &batch, TextureAtlas const &atlas, v2u target_size) {
+	using namespace sprite_batch;
+
+	batch.draw_count = 0;
+	batch.sprite_count = (u32)batch.sprites.count;
+	if (!batch.sprites.count)
+		return;
+
+	defer {
+		batch.sprites.clear();
+		batch.keys.clear();
+	};
+
+	auto count = batch.sprites.count;
+
+	Span<u32> order           = {state->frame_alloc<u32>(count), count};
+	Span<u64> keys_scratch    = {state->frame_alloc<u64>(count), count};
+	Span<u32> indices_scratch = {state->frame_alloc<u32>(count), count};
+	for (u32 i = 0; i < count; ++i)
+		order[i] = i;
+
+	Span<u64> keys = batch.keys;
+	if (radix_sort(keys, order, keys_scratch, indices_scratch, 0, count)) {
+		keys = keys_scratch;
+		order = indices_scratch;
+	}
+
+	batch.sorted.resize(count);
+	for (umm i = 0; i < count; ++i)
+		batch.sorted[i] = batch.sprites[order[i]];
+
+	// Respecifying the whole buffer lets the driver hand out fresh storage instead of waiting for the previous frame.
+	state->update_vertex_buffer(batch.instances, as_bytes(Span<SpriteInstance>(batch.sorted)));
+
+	state->update_shader_constants(batch.constants, {.inverse_target_size = {1.0f / target_size.x, 1.0f / target_size.y}});
+
+	state->set_shader(batch.shader);
+	state->set_vertex_layout(batch.layout);
+	state->set_vertex_buffers(0, batch.instances, 0, sizeof(SpriteInstance));
+	state->set_shader_constants(batch.constants, 0);
+	state->set_sampler(Filtering_linear, 0);
+	state->set_topology(Topology_triangle_list);
+
+	u32 first = 0;
+	while (first < count) {
+		auto key = keys[first];
+		u32 end = first + 1;
+		while (end < count && keys[end] == key)
+			++end;
+
+		auto page = (u32)(key & ((1u << page_bits) - 1));
+		assert(page < atlas.pages.count, "flush: sprite refers to a page that is not in the atlas");
+
+		set_blend(state, (SpriteBlend)((key >> page_bits) & ((1u << blend_bits) - 1)));
+		state->set_texture_2d(atlas.pages[page], 0);
+		state->draw_instanced(6, end - first, 0, first);
+		++batch.draw_count;
+
+		first = end;
+	}
+}
+
+}
+
+#endif
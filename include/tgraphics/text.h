@@ -0,0 +1,275 @@
+#pragma once
+#include "tgraphics.h"
+#include "atlas.h"
+#include "sprite_batch.h"
+
+#include <stb_truetype.h>
+#include <tl/hash_map.h>
+
+namespace tgraphics {
+
+// Signed distance field text.
+//
+// Glyphs are rasterized once, when they are first laid out, as distance fields at `FontParams::pixel_height`
+// into a shared single channel TextureAtlas. One distance field stays sharp over a wide range of sizes,
+// so every size of a font uses the same glyphs.
+// Laid out glyphs are sprites of a SpriteBatch created with `create_text_batch`, so a whole
+// paragraph is one instanced draw per atlas page.
+//
+// Example:
+//
+//   auto atlas = create_texture_atlas({1024, 1024}, Format_r_u8n);
+//   auto font = load_font(read_entire_file(u8"font.ttf"s), atlas);
+//   auto batch = create_text_batch(state);
+//   add_text(state, batch, font, u8"Hello"s, {10, 100}, {.size = 24});
+//   flush(state, batch, atlas, window_size);
+
+struct FontParams {
+	// Height of the em square the distance fields are rasterized at.
+	f32 pixel_height = 32;
+
+	// Distance in texels covered by the field on each side of the edge.
+	u32 spread = 4;
+};
+
+struct FontGlyph {
+	AtlasRegion region;
+	v2f offset;  // bottom left corner of the bitmap relative to the pen, in pixels at FontParams::pixel_height
+	f32 advance;
+	s32 index;   // glyph index in the font file
+	bool has_bitmap;
+};
+
+struct Font {
+	List<u8> file;
+	stbtt_fontinfo info;
+	TextureAtlas *atlas;
+	FontParams params;
+	f32 scale; // font units to pixels at `params.pixel_height`
+
+	// In pixels at `params.pixel_height`.
+	f32 ascent;
+	f32 descent;
+	f32 line_gap;
+
+	List<FontGlyph> glyphs;
+	HashMap<u32, u32> glyph_lookup; // codepoint to index into `glyphs` plus one
+};
+
+// Copies `file`, which is a TrueType or OpenType font. `atlas` must be of Format_r_u8n and outlive the font.
+// Returns a font with an empty `file` on failure.
+TGRAPHICS_API Font load_font(Span<u8> file, TextureAtlas &atlas, FontParams params = {});
+TGRAPHICS_API void free(Font &font);
+
+// Rasterizes the glyph on first use.
+TGRAPHICS_API FontGlyph &get_glyph(State *state, Font &font, u32 codepoint);
+
+struct TextParams {
+	f32 size = 16;               // em height in pixels
+	u32 color = 0xffffffff;
+	f32 line_spacing = 1;        // multiplies the font's line height
+	f32 max_width = 0;           // lines are wrapped at spaces to fit, 0 disables wrapping
+	u16 layer = 0;
+};
+
+// Lays out `string` and adds its glyphs to `batch`. `position` is the left end of the first baseline.
+// Returns the size of the laid out text.
+TGRAPHICS_API v2f add_text(State *state, SpriteBatch &batch, Font &font, Span<utf8> string, v2f position, TextParams const &params = {});
+
+// Sprite batch that draws glyphs of Format_r_u8n atlases as distance fields.
+TGRAPHICS_API SpriteBatch create_text_batch(State *state);
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_assert assert
+#include <stb_truetype.h>
+
+namespace tgraphics {
+
+namespace text {
+
+// Coverage is derived from the screen space rate of change of the distance, so edges stay one pixel wide at any size.
+inline Span<utf8> const fragment_shader_source = u8R"(
+#ifdef FRAGMENT_SHADER
+layout(binding = 0) uniform sampler2D atlas;
+
+in vec2 vertex_uv;
+in vec4 vertex_color;
+
+out vec4 fragment_color;
+
+void main() {
+	float distance = texture(atlas, vertex_uv).r;
+	float width = max(fwidth(distance), 1e-4);
+	fragment_color = vec4(vertex_color.rgb, vertex_color.a * smoothstep(0.5 - width, 0.5 + width, distance));
+}
+#endif
+)"s;
+
+// Value of the distance field on the edge of a glyph.
+inline constexpr u8 edge_value = 128;
+
+// Decodes one codepoint and advances `c`. Invalid sequences decode as U+FFFD.
+inline u32 decode_utf8(utf8 const *&c, utf8 const *end) {
+	u32 first = *c++;
+	if (first < 0x80)
+		return first;
+
+	u32 length = first >= 0xf0 ? 3 : first >= 0xe0 ? 2 : first >= 0xc0 ? 1 : 0;
+	if (!length || (umm)(end - c) < length)
+		return 0xfffd;
+
+	u32 result = first & (0x3f >> length);
+	for (u32 i = 0; i < length; ++i) {
+		if ((*c & 0xc0) != 0x80)
+			return 0xfffd;
+		result = (result << 6) | (*c++ & 0x3f);
+	}
+	return result;
+}
+
+}
+
+Font load_font(Span<u8> file, TextureAtlas &atlas, FontParams params) {
+	assert(atlas.format == Format_r_u8n, "load_font: atlas must be of Format_r_u8n");
+
+	Font result = {};
+	result.file.resize(file.count);
+	memcpy(result.file.data, file.data, file.count);
+
+	auto offset = stbtt_GetFontOffsetForIndex(result.file.data, 0);
+	if (offset < 0 || !stbtt_InitFont(&result.info, result.file.data, offset)) {
+		print(Print_error, "load_font: failed to parse font file\n");
+		free(result.file);
+		return {};
+	}
+
+	result.atlas = &atlas;
+	result.params = params;
+	result.scale = stbtt_ScaleForMappingEmToPixels(&result.info, params.pixel_height);
+
+	int ascent, descent, line_gap;
+	stbtt_GetFontVMetrics(&result.info, &ascent, &descent, &line_gap);
+	result.ascent   = ascent   * result.scale;
+	result.descent  = descent  * result.scale;
+	result.line_gap = line_gap * result.scale;
+	return result;
+}
+
+void free(Font &font) {
+	free(font.file);
+	free(font.glyphs);
+	free(font.glyph_lookup);
+}
+
+FontGlyph &get_glyph(State *state, Font &font, u32 codepoint) {
+	auto &lookup = font.glyph_lookup.get_or_insert(codepoint);
+	if (lookup)
+		return font.glyphs[lookup - 1];
+
+	FontGlyph glyph = {};
+	glyph.index = stbtt_FindGlyphIndex(&font.info, codepoint);
+
+	int advance, left_bearing;
+	stbtt_GetGlyphHMetrics(&font.info, glyph.index, &advance, &left_bearing);
+	glyph.advance = advance * font.scale;
+
+	int width, height, x_offset, y_offset;
+	auto spread = font.params.spread;
+	auto bitmap = stbtt_GetGlyphSDF(&font.info, font.scale, glyph.index, spread, text::edge_value, (f32)text::edge_value / spread, &width, &height, &x_offset, &y_offset);
+	if (bitmap) {
+		// stb_truetype's offsets are to the top left corner with y going down.
+		glyph.offset = {(f32)x_offset, -(f32)(y_offset + height)};
+		glyph.has_bitmap = insert_image(state, *font.atlas, {(u32)width, (u32)height}, bitmap, &glyph.region);
+		stbtt_FreeSDF(bitmap, 0);
+	}
+
+	font.glyphs.add(glyph);
+	lookup = (u32)font.glyphs.count;
+	return font.glyphs[font.glyphs.count - 1];
+}
+
+v2f add_text(State *state, SpriteBatch &batch, Font &font, Span<utf8> string, v2f position, TextParams const &params) {
+	auto scale = params.size / font.params.pixel_height;
+	auto line_height = (font.ascent - font.descent + font.line_gap) * scale * params.line_spacing;
+
+	v2f pen = position;
+	f32 width = 0;
+	u32 line_count = 1;
+
+	// Sprites of the current word, moved to the next line when the word does not fit.
+	umm word_first_sprite = batch.sprites.count;
+	f32 word_start_x = pen.x;
+
+	s32 previous_index = 0;
+
+	utf8 const *end = string.data + string.count;
+	for (utf8 const *c = string.data; c < end;) {
+		auto codepoint = text::decode_utf8(c, end);
+
+		if (codepoint == '\n') {
+			width = max(width, pen.x - position.x);
+			pen.x = position.x;
+			pen.y -= line_height;
+			++line_count;
+			previous_index = 0;
+			word_first_sprite = batch.sprites.count;
+			word_start_x = pen.x;
+			continue;
+		}
+
+		auto &glyph = get_glyph(state, font, codepoint);
+
+		if (previous_index) {
+			pen.x += stbtt_GetGlyphKernAdvance(&font.info, previous_index, glyph.index) * font.scale * scale;
+		}
+		previous_index = glyph.index;
+
+		if (codepoint == ' ') {
+			pen.x += glyph.advance * scale;
+			word_first_sprite = batch.sprites.count;
+			word_start_x = pen.x;
+			continue;
+		}
+
+		auto glyph_end = pen.x + (glyph.offset.x + glyph.region.size.x) * scale;
+		if (params.max_width > 0 && glyph_end - position.x > params.max_width && word_start_x > position.x) {
+			// Wrap the whole word.
+			auto shift = word_start_x - position.x;
+			width = max(width, word_start_x - position.x);
+			for (umm i = word_first_sprite; i < batch.sprites.count; ++i) {
+				batch.sprites[i].rect.x -= shift;
+				batch.sprites[i].rect.y -= line_height;
+			}
+			pen.x -= shift;
+			pen.y -= line_height;
+			++line_count;
+			word_start_x = position.x;
+		}
+
+		if (glyph.has_bitmap) {
+			add_sprite(batch, {
+				.position = pen + glyph.offset * scale,
+				.size = {glyph.region.size.x * scale, glyph.region.size.y * scale},
+				.region = glyph.region,
+				.color = params.color,
+				.layer = params.layer,
+			});
+		}
+		pen.x += glyph.advance * scale;
+	}
+
+	width = max(width, pen.x - position.x);
+	return {width, line_count * line_height};
+}
+
+SpriteBatch create_text_batch(State *state) {
+	return create_sprite_batch(state, text::fragment_shader_source);
+}
+
+}
+
+#endif
@@ -30,17 +30,37 @@ struct InitInfo {
 	NativeWindowHandle window = {};
 	bool debug = false;
 	bool check_apis = true;
+
+	// Creates a context shared with the main one on a dedicated thread, so that texture creation, updates
+	// and mipmap generation, `load_texture_*`, `create_vertex_buffer` and `create_shader` can be called from any thread.
+	// Resources created that way can be passed to the render thread as soon as the call returns.
+	// A texture must not be used by the render thread while another thread updates it.
+	// Other threads can not change a texture's size, only the render thread can resize or update it with a new size.
+	bool upload_thread = false;
+
+	// Creates an offscreen context instead of using `window`, which may be null.
+	// Only RenderTargets can be drawn to: the back buffer has no size, present does not show anything
+	// and set_vsync does nothing. Every headless state has its own context, current on the thread
+	// that called `init`, so independent states can render concurrently on separate threads.
+	// Contexts are created with WGL on hidden windows, so like the rest of the OpenGL backend this is Windows only.
+	bool headless = false;
 };
 
 struct Texture2D : TGRAPHICS_TEXTURE_2D_EXTENSION {
 	v2u size;
 };
+
+inline constexpr u32 max_color_attachments = 8;
+
 struct RenderTarget {
-	Texture2D *color;
+	Texture2D *color; // same as colors[0]
 	Texture2D *depth;
+	Texture2D *colors[max_color_attachments];
+	u32 color_count;
 };
 struct Shader {};
 struct VertexBuffer {};
+struct VertexLayout {};
 struct IndexBuffer {};
 
 
@@ -54,22 +74,105 @@ struct TypedShaderConstants {
 
 struct ComputeShader {};
 struct ComputeBuffer {};
+struct Readback {};
+
+template <class T>
+struct TypedComputeBuffer {
+	ComputeBuffer *buffer;
+	u32 count;
+};
+
+// Makes writes done by compute shaders visible to the listed kinds of later reads.
+using Barrier = u16;
+enum : Barrier {
+	Barrier_vertex_buffer    = 0x1,
+	Barrier_index_buffer     = 0x2,
+	Barrier_shader_constants = 0x4,
+	Barrier_texture_fetch    = 0x8,
+	Barrier_compute_texture  = 0x10,
+	Barrier_indirect_command = 0x20,
+	Barrier_buffer_transfer  = 0x40, // read_compute_buffer, update_compute_buffer and mapping
+	Barrier_texture_transfer = 0x80, // read_texture_2d and update_texture_2d
+	Barrier_render_target    = 0x100,
+	Barrier_compute_buffer   = 0x200,
+	Barrier_all              = 0x3ff,
+};
 
 struct CameraMatrices {
 	m4 mvp;
 };
 
+// Signaled when the GPU finished every command issued before `insert_fence`.
+// Fences are ordered, a fence is signaled only after all earlier ones are. Zero is always signaled.
+struct Fence {
+	u64 value;
+};
+
+// Frame pacing:
+//   set_frame_pacing(n, false) makes present wait until at most n - 1 presented frames are unfinished on the GPU.
+//   set_frame_pacing(n, true) moves that wait to begin_frame, which should be called right before input is sampled.
+// Zero frames means no limit, which is the default.
+inline constexpr u32 max_frames_in_flight_limit = 8;
+
+// GPU times are of the last frame whose timestamps are available, usually a few frames ago.
+struct FrameTimings {
+	f32 cpu_wait_ms;  // time present and begin_frame blocked during the last frame to respect the frame pacing
+	f32 gpu_idle_ms;  // time the GPU had nothing to do between the previous frame and `begin_frame`
+	f32 gpu_frame_ms; // time between the ends of the previous and this frame on the GPU
+};
+
+// Suffix n means the integers are normalized and read as floats in the shader:
+// unsigned to [0, 1], signed to [-1, 1].
+// Integer types without the suffix are read as integers (uint/int, uvec/ivec).
 enum ElementType : u8 {
 	Element_f32x1,
 	Element_f32x2,
 	Element_f32x3,
 	Element_f32x4,
+
+	Element_f16x2,
+	Element_f16x4,
+
+	Element_u8x4n,
+	Element_s8x4n,
+	Element_u16x2n,
+	Element_s16x2n,
+	Element_u16x4n,
+	Element_s16x4n,
+	Element_u10x3_u2n, // x, y, z in 10 bits each, w in 2 bits
+	Element_s10x3_s2n,
+
+	Element_u8x4,
+	Element_u16x2,
+	Element_u16x4,
+	Element_u32x1,
+	Element_u32x2,
+	Element_u32x3,
+	Element_u32x4,
+	Element_s32x1,
+	Element_s32x2,
+	Element_s32x3,
+	Element_s32x4,
+};
+
+inline constexpr u32 max_vertex_streams  = 8;
+inline constexpr u32 max_vertex_elements = 16;
+
+// Elements of one vertex buffer binding.
+// Attribute locations are assigned in order, continuing from the previous stream.
+struct VertexStream {
+	Span<ElementType> elements;
+
+	// 0 means the stream advances every vertex, n means it advances every n instances.
+	u32 step_rate = 0;
 };
 
 enum Format : u8 {
 	Format_null,
 	Format_depth,
 	Format_r_f32,
+	Format_rg_f32,
+	Format_r_u8n,
 	Format_rgb_u8n,
 	Format_rgb_f16,
 	Format_rgb_f32,
@@ -128,6 +231,20 @@ enum Topology {
 
 struct TextureCube : TGRAPHICS_TEXTURE_CUBE_EXTENSION {
 };
+
+// Layers of the same size and format behind one binding.
+// Sampled in GLSL as `sampler2DArray` with `texture(s, vec3(uv, layer))`, so draws with different
+// materials can share a binding and select the layer from a constant or a vertex attribute.
+struct Texture2DArray {
+	v2u size;
+	u32 layer_count;
+};
+
+// Sampled in GLSL as `samplerCubeArray` with `texture(s, vec4(direction, layer))`.
+struct TextureCubeArray {
+	u32 size;
+	u32 layer_count;
+};
 union TextureCubePaths {
 	struct {
 		Span<utf8> left;
@@ -188,9 +305,29 @@ inline Pixels load_pixels(Span<utf8> path, LoadPixelsParams params = {}) {
 	return load_pixels(file, params);
 }
 
+struct Capture;
+
+inline constexpr u32 frame_arena_count = 3;
+
+// Linear allocator for memory that is needed only for a few frames.
+struct FrameArena {
+	u8 *data;
+	umm size;
+	umm used;
+
+	// Blocks allocated after `data` filled up, linked through their first bytes.
+	// On reset they are freed and `data` grows to fit everything, so a steady workload stops allocating.
+	void *overflow;
+	umm overflow_size;
+};
+
 struct State {
 	Allocator allocator;
 
+	// One arena per frame. present resets the arena that is used next.
+	FrameArena frame_arenas[frame_arena_count] = {};
+	u32 frame_arena_index = 0;
+
 	GraphicsApi api;
 
 	RenderTarget *back_buffer;
@@ -200,9 +337,39 @@ struct State {
 
 	u32 draw_call_count = 0;
 
+	// Set while calls are recorded into a trace, see capture.h.
+	Capture *capture = 0;
+
 	#include "generated/definition.h"
 
+	// Uninitialized memory that stays valid until the `frame_arena_count`-th present after this call.
+	// Only for the render thread.
+	void *frame_alloc(umm size, umm alignment);
+	template <class T>
+	T *frame_alloc(umm count) {
+		return (T *)frame_alloc(count * sizeof(T), alignof(T));
+	}
+	void next_frame_arena();
+	void free_frame_arenas();
+
 	void draw(u32 vertex_count) { return draw(vertex_count, 0); }
+	void draw_instanced(u32 vertex_count, u32 instance_count) { return draw_instanced(vertex_count, instance_count, 0, 0); }
+	void draw_indexed(u32 index_count) { return draw_indexed(index_count, 0, 0); }
+
+	template <class Index>
+	IndexBuffer *create_index_buffer(Span<Index> indices) {
+		static_assert(sizeof(Index) == 1 || sizeof(Index) == 2 || sizeof(Index) == 4);
+		return create_index_buffer(as_bytes(indices), sizeof(Index));
+	}
+	template <class Index>
+	void update_index_buffer(IndexBuffer *buffer, Span<Index> indices, u32 first_index) {
+		return update_index_buffer(buffer, as_bytes(indices), first_index);
+	}
+
+	VertexLayout *create_vertex_layout(Span<ElementType> elements) {
+		VertexStream stream = {.elements = elements};
+		return create_vertex_layout(Span(&stream, 1));
+	}
 
 	void set_viewport(u32 w, u32 h) { return set_viewport(0, 0, w, h); }
 	void set_viewport(v2u size) { return set_viewport(0, 0, size.x, size.y); }
@@ -224,6 +391,17 @@ struct State {
 	void set_texture(TextureCube *texture, u32 slot) {
 		return set_texture_cube(texture, slot);
 	}
+	void set_texture(Texture2DArray *texture, u32 slot) {
+		return set_texture_2d_array(texture, slot);
+	}
+	void set_texture(TextureCubeArray *texture, u32 slot) {
+		return set_texture_cube_array(texture, slot);
+	}
+
+	// Allocates the full mip chain.
+	Texture2DArray *create_texture_2d_array(v2u size, u32 layer_count, Format format) {
+		return create_texture_2d_array(size.x, size.y, layer_count, ~0u, format);
+	}
 
 	void update_texture(Texture2D *texture, v2u size, void *data) {
 		return update_texture_2d(texture, size.x, size.y, data);
@@ -240,6 +418,12 @@ struct State {
 	void generate_mipmaps(TextureCube *texture) {
 		return generate_mipmaps_cube(texture, {});
 	}
+	void generate_mipmaps(Texture2DArray *texture) {
+		return generate_mipmaps_2d_array(texture);
+	}
+	void generate_mipmaps(TextureCubeArray *texture) {
+		return generate_mipmaps_cube_array(texture);
+	}
 
 	Texture2D *load_texture_2d(Span<u8> data, LoadTextureParams params = {}) {
 		auto pixels = load_pixels(data, {.flip_y = params.flip_y});
@@ -247,12 +431,15 @@ struct State {
 			return 0;
 		defer { pixels.free(pixels.data); };
 
-		auto result = create_texture_2d(pixels.size.x, pixels.size.y, pixels.data, pixels.format);
-
-		if (params.generate_mipmaps)
+		// Texture storage is immutable, so the mip chain has to be allocated up front.
+		if (params.generate_mipmaps) {
+			auto result = create_texture_2d_mipmapped(pixels.size, ~0u, pixels.format);
+			update_texture_2d(result, pixels.size.x, pixels.size.y, pixels.data);
 			generate_mipmaps_2d(result);
+			return result;
+		}
 
-		return result;
+		return create_texture_2d(pixels.size.x, pixels.size.y, pixels.data, pixels.format);
 	}
 	Texture2D *load_texture_2d(Span<utf8> path, LoadTextureParams params = {}) {
 		auto file = read_entire_file(path);
@@ -317,10 +504,47 @@ struct State {
 	}
 
 	void resize_texture_2d(Texture2D *texture, v2u size) { return resize_texture_2d(texture, size.x, size.y); }
+	Texture2D *create_texture_2d_mipmapped(v2u size, u32 mip_count, Format format) { return create_texture_2d_mipmapped(size.x, size.y, mip_count, format); }
+
+	RenderTarget *create_render_target(Span<Texture2D *> colors, Texture2D *depth) {
+		return create_render_target_with_attachments(colors, depth);
+	}
 	void resize_texture(Texture2D *texture, v2u size) { return resize_texture_2d(texture, size.x, size.y); }
 
 	void set_sampler(Filtering filtering, u32 slot) { return set_sampler(filtering, {}, slot); }
 
+	template <class T>
+	void update_compute_buffer(ComputeBuffer *buffer, Span<T> data, u32 offset) {
+		return update_compute_buffer(buffer, data.data, offset, (u32)(data.count * sizeof(T)));
+	}
+
+	template <class T>
+	TypedComputeBuffer<T> create_compute_buffer(u32 count) {
+		TypedComputeBuffer<T> result = {
+			.buffer = create_compute_buffer(count * (u32)sizeof(T)),
+			.count = count,
+		};
+		return result;
+	}
+
+	template <class T>
+	void update_compute_buffer(TypedComputeBuffer<T> &buffer, Span<T> data, u32 first) {
+		assert(first + data.count <= buffer.count);
+		return update_compute_buffer(buffer.buffer, data.data, first * (u32)sizeof(T), (u32)(data.count * sizeof(T)));
+	}
+
+	template <class T>
+	void read_compute_buffer(TypedComputeBuffer<T> const &buffer, T *data) {
+		return read_compute_buffer(buffer.buffer, data);
+	}
+
+	template <class T>
+	void set_compute_buffer(TypedComputeBuffer<T> const &buffer, u32 slot) {
+		return set_compute_buffer(buffer.buffer, slot);
+	}
+
+	void set_compute_texture(Texture2D *texture, u32 slot) { return set_compute_texture(texture, slot, 0, Access_read); }
+
 	template <class T>
 	TypedShaderConstants<T> create_shader_constants() {
 		TypedShaderConstants<T> result = {
@@ -409,7 +633,36 @@ template <>
 tl::umm get_hash(tl::Span<tgraphics::ElementType> types) {
 	tl::umm hash = 0x13579BDF2468ACE;
 	for (auto &type : types) {
-		hash = tl::rotate_left(hash, 1) | type;
+		hash = tl::rotate_left(hash, 1) ^ type;
+	}
+	return hash;
+}
+
+namespace tgraphics {
+
+struct VertexLayoutKey {
+	ElementType elements[max_vertex_elements];
+	u8 element_streams[max_vertex_elements];
+	u32 step_rates[max_vertex_streams];
+	u32 element_count;
+	u32 stream_count;
+
+	// Keys are memset to zero before filling, so padding and unused entries compare equal.
+	bool operator==(VertexLayoutKey const &that) const {
+		return memcmp(this, &that, sizeof(*this)) == 0;
+	}
+};
+
+}
+
+template <>
+tl::umm get_hash(tgraphics::VertexLayoutKey key) {
+	auto hash = get_hash(tl::Span(key.elements, key.element_count));
+	for (tl::u32 stream_index = 0; stream_index < key.stream_count; ++stream_index) {
+		hash = tl::rotate_left(hash, 3) ^ key.step_rates[stream_index];
+	}
+	for (tl::u32 element_index = 0; element_index < key.element_count; ++element_index) {
+		hash = tl::rotate_left(hash, 1) ^ key.element_streams[element_index];
 	}
 	return hash;
 }
@@ -424,6 +677,64 @@ tl::umm get_hash(tl::Span<tgraphics::ElementType> types) {
 
 namespace tgraphics {
 
+// Overflow blocks are allocated in these so they are aligned for any frame_alloc.
+struct alignas(16) FrameArenaChunk {
+	u8 bytes[16];
+};
+
+void *State::frame_alloc(umm size, umm alignment) {
+	assert(alignment && alignment <= alignof(FrameArenaChunk) && (alignment & (alignment - 1)) == 0);
+
+	auto &arena = frame_arenas[frame_arena_index];
+	umm offset = (arena.used + alignment - 1) & ~(alignment - 1);
+	if (offset + size <= arena.size) {
+		arena.used = offset + size;
+		return arena.data + offset;
+	}
+
+	auto chunk_count = (size + sizeof(FrameArenaChunk) - 1) / sizeof(FrameArenaChunk) + 1;
+	auto block = (u8 *)allocator.allocate<FrameArenaChunk>(chunk_count);
+	*(void **)block = arena.overflow;
+	arena.overflow = block;
+	arena.overflow_size += chunk_count * sizeof(FrameArenaChunk);
+	return block + sizeof(FrameArenaChunk);
+}
+
+void State::next_frame_arena() {
+	frame_arena_index = (frame_arena_index + 1) % frame_arena_count;
+
+	auto &arena = frame_arenas[frame_arena_index];
+	arena.used = 0;
+	if (!arena.overflow)
+		return;
+
+	while (arena.overflow) {
+		auto next = *(void **)arena.overflow;
+		allocator.free(arena.overflow);
+		arena.overflow = next;
+	}
+
+	auto size = arena.size + arena.overflow_size;
+	arena.overflow_size = 0;
+	if (arena.data)
+		allocator.free(arena.data);
+	arena.data = (u8 *)allocator.allocate<FrameArenaChunk>((size + sizeof(FrameArenaChunk) - 1) / sizeof(FrameArenaChunk));
+	arena.size = size;
+}
+
+void State::free_frame_arenas() {
+	for (auto &arena : frame_arenas) {
+		while (arena.overflow) {
+			auto next = *(void **)arena.overflow;
+			allocator.free(arena.overflow);
+			arena.overflow = next;
+		}
+		if (arena.data)
+			allocator.free(arena.data);
+		arena = {};
+	}
+}
+
 namespace d3d11 { State *init(InitInfo init_info); void deinit(State *); }
 namespace gl    { State *init(InitInfo init_info); void deinit(State *); }
 
@@ -434,7 +745,7 @@ static bool check_api(State *state) {
 }
 
 State *init(GraphicsApi api, InitInfo init_info) {
-	if (!init_info.window) {
+	if (!init_info.window && !init_info.headless) {
 		print(Print_error, "init_info.window is null\n");
 		return 0;
 	}
@@ -446,6 +757,9 @@ State *init(GraphicsApi api, InitInfo init_info) {
 		case GraphicsApi_opengl: result =    gl::init(init_info); break;
 	}
 
+	if (!result)
+		return 0;
+
 	result->api = api;
 
 	if (init_info.check_apis)
@@ -456,6 +770,8 @@ State *init(GraphicsApi api, InitInfo init_info) {
 }
 
 void deinit(State *state) {
+	state->free_frame_arenas();
+
 	switch (state->api) {
 		//case GraphicsApi_d3d11:  return d3d11::deinit(state);
 		case GraphicsApi_opengl: return    gl::deinit(state);
@@ -495,6 +811,7 @@ using namespace tl::gl;
 
 struct ShaderImpl : Shader {
 	GLuint program;
+	GLsync upload_fence = 0; // set while an upload on the upload thread is not published
 };
 
 struct ShaderConstantsImpl : ShaderConstants {
@@ -502,31 +819,89 @@ struct ShaderConstantsImpl : ShaderConstants {
 	u32 values_size;
 };
 
+// Vertex array object that holds only attribute formats.
+// Buffers are attached to its binding points on use, so everything with the same layout shares it.
+struct VertexLayoutImpl : VertexLayout {
+	GLuint array;
+	GLuint element_buffer; // index buffer currently attached to `array`
+	u32 stream_count;
+	u32 strides[max_vertex_streams];
+};
+
 struct VertexBufferImpl : VertexBuffer {
 	GLuint buffer;
-	GLuint array;
+	umm size;
+	VertexLayoutImpl *layout; // layout of the descriptor it was created with, may be null
+	GLsync upload_fence = 0;
+
+	// Vertex arrays are not shared between contexts, so buffers created on the upload thread
+	// get their layout when they are published.
+	ElementType pending_descriptor[max_vertex_elements];
+	u32 pending_descriptor_count = 0;
+};
+
+struct UploadJob {
+	void (*function)(void *param);
+	void *param;
+	bool done;
+};
+
+struct PendingUpload {
+	GLsync *fence;
+	VertexBufferImpl *vertex_buffer; // or null
+};
+
+inline constexpr u32 max_pending_uploads = 1024;
+
+// Older fences are waited for when a new one would overwrite them.
+inline constexpr u32 max_fences_in_flight = 64;
+
+struct FrameQueries {
+	GLuint begin;
+	GLuint end;
 };
 
 struct IndexBufferImpl : IndexBuffer {
 	GLuint buffer;
 	GLuint type;
 	u32 count;
+	u32 index_size;        // size of an index on the gpu
+	u32 source_index_size; // size of an index passed to create and update
 };
 
 struct Texture {
-	GLuint texture;
+	GLuint texture; // or a renderbuffer if target is GL_RENDERBUFFER
 	GLuint format;
 	GLuint internal_format;
 	GLuint type;
 	GLuint target;
 	u32 bytes_per_texel;
+	u32 sample_count;
+	u32 mip_count; // requested levels, clamped to the full chain of the current size
+	GLsync upload_fence = 0;
 };
 
 struct Texture2DImpl : Texture2D, Texture {};
 struct TextureCubeImpl : TextureCube, Texture {};
+struct Texture2DArrayImpl : Texture2DArray, Texture {};
+struct TextureCubeArrayImpl : TextureCubeArray, Texture {};
+
+// Texture and image units whose 2d texture bindings are tracked, so they can be restored after a resize.
+inline constexpr u32 max_tracked_texture_units = 32;
+inline constexpr u32 max_tracked_image_units = 8;
+
+struct ImageBinding {
+	Texture2DImpl *texture;
+	u32 mip;
+	Access access;
+};
 
 struct RenderTargetImpl : RenderTarget {
 	GLuint frame_buffer;
+
+	// Non-zero for targets created with create_window_render_target.
+	f32 window_scale = 0;
+	u32 window_size_version = 0;
 };
 
 struct ComputeShaderImpl : ComputeShader {
@@ -536,13 +911,39 @@ struct ComputeBufferImpl : ComputeBuffer {
 	GLuint buffer;
 	u32 size;
 };
+struct ReadbackImpl : Readback {
+	GLuint buffer;
+	u32 size;
+	GLsync fence; // null when no copy is in flight
+};
 
 u32 get_element_scalar_count(ElementType element) {
 	switch (element) {
-		case Element_f32x1: return 1;
-		case Element_f32x2:	return 2;
-		case Element_f32x3:	return 3;
-		case Element_f32x4:	return 4;
+		case Element_f32x1:     return 1;
+		case Element_f32x2:     return 2;
+		case Element_f32x3:     return 3;
+		case Element_f32x4:     return 4;
+		case Element_f16x2:     return 2;
+		case Element_f16x4:     return 4;
+		case Element_u8x4n:     return 4;
+		case Element_s8x4n:     return 4;
+		case Element_u16x2n:    return 2;
+		case Element_s16x2n:    return 2;
+		case Element_u16x4n:    return 4;
+		case Element_s16x4n:    return 4;
+		case Element_u10x3_u2n: return 4;
+		case Element_s10x3_s2n: return 4;
+		case Element_u8x4:      return 4;
+		case Element_u16x2:     return 2;
+		case Element_u16x4:     return 4;
+		case Element_u32x1:     return 1;
+		case Element_u32x2:     return 2;
+		case Element_u32x3:     return 3;
+		case Element_u32x4:     return 4;
+		case Element_s32x1:     return 1;
+		case Element_s32x2:     return 2;
+		case Element_s32x3:     return 3;
+		case Element_s32x4:     return 4;
 	}
 	invalid_code_path();
 	return 0;
@@ -550,10 +951,31 @@ u32 get_element_scalar_count(ElementType element) {
 
 u32 get_element_size(ElementType element) {
 	switch (element) {
-		case Element_f32x1: return 4;
-		case Element_f32x2:	return 8;
-		case Element_f32x3:	return 12;
-		case Element_f32x4:	return 16;
+		case Element_f32x1:     return 4;
+		case Element_f32x2:     return 8;
+		case Element_f32x3:     return 12;
+		case Element_f32x4:     return 16;
+		case Element_f16x2:     return 4;
+		case Element_f16x4:     return 8;
+		case Element_u8x4n:     return 4;
+		case Element_s8x4n:     return 4;
+		case Element_u16x2n:    return 4;
+		case Element_s16x2n:    return 4;
+		case Element_u16x4n:    return 8;
+		case Element_s16x4n:    return 8;
+		case Element_u10x3_u2n: return 4;
+		case Element_s10x3_s2n: return 4;
+		case Element_u8x4:      return 4;
+		case Element_u16x2:     return 4;
+		case Element_u16x4:     return 8;
+		case Element_u32x1:     return 4;
+		case Element_u32x2:     return 8;
+		case Element_u32x3:     return 12;
+		case Element_u32x4:     return 16;
+		case Element_s32x1:     return 4;
+		case Element_s32x2:     return 8;
+		case Element_s32x3:     return 12;
+		case Element_s32x4:     return 16;
 	}
 	invalid_code_path();
 	return 0;
@@ -561,15 +983,70 @@ u32 get_element_size(ElementType element) {
 
 u32 get_element_type(ElementType element) {
 	switch (element) {
-		case Element_f32x1: return GL_FLOAT;
-		case Element_f32x2:	return GL_FLOAT;
-		case Element_f32x3:	return GL_FLOAT;
-		case Element_f32x4:	return GL_FLOAT;
+		case Element_f32x1:     return GL_FLOAT;
+		case Element_f32x2:     return GL_FLOAT;
+		case Element_f32x3:     return GL_FLOAT;
+		case Element_f32x4:     return GL_FLOAT;
+		case Element_f16x2:     return GL_HALF_FLOAT;
+		case Element_f16x4:     return GL_HALF_FLOAT;
+		case Element_u8x4n:     return GL_UNSIGNED_BYTE;
+		case Element_s8x4n:     return GL_BYTE;
+		case Element_u16x2n:    return GL_UNSIGNED_SHORT;
+		case Element_s16x2n:    return GL_SHORT;
+		case Element_u16x4n:    return GL_UNSIGNED_SHORT;
+		case Element_s16x4n:    return GL_SHORT;
+		case Element_u10x3_u2n: return GL_UNSIGNED_INT_2_10_10_10_REV;
+		case Element_s10x3_s2n: return GL_INT_2_10_10_10_REV;
+		case Element_u8x4:      return GL_UNSIGNED_BYTE;
+		case Element_u16x2:     return GL_UNSIGNED_SHORT;
+		case Element_u16x4:     return GL_UNSIGNED_SHORT;
+		case Element_u32x1:     return GL_UNSIGNED_INT;
+		case Element_u32x2:     return GL_UNSIGNED_INT;
+		case Element_u32x3:     return GL_UNSIGNED_INT;
+		case Element_u32x4:     return GL_UNSIGNED_INT;
+		case Element_s32x1:     return GL_INT;
+		case Element_s32x2:     return GL_INT;
+		case Element_s32x3:     return GL_INT;
+		case Element_s32x4:     return GL_INT;
 	}
 	invalid_code_path();
 	return 0;
 }
 
+bool is_element_normalized(ElementType element) {
+	switch (element) {
+		case Element_u8x4n:
+		case Element_s8x4n:
+		case Element_u16x2n:
+		case Element_s16x2n:
+		case Element_u16x4n:
+		case Element_s16x4n:
+		case Element_u10x3_u2n:
+		case Element_s10x3_s2n:
+			return true;
+	}
+	return false;
+}
+
+// Integer elements have to be specified with glVertexAttribIPointer, otherwise they are converted to floats.
+bool is_element_integer(ElementType element) {
+	switch (element) {
+		case Element_u8x4:
+		case Element_u16x2:
+		case Element_u16x4:
+		case Element_u32x1:
+		case Element_u32x2:
+		case Element_u32x3:
+		case Element_u32x4:
+		case Element_s32x1:
+		case Element_s32x2:
+		case Element_s32x3:
+		case Element_s32x4:
+			return true;
+	}
+	return false;
+}
+
 u32 get_index_type_from_size(u32 size) {
 	switch (size) {
 		case 2: return GL_UNSIGNED_SHORT;
@@ -579,6 +1056,46 @@ u32 get_index_type_from_size(u32 size) {
 	return 0;
 }
 
+u32 read_index(void const *indices, u32 index_size, umm index) {
+	switch (index_size) {
+		case 1: return ((u8  const *)indices)[index];
+		case 2: return ((u16 const *)indices)[index];
+		case 4: return ((u32 const *)indices)[index];
+	}
+	invalid_code_path();
+	return 0;
+}
+
+// 8 bit indices are widened: many gpus do not fetch them natively and d3d does not support them at all.
+// 32 bit indices are narrowed when all of them fit, which halves index bandwidth.
+// update_index_buffer widens the buffer again when it is given an index that does not fit.
+u32 select_index_size(Span<u8> indices, u32 source_index_size) {
+	switch (source_index_size) {
+		case 1: return 2;
+		case 2: return 2;
+		case 4: {
+			auto values = (u32 const *)indices.data;
+			auto count = indices.count / 4;
+			u32 max_index = 0;
+			for (umm i = 0; i < count; ++i) {
+				max_index = max(max_index, values[i]);
+			}
+			return max_index <= 0xffff ? 2 : 4;
+		}
+	}
+	invalid_code_path();
+	return 0;
+}
+
+// Converts `count` indices of `source_index_size` bytes into 16 bit ones.
+void narrow_indices(void const *source, u32 source_index_size, umm count, u16 *destination) {
+	for (umm i = 0; i < count; ++i) {
+		auto index = read_index(source, source_index_size, i);
+		assert(index <= 0xffff, "index does not fit in a 16 bit index buffer");
+		destination[i] = (u16)index;
+	}
+}
+
 GLuint get_min_filter(Filtering filter) {
 	switch (filter) {
 		case Filtering_nearest:        return GL_NEAREST;
@@ -608,10 +1125,22 @@ GLuint get_func(Comparison comparison) {
 	return 0;
 }
 
+// Three channel formats are not required to be renderable with multisampling, so they get an alpha channel.
+Format get_multisampled_format(Format format) {
+	switch (format) {
+		case Format_rgb_u8n: return Format_rgba_u8n;
+		case Format_rgb_f16: return Format_rgba_f16;
+		case Format_rgb_f32: return Format_rgba_f32;
+		default:             return format;
+	}
+}
+
 GLuint get_format(Format format) {
 	switch (format) {
 		case Format_depth:    return GL_DEPTH_COMPONENT;
 		case Format_r_f32:    return GL_RED;
+		case Format_rg_f32:   return GL_RG;
+		case Format_r_u8n:    return GL_RED;
 		case Format_rgb_u8n:  return GL_RGB;
 		case Format_rgb_f16:  return GL_RGB;
 		case Format_rgb_f32:  return GL_RGB;
@@ -627,6 +1156,8 @@ GLuint get_internal_format(Format format) {
 	switch (format) {
 		case Format_depth:    return GL_DEPTH_COMPONENT;
 		case Format_r_f32:    return GL_R32F;
+		case Format_rg_f32:   return GL_RG32F;
+		case Format_r_u8n:    return GL_R8;
 		case Format_rgb_u8n:  return GL_RGB8;
 		case Format_rgb_f16:  return GL_RGB16F;
 		case Format_rgb_f32:  return GL_RGB32F;
@@ -638,10 +1169,20 @@ GLuint get_internal_format(Format format) {
 	return 0;
 }
 
+// Multisampled storage requires sized formats.
+GLuint get_sized_internal_format(Format format) {
+	switch (format) {
+		case Format_depth: return GL_DEPTH_COMPONENT32F;
+	}
+	return get_internal_format(format);
+}
+
 GLuint get_type(Format format) {
 	switch (format) {
 		case Format_depth:    return GL_FLOAT;
 		case Format_r_f32:    return GL_FLOAT;
+		case Format_rg_f32:   return GL_FLOAT;
+		case Format_r_u8n:    return GL_UNSIGNED_BYTE;
 		case Format_rgb_u8n:  return GL_UNSIGNED_BYTE;
 		case Format_rgb_f16:  return GL_FLOAT;
 		case Format_rgb_f32:  return GL_FLOAT;
@@ -656,6 +1197,8 @@ u32 get_bytes_per_texel(Format format) {
 	switch (format) {
 		case Format_depth:    return 4;
 		case Format_r_f32:    return 4;
+		case Format_rg_f32:   return 8;
+		case Format_r_u8n:    return 1;
 		case Format_rgb_u8n:  return 3;
 		case Format_rgb_f16:  return 6;
 		case Format_rgb_f32:  return 12;
@@ -667,6 +1210,13 @@ u32 get_bytes_per_texel(Format format) {
 	return 0;
 }
 
+// Pixel data passed to and from the api is tightly packed, rows are not padded to 4 bytes.
+// Pixel store state is per context, so this is called for every context.
+void set_pixel_alignment() {
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+}
+
 GLuint get_blend(Blend blend) {
 	switch (blend) {
 		case Blend_one:                       return GL_ONE;
@@ -706,6 +1256,24 @@ GLuint get_access(Access access) {
 	return 0;
 }
 
+GLbitfield get_barriers(Barrier barriers) {
+	if (barriers == Barrier_all)
+		return GL_ALL_BARRIER_BITS;
+
+	GLbitfield result = 0;
+	if (barriers & Barrier_vertex_buffer)    result |= GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+	if (barriers & Barrier_index_buffer)     result |= GL_ELEMENT_ARRAY_BARRIER_BIT;
+	if (barriers & Barrier_shader_constants) result |= GL_UNIFORM_BARRIER_BIT;
+	if (barriers & Barrier_texture_fetch)    result |= GL_TEXTURE_FETCH_BARRIER_BIT;
+	if (barriers & Barrier_compute_texture)  result |= GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+	if (barriers & Barrier_indirect_command) result |= GL_COMMAND_BARRIER_BIT;
+	if (barriers & Barrier_buffer_transfer)  result |= GL_BUFFER_UPDATE_BARRIER_BIT | GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT;
+	if (barriers & Barrier_texture_transfer) result |= GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT;
+	if (barriers & Barrier_render_target)    result |= GL_FRAMEBUFFER_BARRIER_BIT;
+	if (barriers & Barrier_compute_buffer)   result |= GL_SHADER_STORAGE_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT;
+	return result;
+}
+
 GLenum get_cull(Cull cull) {
 	switch (cull) {
 		case Cull_back:	 return GL_BACK;
@@ -715,30 +1283,80 @@ GLenum get_cull(Cull cull) {
 	return 0;
 }
 
-void resize_texture_gl(Texture2D *_texture, u32 width, u32 height) {
+u32 get_full_mip_count(u32 width, u32 height) {
+	u32 result = 1;
+	while (max(width, height) >> result)
+		++result;
+	return result;
+}
+
+u32 get_allocated_mip_count(Texture2DImpl const &texture) {
+	return min(texture.mip_count, get_full_mip_count(texture.size.x, texture.size.y));
+}
+
+// Allocates storage of the given size. Texture storage is immutable, so textures get a new object
+// and attachments referring to the old one must be updated. Returns true if that happened.
+bool resize_texture_gl(Texture2D *_texture, u32 width, u32 height) {
 	auto &texture = *(Texture2DImpl *)_texture;
+	bool had_storage = texture.texture != 0;
 	texture.size = {width, height};
-	glBindTexture(texture.target, texture.texture);
-	glTexImage2D(texture.target, 0, texture.internal_format, width, height, 0, texture.format, texture.type, NULL);
-	glBindTexture(texture.target, 0);
+	switch (texture.target) {
+		case GL_TEXTURE_2D:
+			if (had_storage)
+				glDeleteTextures(1, &texture.texture);
+			glCreateTextures(GL_TEXTURE_2D, 1, &texture.texture);
+			glTextureStorage2D(texture.texture, get_allocated_mip_count(texture), texture.internal_format, width, height);
+			return had_storage;
+		case GL_TEXTURE_2D_MULTISAMPLE:
+			if (had_storage)
+				glDeleteTextures(1, &texture.texture);
+			glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &texture.texture);
+			glTextureStorage2DMultisample(texture.texture, texture.sample_count, texture.internal_format, width, height, GL_TRUE);
+			return had_storage;
+		case GL_RENDERBUFFER:
+			// Renderbuffer storage can be respecified in place.
+			if (!had_storage)
+				glCreateRenderbuffers(1, &texture.texture);
+			glNamedRenderbufferStorageMultisample(texture.texture, texture.sample_count, texture.internal_format, width, height);
+			return false;
+	}
+	invalid_code_path();
+	return false;
+}
+
+void attach_texture(GLuint frame_buffer, GLenum attachment, Texture2DImpl &texture) {
+	if (texture.target == GL_RENDERBUFFER) {
+		glNamedFramebufferRenderbuffer(frame_buffer, attachment, GL_RENDERBUFFER, texture.texture);
+	} else {
+		glNamedFramebufferTexture(frame_buffer, attachment, texture.texture, 0);
+	}
 }
 
 struct StateGL : State {
 	StaticMaskedBlockList<ShaderImpl, 256> shaders;
 	StaticMaskedBlockList<VertexBufferImpl, 256> vertex_buffers;
+	StaticMaskedBlockList<VertexLayoutImpl, 256> vertex_layouts;
 	StaticMaskedBlockList<IndexBufferImpl, 256> index_buffers;
 	StaticMaskedBlockList<RenderTargetImpl, 256> render_targets;
+	List<RenderTargetImpl *> render_targets_with_attachments; // to reattach textures recreated by a resize
 	StaticMaskedBlockList<Texture2DImpl, 256> textures_2d;
 	StaticMaskedBlockList<TextureCubeImpl, 256> textures_cube;
+	StaticMaskedBlockList<Texture2DArrayImpl, 256> textures_2d_array;
+	StaticMaskedBlockList<TextureCubeArrayImpl, 256> textures_cube_array;
 	StaticMaskedBlockList<ShaderConstantsImpl, 256> shader_constants;
 	StaticMaskedBlockList<ComputeShaderImpl, 256> compute_shaders;
 	StaticMaskedBlockList<ComputeBufferImpl, 256> compute_buffers;
+	StaticMaskedBlockList<ReadbackImpl, 256> readbacks;
 	StaticBucketHashMap<SamplerKey, GLuint, 256> samplers;
+	StaticBucketHashMap<VertexLayoutKey, VertexLayoutImpl *, 256> vertex_layout_cache;
 	IndexBufferImpl *current_index_buffer;
+	VertexLayoutImpl *current_vertex_layout;
 	RenderTargetImpl back_buffer;
 	Texture2DImpl back_buffer_color;
 	Texture2DImpl back_buffer_depth;
 	RenderTargetImpl *currently_bound_render_target;
+	Texture2DImpl *bound_textures[max_tracked_texture_units] = {};
+	ImageBinding bound_images[max_tracked_image_units] = {};
 	RasterizerState current_rasterizer;
 	BlendFunction current_blend_function;
 	Blend current_blend_source;
@@ -749,6 +1367,53 @@ struct StateGL : State {
 	bool blend_enabled = false;
 	bool depth_clip_enabled = true;
 
+	// Incremented by every on_window_resize. Window relative render targets are resized
+	// when they are bound and no resize happened since the last present.
+	u32 window_size_version = 0;
+	u32 window_size_version_at_present = 0;
+
+	// Upload thread, see InitInfo::upload_thread.
+	HGLRC upload_context = 0;
+	HDC upload_dc = 0;
+	HANDLE upload_thread = 0;
+	DWORD render_thread_id = 0;
+	DWORD upload_thread_id = 0;
+	bool upload_thread_exit = false;
+	SRWLOCK upload_lock = SRWLOCK_INIT;
+	CONDITION_VARIABLE upload_condition = CONDITION_VARIABLE_INIT;
+	UploadJob *upload_jobs[max_pending_uploads]; // ring, jobs run in the order they were queued
+	u32 upload_job_head = 0; // next job to run
+	u32 upload_job_tail = 0; // where the next job is queued
+	PendingUpload pending_uploads[max_pending_uploads];
+	u32 pending_upload_count = 0;
+
+	// Guards pools that both threads add to.
+	SRWLOCK pool_lock = SRWLOCK_INIT;
+
+	// Headless context, see InitInfo::headless.
+	bool headless = false;
+	HWND headless_window = 0;
+	HDC headless_dc = 0;
+	HGLRC headless_context = 0;
+	bool headless_context_of_tl = false; // the first one, it stays alive with tl
+
+	// Fence with value v is fences[v % max_fences_in_flight] until it is known to be signaled.
+	GLsync fences[max_fences_in_flight] = {};
+	u64 next_fence_value = 1;
+	u64 signaled_fence_value = 0;
+
+	// Frame pacing, see set_frame_pacing.
+	u32 max_frames_in_flight = 0;
+	bool low_latency = false;
+	bool frame_begun = false;
+	u64 presented_frame_count = 0;
+	Fence frame_fences[max_frames_in_flight_limit] = {};
+	FrameQueries frame_queries[max_frames_in_flight_limit] = {};
+	u64 timed_frame_count = 0; // frames whose timestamps were read
+	u64 previous_frame_end = 0;
+	f32 cpu_wait_ms = 0;
+	FrameTimings frame_timings = {};
+
 	auto impl_init_colored_rectangle_shader() {
 		colored_rectangle_shader_constants = create_shader_constants<ColoredRectangleShaderConstants>();
 		colored_rectangle_shader = create_shader(u8R"(
@@ -781,29 +1446,126 @@ void main() {
 		assert(_render_target);
 		auto &render_target = *(RenderTargetImpl *)_render_target;
 
-		auto previously_bound_render_target = currently_bound_render_target;
-		bind_render_target(render_target);
-
-		GLbitfield mask = 0;
-		if (flags & ClearFlags_color) { mask |= GL_COLOR_BUFFER_BIT; glClearColor(color.x, color.y, color.z, color.w); }
-		if (flags & ClearFlags_depth) { mask |= GL_DEPTH_BUFFER_BIT; glClearDepth(depth); }
+		update_window_relative_size(render_target);
 
+		// Named clears do not need the target to be bound, but they still respect the scissor.
 		if (scissor_enabled) {
 			glDisable(GL_SCISSOR_TEST);
 		}
 
-		glClear(mask);
+		if (flags & ClearFlags_color) {
+			for (u32 i = 0; i < render_target.color_count; ++i) {
+				glClearNamedFramebufferfv(render_target.frame_buffer, GL_COLOR, i, color.s);
+			}
+		}
+		if (flags & ClearFlags_depth) {
+			glClearNamedFramebufferfv(render_target.frame_buffer, GL_DEPTH, 0, &depth);
+		}
 
 		if (scissor_enabled) {
 			glEnable(GL_SCISSOR_TEST);
 		}
+	}
+	auto impl_discard(RenderTarget *_render_target, ClearFlags flags) {
+		assert(_render_target);
+		auto &render_target = *(RenderTargetImpl *)_render_target;
+
+		// The default framebuffer names its buffers differently.
+		bool is_default = render_target.frame_buffer == 0;
+
+		GLenum attachments[max_color_attachments + 1];
+		u32 attachment_count = 0;
+		if (flags & ClearFlags_color) {
+			if (is_default) {
+				attachments[attachment_count++] = GL_COLOR;
+			} else {
+				for (u32 i = 0; i < render_target.color_count; ++i) {
+					attachments[attachment_count++] = GL_COLOR_ATTACHMENT0 + i;
+				}
+			}
+		}
+		if ((flags & ClearFlags_depth) && render_target.depth) {
+			attachments[attachment_count++] = is_default ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+		}
 
-		if (previously_bound_render_target) {
-			bind_render_target(*previously_bound_render_target);
+		if (attachment_count) {
+			glInvalidateNamedFramebufferData(render_target.frame_buffer, attachment_count, attachments);
 		}
 	}
 	auto impl_present() {
-		gl::present();
+		impl_begin_frame();
+		glQueryCounter(frame_queries[presented_frame_count % max_frames_in_flight_limit].end, GL_TIMESTAMP);
+
+		if (headless) {
+			glFlush();
+		} else {
+			gl::present();
+		}
+		window_size_version_at_present = window_size_version;
+		next_frame_arena();
+		if (upload_thread) {
+			publish_finished_uploads();
+		}
+
+		frame_fences[presented_frame_count % max_frames_in_flight_limit] = impl_insert_fence();
+		++presented_frame_count;
+		frame_begun = false;
+
+		read_frame_timings();
+		frame_timings.cpu_wait_ms = cpu_wait_ms;
+		cpu_wait_ms = 0;
+
+		// In low latency mode the wait is done by begin_frame, right before input is sampled.
+		if (!low_latency) {
+			if (max_frames_in_flight) {
+				wait_for_frames_in_flight(max_frames_in_flight - 1);
+			}
+			impl_begin_frame();
+		}
+	}
+	auto impl_set_frame_pacing(u32 max_frames, bool low_latency_mode) {
+		assert(max_frames <= max_frames_in_flight_limit);
+		max_frames_in_flight = max_frames;
+		low_latency = low_latency_mode;
+	}
+	auto impl_begin_frame() -> void {
+		if (frame_begun)
+			return;
+		frame_begun = true;
+
+		if (low_latency && max_frames_in_flight) {
+			// Start the frame only when the GPU is done with the previous ones, so input is as fresh as possible.
+			wait_for_frames_in_flight(max_frames_in_flight - 1);
+		}
+
+		auto &queries = frame_queries[presented_frame_count % max_frames_in_flight_limit];
+		if (!queries.begin) {
+			glCreateQueries(GL_TIMESTAMP, 1, &queries.begin);
+			glCreateQueries(GL_TIMESTAMP, 1, &queries.end);
+		}
+		glQueryCounter(queries.begin, GL_TIMESTAMP);
+
+		// The timestamp has to reach the GPU now, not with the rest of the frame.
+		glFlush();
+	}
+	auto impl_insert_fence() -> Fence {
+		auto value = next_fence_value++;
+		auto &sync = fences[value % max_fences_in_flight];
+		if (sync) {
+			// Still unknown after max_fences_in_flight newer fences, almost surely signaled.
+			wait_for_fence(value - max_fences_in_flight, GL_TIMEOUT_IGNORED);
+		}
+		sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		return {value};
+	}
+	auto impl_is_signaled(Fence fence) -> bool {
+		return wait_for_fence(fence.value, 0);
+	}
+	auto impl_wait(Fence fence) {
+		wait_for_fence(fence.value, GL_TIMEOUT_IGNORED);
+	}
+	auto impl_get_frame_timings() {
+		return frame_timings;
 	}
 	auto impl_draw(u32 vertex_count, u32 start_vertex) {
 		++draw_call_count;
@@ -813,10 +1575,33 @@ void main() {
 			impl_present();
 		}
 	}
-	auto impl_draw_indexed(u32 index_count) {
+	auto impl_draw_instanced(u32 vertex_count, u32 instance_count, u32 start_vertex, u32 start_instance) {
+		++draw_call_count;
+		assert(vertex_count, "tgraphics::draw_instanced called with 0 vertices");
+		glDrawArraysInstancedBaseInstance(current_topology, start_vertex, vertex_count, instance_count, start_instance);
+		if (debug_present_after_draw && currently_bound_render_target == &back_buffer) {
+			impl_present();
+		}
+	}
+	auto impl_draw_indexed(u32 index_count, u32 first_index, s32 base_vertex) {
+		++draw_call_count;
+		assert(current_index_buffer, "Index buffer was not bound");
+		assert(first_index + index_count <= current_index_buffer->count, "draw_indexed reads past the end of the index buffer");
+		auto offset = (void const *)((umm)first_index * current_index_buffer->index_size);
+		glDrawElementsBaseVertex(current_topology, index_count, current_index_buffer->type, offset, base_vertex);
+		if (debug_present_after_draw && currently_bound_render_target == &back_buffer) {
+			impl_present();
+		}
+	}
+	auto impl_draw_indexed_indirect(ComputeBuffer *_arguments, u32 offset, u32 draw_count, u32 stride) {
 		++draw_call_count;
+		assert(_arguments);
 		assert(current_index_buffer, "Index buffer was not bound");
-		glDrawElements(current_topology, index_count, current_index_buffer->type, 0);
+		auto &arguments = *(ComputeBufferImpl *)_arguments;
+		assert(offset + (umm)draw_count * stride <= arguments.size, "draw_indexed_indirect reads past the end of the argument buffer");
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, arguments.buffer);
+		glMultiDrawElementsIndirect(current_topology, current_index_buffer->type, (void const *)(umm)offset, draw_count, stride);
 		if (debug_present_after_draw && currently_bound_render_target == &back_buffer) {
 			impl_present();
 		}
@@ -826,27 +1611,31 @@ void main() {
 	}
 	auto impl_on_window_resize(u32 width, u32 height) {
 		back_buffer_color.size = back_buffer_depth.size = {width, height};
+		++window_size_version;
 	}
 	auto impl_set_shader(Shader *_shader) {
 		assert(_shader);
 		auto &shader = *(ShaderImpl *)_shader;
+		publish(shader.upload_fence);
 		glUseProgram(shader.program);
 	}
 	auto impl_set_shader_constants(ShaderConstants *_constants, u32 slot) {
 		assert(_constants);
 		auto &constants = *(ShaderConstantsImpl *)_constants;
-		glBindBuffer(GL_UNIFORM_BUFFER, constants.uniform_buffer);
 		glBindBufferBase(GL_UNIFORM_BUFFER, slot, constants.uniform_buffer);
 	}
 	auto impl_update_shader_constants(ShaderConstants *_constants, void const *source, u32 offset, u32 size) {
 		assert(_constants);
 		auto &constants = *(ShaderConstantsImpl *)_constants;
-		glBindBuffer(GL_UNIFORM_BUFFER, constants.uniform_buffer);
-		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, source);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glNamedBufferSubData(constants.uniform_buffer, offset, size, source);
 	}
 	auto impl_create_shader(Span<utf8> source) -> Shader * {
-		auto &shader = *shaders.add().pointer;
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_shader(source); });
+		}
+
+		auto &shader = *add_shared(shaders);
+		shader.upload_fence = 0;
 		auto vertex   = tl::gl::create_shader(GL_VERTEX_SHADER, 430, true, (Span<char>)source);
 		auto fragment = tl::gl::create_shader(GL_FRAGMENT_SHADER, 430, true, (Span<char>)source);
 		assert(vertex);
@@ -856,14 +1645,14 @@ void main() {
 			.fragment = fragment,
 		});
 		assert(shader.program);
+		finish_upload(shader.upload_fence, 0);
 		return &shader;
 	}
 	auto impl_create_shader_constants(umm size) -> ShaderConstants * {
 		auto &constants = *shader_constants.add().pointer;
-		glGenBuffers(1, &constants.uniform_buffer);
-		glBindBuffer(GL_UNIFORM_BUFFER, constants.uniform_buffer);
-		glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STATIC_DRAW);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glCreateBuffers(1, &constants.uniform_buffer);
+		// Immutable storage can only be mapped with the access it was created with.
+		glNamedBufferStorage(constants.uniform_buffer, size, NULL, GL_DYNAMIC_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
 		constants.values_size = size;
 		return &constants;
 	}
@@ -874,88 +1663,245 @@ void main() {
 			       * m4::translation(-position);
 		return result;
 	}
-	auto impl_create_vertex_buffer(Span<u8> buffer, Span<ElementType> vertex_descriptor) -> VertexBuffer * {
-		VertexBufferImpl &result = *vertex_buffers.add().pointer;
-		glGenBuffers(1, &result.buffer);
-		glGenVertexArrays(1, &result.array);
+	auto impl_create_vertex_layout(Span<VertexStream> streams) -> VertexLayout * {
+		assert(streams.count <= max_vertex_streams);
+
+		VertexLayoutKey key;
+		memset(&key, 0, sizeof(key));
+		key.stream_count = streams.count;
+		for (u32 stream_index = 0; stream_index < streams.count; ++stream_index) {
+			auto &stream = streams[stream_index];
+			key.step_rates[stream_index] = stream.step_rate;
+			for (auto &element : stream.elements) {
+				assert(key.element_count < max_vertex_elements);
+				key.elements[key.element_count] = element;
+				key.element_streams[key.element_count] = stream_index;
+				++key.element_count;
+			}
+		}
 
-		glBindVertexArray(result.array);
+		auto &cached = vertex_layout_cache.get_or_insert(key);
+		if (cached)
+			return cached;
 
-		glBindBuffer(GL_ARRAY_BUFFER, result.buffer);
-		glBufferData(GL_ARRAY_BUFFER, buffer.count, buffer.data, GL_STATIC_DRAW);
+		auto &result = *vertex_layouts.add().pointer;
+		result.stream_count = streams.count;
+		result.element_buffer = 0;
 
-		u32 stride = 0;
-		for (auto &element : vertex_descriptor) {
-			stride += get_element_size(element);
+		glCreateVertexArrays(1, &result.array);
+
+		u32 location = 0;
+		for (u32 stream_index = 0; stream_index < streams.count; ++stream_index) {
+			auto &stream = streams[stream_index];
+
+			u32 offset = 0;
+			for (auto &element : stream.elements) {
+				glEnableVertexArrayAttrib(result.array, location);
+				if (is_element_integer(element)) {
+					glVertexArrayAttribIFormat(result.array, location, get_element_scalar_count(element), get_element_type(element), offset);
+				} else {
+					glVertexArrayAttribFormat(result.array, location, get_element_scalar_count(element), get_element_type(element), is_element_normalized(element), offset);
+				}
+				glVertexArrayAttribBinding(result.array, location, stream_index);
+				offset += get_element_size(element);
+				++location;
+			}
+
+			result.strides[stream_index] = offset;
+			glVertexArrayBindingDivisor(result.array, stream_index, stream.step_rate);
+		}
+
+		cached = &result;
+		return &result;
+	}
+	auto impl_set_vertex_layout(VertexLayout *_layout) {
+		auto layout = (VertexLayoutImpl *)_layout;
+		if (layout == current_vertex_layout)
+			return;
+
+		current_vertex_layout = layout;
+		glBindVertexArray(layout ? layout->array : 0);
+
+		// Index buffer binding is part of the vertex array state.
+		if (layout) {
+			attach_current_index_buffer(*layout);
+		}
+	}
+	auto impl_set_vertex_buffers(u32 slot, VertexBuffer *_buffer, u32 offset, u32 stride) {
+		assert(current_vertex_layout, "set_vertex_buffers requires a vertex layout to be set");
+		assert(slot < current_vertex_layout->stream_count);
+		auto buffer = (VertexBufferImpl *)_buffer;
+		if (buffer) {
+			publish(*buffer);
+		}
+		glVertexArrayVertexBuffer(current_vertex_layout->array, slot, buffer ? buffer->buffer : 0, offset, stride ? stride : current_vertex_layout->strides[slot]);
+	}
+	auto impl_create_vertex_buffer(Span<u8> buffer, Span<ElementType> vertex_descriptor) -> VertexBuffer * {
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_vertex_buffer(buffer, vertex_descriptor); });
 		}
 
-		u32 offset = 0;
-		for (u32 element_index = 0; element_index < vertex_descriptor.count; ++element_index) {
-			auto &element = vertex_descriptor[element_index];
-			glVertexAttribPointer(element_index, get_element_scalar_count(element), get_element_type(element), false, stride, (void const *)offset);
-			glEnableVertexAttribArray(element_index);
-			offset += get_element_size(element);
+		VertexBufferImpl &result = *add_shared(vertex_buffers);
+		result.upload_fence = 0;
+		result.pending_descriptor_count = 0;
+
+		// Buffers without a descriptor can be used only through set_vertex_buffers.
+		result.layout = 0;
+		if (vertex_descriptor.count) {
+			if (is_upload_thread()) {
+				assert(vertex_descriptor.count <= max_vertex_elements);
+				memcpy(result.pending_descriptor, vertex_descriptor.data, vertex_descriptor.count * sizeof(ElementType));
+				result.pending_descriptor_count = (u32)vertex_descriptor.count;
+			} else {
+				result.layout = (VertexLayoutImpl *)create_vertex_layout(vertex_descriptor);
+			}
 		}
 
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		// Mutable storage, update_vertex_buffer may change the size.
+		glCreateBuffers(1, &result.buffer);
+		glNamedBufferData(result.buffer, buffer.count, buffer.data, GL_STATIC_DRAW);
+		result.size = buffer.count;
 
+		finish_upload(result.upload_fence, &result);
 		return &result;
 	}
 	auto impl_set_vertex_buffer(VertexBuffer *_buffer) {
 		auto buffer = (VertexBufferImpl *)_buffer;
-		glBindVertexArray(buffer ? buffer->array : 0);
+		if (!buffer) {
+			impl_set_vertex_layout(0);
+			return;
+		}
+
+		publish(*buffer);
+		assert(buffer->layout, "set_vertex_buffer requires a buffer created with a vertex descriptor");
+		impl_set_vertex_layout(buffer->layout);
+		glVertexArrayVertexBuffer(buffer->layout->array, 0, buffer->buffer, 0, buffer->layout->strides[0]);
 	}
 	auto impl_create_index_buffer(Span<u8> buffer, u32 index_size) -> IndexBuffer * {
 		IndexBufferImpl &result = *index_buffers.add().pointer;
-		result.type = get_index_type_from_size(index_size);
+		result.source_index_size = index_size;
+		result.index_size = select_index_size(buffer, index_size);
+		result.type = get_index_type_from_size(result.index_size);
 		result.count = buffer.count / index_size;
 
-		glGenBuffers(1, &result.buffer);
+		// Converted indices are needed only until the upload, they do not belong in a frame arena.
+		void const *data = buffer.data;
+		u16 *narrowed = 0;
+		if (result.index_size != index_size) {
+			narrowed = allocator.allocate<u16>(result.count);
+			narrow_indices(buffer.data, index_size, result.count, narrowed);
+			data = narrowed;
+		}
+		defer {
+			if (narrowed)
+				allocator.free(narrowed);
+		};
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, result.buffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.count, buffer.data, GL_STATIC_DRAW);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		// Mutable storage, so a narrowed buffer can be widened in place and vertex arrays that reference it stay valid.
+		glCreateBuffers(1, &result.buffer);
+		glNamedBufferData(result.buffer, (umm)result.count * result.index_size, data, GL_STATIC_DRAW);
 
 		return &result;
 	}
-	auto impl_set_index_buffer(IndexBuffer *_buffer) {
-		auto buffer = (IndexBufferImpl *)_buffer;
-		current_index_buffer = buffer;
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer ? buffer->buffer : 0);
-	}
-	auto impl_set_vsync(bool enable) {
-		wglSwapIntervalEXT(enable);
+	auto impl_update_index_buffer(IndexBuffer *_buffer, Span<u8> data, u32 first_index) {
+		assert(_buffer);
+		auto &buffer = *(IndexBufferImpl *)_buffer;
+
+		auto count = data.count / buffer.source_index_size;
+		assert(first_index + count <= buffer.count, "update_index_buffer writes past the end of the index buffer");
+
+		if (buffer.index_size < buffer.source_index_size && select_index_size(data, buffer.source_index_size) > buffer.index_size) {
+			widen_index_buffer(buffer);
+		}
+
+		void const *source = data.data;
+		u16 *narrowed = 0;
+		if (buffer.index_size != buffer.source_index_size) {
+			narrowed = allocator.allocate<u16>(count);
+			narrow_indices(data.data, buffer.source_index_size, count, narrowed);
+			source = narrowed;
+		}
+		defer {
+			if (narrowed)
+				allocator.free(narrowed);
+		};
+
+		glNamedBufferSubData(buffer.buffer, (umm)first_index * buffer.index_size, count * buffer.index_size, source);
+	}
+	auto impl_set_index_buffer(IndexBuffer *_buffer) {
+		auto buffer = (IndexBufferImpl *)_buffer;
+		current_index_buffer = buffer;
+		if (current_vertex_layout) {
+			attach_current_index_buffer(*current_vertex_layout);
+		}
+	}
+	auto impl_set_vsync(bool enable) {
+		if (headless)
+			return;
+		wglSwapIntervalEXT(enable);
+	}
+	auto impl_create_window_render_target(Format color_format, Format depth_format, f32 scale) -> RenderTarget * {
+		assert(scale > 0);
+		assert(color_format != Format_null || depth_format != Format_null);
+
+		// Go through the function pointers, so wrappers like frame capture see the attachments.
+		auto size = get_window_relative_size(scale);
+		auto color = color_format != Format_null ? create_texture_2d(size.x, size.y, 0, color_format) : 0;
+		auto depth = depth_format != Format_null ? create_texture_2d(size.x, size.y, 0, depth_format) : 0;
+
+		auto &result = *(RenderTargetImpl *)create_render_target(color, depth);
+		result.window_scale = scale;
+		result.window_size_version = window_size_version;
+		return &result;
 	}
 	auto impl_set_render_target(RenderTarget *_render_target) {
 		assert(_render_target);
 		auto &render_target = *(RenderTargetImpl *)_render_target;
 		bind_render_target(render_target);
 	}
-	auto impl_create_render_target(Texture2D *_color, Texture2D *_depth) -> RenderTarget * {
-		assert(_color || _depth);
-		auto color = (Texture2DImpl *)_color;
+	auto impl_create_render_target(Texture2D *color, Texture2D *depth) -> RenderTarget * {
+		assert(color || depth);
+		return impl_create_render_target_with_attachments(color ? Span(&color, 1) : Span<Texture2D *>{}, depth);
+	}
+	auto impl_create_render_target_with_attachments(Span<Texture2D *> colors, Texture2D *_depth) -> RenderTarget * {
+		assert(colors.count || _depth);
+		assert(colors.count <= max_color_attachments, "Too many color attachments");
 		auto depth = (Texture2DImpl *)_depth;
 
 		auto &result = *render_targets.add().pointer;
 
-		result.color = color;
+		result.color = colors.count ? colors[0] : 0;
 		result.depth = depth;
+		result.color_count = (u32)colors.count;
+		for (u32 i = 0; i < max_color_attachments; ++i) {
+			result.colors[i] = i < colors.count ? colors[i] : 0;
+		}
+		result.window_scale = 0;
+		result.window_size_version = 0;
+
+		glCreateFramebuffers(1, &result.frame_buffer);
 
-		glGenFramebuffers(1, &result.frame_buffer);
-		glBindFramebuffer(GL_FRAMEBUFFER, result.frame_buffer);
+		GLenum draw_buffers[max_color_attachments];
+		for (u32 i = 0; i < colors.count; ++i) {
+			assert(colors[i]);
+			publish(((Texture2DImpl *)colors[i])->upload_fence);
+			attach_texture(result.frame_buffer, GL_COLOR_ATTACHMENT0 + i, *(Texture2DImpl *)colors[i]);
+			draw_buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+		}
 		if (depth) {
-			if (!color) {
-				glDrawBuffer(GL_NONE);
-				glReadBuffer(GL_NONE);
-			}
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth->texture, 0);
+			publish(depth->upload_fence);
+			attach_texture(result.frame_buffer, GL_DEPTH_ATTACHMENT, *depth);
 		}
-		if (color) {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color->texture, 0);
+		render_targets_with_attachments.add(&result);
+
+		if (colors.count) {
+			glNamedFramebufferDrawBuffers(result.frame_buffer, (GLsizei)colors.count, draw_buffers);
+		} else {
+			glNamedFramebufferDrawBuffer(result.frame_buffer, GL_NONE);
+			glNamedFramebufferReadBuffer(result.frame_buffer, GL_NONE);
 		}
 
-		switch(glCheckFramebufferStatus(GL_FRAMEBUFFER)) {
+		switch(glCheckNamedFramebufferStatus(result.frame_buffer, GL_FRAMEBUFFER)) {
 #define C(x) case x: print(#x "\n"); invalid_code_path(); break;
 			C(GL_FRAMEBUFFER_UNDEFINED)
 			C(GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT)
@@ -965,45 +1911,177 @@ void main() {
 #undef C
 			case GL_FRAMEBUFFER_COMPLETE: break;
 		}
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		return &result;
 	}
+	auto impl_resolve(RenderTarget *_source, RenderTarget *_destination) {
+		assert(_source);
+		assert(_destination);
+		auto &source = *(RenderTargetImpl *)_source;
+		auto &destination = *(RenderTargetImpl *)_destination;
+
+		auto size = source.color ? source.color->size : source.depth->size;
+		for (u32 i = 0; i < min(source.color_count, destination.color_count); ++i) {
+			assert(all_true(source.colors[i]->size == destination.colors[i]->size), "Resolve source and destination must be of the same size");
+		}
+		if (source.depth && destination.depth) {
+			assert(all_true(source.depth->size == destination.depth->size), "Resolve source and destination must be of the same size");
+		}
+
+		// Blits are clipped by the scissor.
+		if (scissor_enabled) {
+			glDisable(GL_SCISSOR_TEST);
+		}
+
+		// Color attachments are resolved one by one, because a blit reads only the read buffer.
+		// The back buffer has no attachments, its draw buffer is left as is.
+		u32 color_count = min(source.color_count, destination.color_count);
+		for (u32 i = 0; i < color_count; ++i) {
+			glNamedFramebufferReadBuffer(source.frame_buffer, GL_COLOR_ATTACHMENT0 + i);
+			if (destination.frame_buffer) {
+				glNamedFramebufferDrawBuffer(destination.frame_buffer, GL_COLOR_ATTACHMENT0 + i);
+			}
+			glBlitNamedFramebuffer(source.frame_buffer, destination.frame_buffer, 0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		}
+		if (color_count) {
+			glNamedFramebufferReadBuffer(source.frame_buffer, GL_COLOR_ATTACHMENT0);
+			if (destination.frame_buffer) {
+				GLenum draw_buffers[max_color_attachments];
+				for (u32 i = 0; i < destination.color_count; ++i) {
+					draw_buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+				}
+				glNamedFramebufferDrawBuffers(destination.frame_buffer, destination.color_count, draw_buffers);
+			}
+		}
+
+		if (source.depth && destination.depth) {
+			glBlitNamedFramebuffer(source.frame_buffer, destination.frame_buffer, 0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		}
+
+		if (scissor_enabled) {
+			glEnable(GL_SCISSOR_TEST);
+		}
+	}
 	auto impl_set_sampler(Filtering filtering, Comparison comparison, u32 slot) {
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindSampler(slot, get_sampler(filtering, comparison));
 	}
 	auto impl_set_texture_2d(Texture2D *_texture, u32 slot) {
 		auto &texture = *(Texture2DImpl *)_texture;
+		assert(!_texture || texture.target != GL_RENDERBUFFER, "Renderbuffers can not be sampled");
+		if (_texture) {
+			publish(texture.upload_fence);
+		}
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindTexture(texture.target, _texture ? texture.texture : 0);
+		if (slot < max_tracked_texture_units)
+			bound_textures[slot] = (Texture2DImpl *)_texture;
 	}
 	auto impl_set_texture_cube(TextureCube *_texture, u32 slot) {
 		auto &texture = *(TextureCubeImpl *)_texture;
 		glActiveTexture(GL_TEXTURE0 + slot);
 		if (_texture) {
+			publish(texture.upload_fence);
 			glBindTexture(texture.target, texture.texture);
 		} else {
 			glBindTexture(texture.target, 0);
 		}
 	}
 	auto impl_create_texture_2d(u32 width, u32 height, void const *data, Format format) -> Texture2D * {
-		auto &result = *textures_2d.add().pointer;
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_texture_2d(width, height, data, format); });
+		}
 
-		result.size = {width, height};
+		auto &result = *add_shared(textures_2d);
 
-		result.internal_format = get_internal_format(format);
+		result.internal_format = get_sized_internal_format(format);
 		result.format          = get_format(format);
 		result.type            = get_type(format);
 		result.bytes_per_texel = get_bytes_per_texel(format);
 		result.target = GL_TEXTURE_2D;
+		result.sample_count = 1;
+		result.mip_count = 1;
+		result.texture = 0;
+		result.upload_fence = 0;
+
+		resize_texture_gl(&result, width, height);
+		if (data) {
+			glTextureSubImage2D(result.texture, 0, 0, 0, width, height, result.format, result.type, data);
+		}
 
-		glGenTextures(1, &result.texture);
-		glBindTexture(GL_TEXTURE_2D, result.texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, result.internal_format, width, height, 0, result.format, result.type, data);
-		glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_MAX_LEVEL, 0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		finish_upload(result.upload_fence, 0);
+		return &result;
+	}
+	auto impl_create_texture_2d_mipmapped(u32 width, u32 height, u32 mip_count, Format format) -> Texture2D * {
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_texture_2d_mipmapped(width, height, mip_count, format); });
+		}
+
+		assert(mip_count);
+		auto &result = *add_shared(textures_2d);
+
+		result.internal_format = get_sized_internal_format(format);
+		result.format          = get_format(format);
+		result.type            = get_type(format);
+		result.bytes_per_texel = get_bytes_per_texel(format);
+		result.target = GL_TEXTURE_2D;
+		result.sample_count = 1;
+		result.mip_count = mip_count;
+		result.texture = 0;
+		result.upload_fence = 0;
+
+		resize_texture_gl(&result, width, height);
+
+		finish_upload(result.upload_fence, 0);
+		return &result;
+	}
+	auto impl_create_texture_2d_multisampled(u32 width, u32 height, Format format, u32 sample_count) -> Texture2D * {
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_texture_2d_multisampled(width, height, format, sample_count); });
+		}
+
+		assert(sample_count);
+		format = get_multisampled_format(format);
+		auto &result = *add_shared(textures_2d);
+
+		result.internal_format = get_sized_internal_format(format);
+		result.format          = get_format(format);
+		result.type            = get_type(format);
+		result.bytes_per_texel = get_bytes_per_texel(format);
+		result.target = GL_TEXTURE_2D_MULTISAMPLE;
+		result.sample_count = sample_count;
+		result.mip_count = 1;
+		result.texture = 0;
+		result.upload_fence = 0;
+
+		resize_texture_gl(&result, width, height);
 
+		finish_upload(result.upload_fence, 0);
+		return &result;
+	}
+	auto impl_create_renderbuffer(u32 width, u32 height, Format format, u32 sample_count) -> Texture2D * {
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_renderbuffer(width, height, format, sample_count); });
+		}
+
+		if (sample_count > 1) {
+			format = get_multisampled_format(format);
+		}
+		auto &result = *add_shared(textures_2d);
+
+		result.internal_format = get_sized_internal_format(format);
+		result.format          = get_format(format);
+		result.type            = get_type(format);
+		result.bytes_per_texel = get_bytes_per_texel(format);
+		result.target = GL_RENDERBUFFER;
+		result.sample_count = sample_count > 1 ? sample_count : 0;
+		result.mip_count = 1;
+		result.texture = 0;
+		result.upload_fence = 0;
+
+		resize_texture_gl(&result, width, height);
+
+		finish_upload(result.upload_fence, 0);
 		return &result;
 	}
 	auto impl_set_rasterizer(RasterizerState rasterizer) {
@@ -1045,44 +2123,109 @@ void main() {
 	auto impl_dispatch_compute_shader(u32 x, u32 y, u32 z) {
 		glDispatchCompute(x, y, z);
 	}
-	auto impl_resize_texture_2d(Texture2D *texture, u32 width, u32 height) { resize_texture_gl(texture, width, height); }
+	auto impl_dispatch_compute_indirect(ComputeBuffer *_arguments, u32 offset) {
+		assert(_arguments);
+		auto &arguments = *(ComputeBufferImpl *)_arguments;
+		assert(offset % 4 == 0, "dispatch_compute_indirect: offset must be a multiple of 4");
+		assert(offset + 3 * sizeof(u32) <= arguments.size, "dispatch_compute_indirect reads past the end of the argument buffer");
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, arguments.buffer);
+		glDispatchComputeIndirect(offset);
+	}
+	auto impl_memory_barrier(Barrier barriers) {
+		glMemoryBarrier(get_barriers(barriers));
+	}
+	auto impl_resize_texture_2d(Texture2D *texture, u32 width, u32 height) { resize_texture(*(Texture2DImpl *)texture, width, height); }
 	auto impl_create_compute_buffer(u32 size) -> ComputeBuffer * {
 		auto &result = *compute_buffers.add().pointer;
 		result.size = size;
-		glGenBuffers(1, &result.buffer);
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, result.buffer);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, size, 0, GL_STATIC_COPY);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, result.buffer);
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
+		glCreateBuffers(1, &result.buffer);
+		glNamedBufferStorage(result.buffer, size, 0, GL_DYNAMIC_STORAGE_BIT);
 		return &result;
 	}
 	auto impl_set_compute_buffer(ComputeBuffer *_buffer, u32 slot) {
 		assert(_buffer);
 		auto &buffer = *(ComputeBufferImpl *)_buffer;
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.buffer);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, slot, buffer.buffer);
+	}
+	auto impl_update_compute_buffer(ComputeBuffer *_buffer, void const *data, u32 offset, u32 size) {
+		assert(_buffer);
+		auto &buffer = *(ComputeBufferImpl *)_buffer;
+		assert(offset + size <= buffer.size, "update_compute_buffer writes past the end of the buffer");
+		glNamedBufferSubData(buffer.buffer, offset, size, data);
 	}
 	auto impl_read_compute_buffer(ComputeBuffer *_buffer, void *data) {
 		assert(_buffer);
 		auto &buffer = *(ComputeBufferImpl *)_buffer;
 
-		//glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.buffer);
-		void* resultData = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffer.size, GL_MAP_READ_BIT);
-		memcpy(data, resultData, buffer.size);
-		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glGetNamedBufferSubData(buffer.buffer, 0, buffer.size, data);
 	}
-	auto impl_set_compute_texture(Texture2D *_texture, u32 slot) {
+	auto impl_set_compute_texture(Texture2D *_texture, u32 slot, u32 mip, Access access) {
 		assert(_texture);
 		auto &texture = *(Texture2DImpl *)_texture;
-		glBindImageTexture(slot, texture.texture, 0, GL_FALSE, 0, GL_READ_ONLY, texture.internal_format);
+		publish(texture.upload_fence);
+		glBindImageTexture(slot, texture.texture, mip, GL_FALSE, 0, get_access(access), texture.internal_format);
+		if (slot < max_tracked_image_units)
+			bound_images[slot] = {&texture, mip, access};
+	}
+	auto impl_create_readback(u32 size) -> Readback * {
+		auto &result = *readbacks.add().pointer;
+		result.size = size;
+		result.fence = 0;
+		glCreateBuffers(1, &result.buffer);
+		glNamedBufferStorage(result.buffer, size, 0, GL_MAP_READ_BIT);
+		return &result;
+	}
+	auto impl_read_texture_2d_async(Texture2D *_texture, u32 mip, Readback *_readback) {
+		assert(_texture);
+		assert(_readback);
+		auto &texture = *(Texture2DImpl *)_texture;
+		auto &readback = *(ReadbackImpl *)_readback;
+		assert(mip < get_allocated_mip_count(texture));
+		assert((umm)max(1u, texture.size.x >> mip) * max(1u, texture.size.y >> mip) * texture.bytes_per_texel <= readback.size, "read_texture_2d_async: readback is too small");
+
+		// There is no named variant that writes to a buffer, the pack buffer binding is the only way.
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		glGetTextureImage(texture.texture, mip, texture.format, texture.type, readback.size, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (readback.fence)
+			glDeleteSync(readback.fence);
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	auto impl_is_readback_ready(Readback *_readback) -> bool {
+		assert(_readback);
+		auto &readback = *(ReadbackImpl *)_readback;
+		if (!readback.fence)
+			return true;
+
+		auto status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			return false;
+
+		glDeleteSync(readback.fence);
+		readback.fence = 0;
+		return true;
+	}
+	auto impl_map_readback(Readback *_readback) -> void * {
+		assert(_readback);
+		auto &readback = *(ReadbackImpl *)_readback;
+		if (readback.fence) {
+			glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(readback.fence);
+			readback.fence = 0;
+		}
+		return glMapNamedBufferRange(readback.buffer, 0, readback.size, GL_MAP_READ_BIT);
+	}
+	auto impl_unmap_readback(Readback *_readback) {
+		assert(_readback);
+		auto &readback = *(ReadbackImpl *)_readback;
+		glUnmapNamedBuffer(readback.buffer);
 	}
 	auto impl_read_texture_2d(Texture2D *_texture, Span<u8> data) {
 		assert(_texture);
 		auto &texture = *(Texture2DImpl *)_texture;
+		publish(texture.upload_fence);
 		glGetTextureImage(texture.texture, 0, texture.format, texture.type, data.count, data.data);
 	}
 	auto impl_set_blend(BlendFunction function, Blend source, Blend destination) {
@@ -1114,49 +2257,234 @@ void main() {
 		if (!depth_clip_enabled) { depth_clip_enabled = true ; glDisable(GL_DEPTH_CLAMP); }
 	}
 	auto impl_create_texture_cube(u32 size, void *data[6], Format format) -> TextureCube * {
-		auto &result = *textures_cube.add().pointer;
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_texture_cube(size, data, format); });
+		}
+
+		auto &result = *add_shared(textures_cube);
 
 		// result.size = {width, height}
 
-		result.internal_format = get_internal_format(format);
+		result.internal_format = get_sized_internal_format(format);
 		result.format          = get_format(format);
 		result.type            = get_type(format);
 		result.bytes_per_texel = get_bytes_per_texel(format);
 		result.target          = GL_TEXTURE_CUBE_MAP;
+		result.upload_fence    = 0;
 
-		glGenTextures(1, &result.texture);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, result.texture);
+		// The whole chain is allocated so generate_mipmaps has somewhere to write.
+		glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &result.texture);
+		glTextureStorage2D(result.texture, get_full_mip_count(size, size), result.internal_format, size, size);
 		for (u32 i = 0; i < 6; ++i) {
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, result.internal_format, size, size, 0, result.format, result.type, data[i]);
+			if (data[i]) {
+				glTextureSubImage3D(result.texture, 0, 0, 0, i, size, size, 1, result.format, result.type, data[i]);
+			}
 		}
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
+		finish_upload(result.upload_fence, 0);
+		return &result;
+	}
+	auto impl_create_texture_2d_array(u32 width, u32 height, u32 layer_count, u32 mip_count, Format format) -> Texture2DArray * {
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_texture_2d_array(width, height, layer_count, mip_count, format); });
+		}
+
+		assert(layer_count);
+		assert(mip_count);
+		auto &result = *add_shared(textures_2d_array);
+
+		result.size = {width, height};
+		result.layer_count = layer_count;
+		result.mip_count = min(mip_count, get_full_mip_count(width, height));
+
+		result.internal_format = get_sized_internal_format(format);
+		result.format          = get_format(format);
+		result.type            = get_type(format);
+		result.bytes_per_texel = get_bytes_per_texel(format);
+		result.target = GL_TEXTURE_2D_ARRAY;
+		result.sample_count = 1;
+		result.upload_fence = 0;
+
+		glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &result.texture);
+		glTextureStorage3D(result.texture, result.mip_count, result.internal_format, width, height, layer_count);
+
+		finish_upload(result.upload_fence, 0);
 		return &result;
 	}
+	auto impl_update_texture_2d_array_layer(Texture2DArray *_texture, u32 layer, void const *data) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_update_texture_2d_array_layer(_texture, layer, data); });
+		}
+
+		assert(_texture);
+		assert(data);
+		auto &texture = *(Texture2DArrayImpl *)_texture;
+		publish(texture.upload_fence);
+		assert(layer < texture.layer_count, "update_texture_2d_array_layer: layer is out of range");
+		glTextureSubImage3D(texture.texture, 0, 0, 0, layer, texture.size.x, texture.size.y, 1, texture.format, texture.type, data);
+
+		finish_upload(texture.upload_fence, 0);
+	}
+	auto impl_generate_mipmaps_2d_array(Texture2DArray *_texture) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_generate_mipmaps_2d_array(_texture); });
+		}
+
+		assert(_texture);
+		auto &texture = *(Texture2DArrayImpl *)_texture;
+		publish(texture.upload_fence);
+		glGenerateTextureMipmap(texture.texture);
+
+		finish_upload(texture.upload_fence, 0);
+	}
+	auto impl_set_texture_2d_array(Texture2DArray *_texture, u32 slot) {
+		auto &texture = *(Texture2DArrayImpl *)_texture;
+		if (_texture) {
+			publish(texture.upload_fence);
+		}
+		glActiveTexture(GL_TEXTURE0 + slot);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, _texture ? texture.texture : 0);
+	}
+	auto impl_create_texture_cube_array(u32 size, u32 layer_count, Format format) -> TextureCubeArray * {
+		if (is_loading_thread()) {
+			return run_on_upload_thread([&] { return impl_create_texture_cube_array(size, layer_count, format); });
+		}
+
+		assert(layer_count);
+		auto &result = *add_shared(textures_cube_array);
+
+		result.size = size;
+		result.layer_count = layer_count;
+		result.mip_count = get_full_mip_count(size, size);
+
+		result.internal_format = get_sized_internal_format(format);
+		result.format          = get_format(format);
+		result.type            = get_type(format);
+		result.bytes_per_texel = get_bytes_per_texel(format);
+		result.target = GL_TEXTURE_CUBE_MAP_ARRAY;
+		result.sample_count = 1;
+		result.upload_fence = 0;
+
+		// Depth of a cube map array counts faces, six per layer.
+		glCreateTextures(GL_TEXTURE_CUBE_MAP_ARRAY, 1, &result.texture);
+		glTextureStorage3D(result.texture, result.mip_count, result.internal_format, size, size, layer_count * 6);
+
+		finish_upload(result.upload_fence, 0);
+		return &result;
+	}
+	auto impl_update_texture_cube_array_layer(TextureCubeArray *_texture, u32 layer, void **data) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_update_texture_cube_array_layer(_texture, layer, data); });
+		}
+
+		assert(_texture);
+		auto &texture = *(TextureCubeArrayImpl *)_texture;
+		publish(texture.upload_fence);
+		assert(layer < texture.layer_count, "update_texture_cube_array_layer: layer is out of range");
+		for (u32 face = 0; face < 6; ++face) {
+			if (data[face]) {
+				glTextureSubImage3D(texture.texture, 0, 0, 0, layer * 6 + face, texture.size, texture.size, 1, texture.format, texture.type, data[face]);
+			}
+		}
+
+		finish_upload(texture.upload_fence, 0);
+	}
+	auto impl_generate_mipmaps_cube_array(TextureCubeArray *_texture) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_generate_mipmaps_cube_array(_texture); });
+		}
+
+		assert(_texture);
+		auto &texture = *(TextureCubeArrayImpl *)_texture;
+		publish(texture.upload_fence);
+		glGenerateTextureMipmap(texture.texture);
+
+		finish_upload(texture.upload_fence, 0);
+	}
+	auto impl_set_texture_cube_array(TextureCubeArray *_texture, u32 slot) {
+		auto &texture = *(TextureCubeArrayImpl *)_texture;
+		if (_texture) {
+			publish(texture.upload_fence);
+		}
+		glActiveTexture(GL_TEXTURE0 + slot);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, _texture ? texture.texture : 0);
+	}
 	auto impl_set_topology(Topology topology) {
 		current_topology = get_topology(topology);
 	}
 	auto impl_update_vertex_buffer(VertexBuffer *_buffer, Span<u8> data) {
 		auto &buffer = *(VertexBufferImpl *)_buffer;
-		glBindBuffer(GL_ARRAY_BUFFER, buffer.buffer);
-		glBufferData(GL_ARRAY_BUFFER, data.count, data.data, GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		publish(buffer);
+		glNamedBufferData(buffer.buffer, data.count, data.data, GL_STATIC_DRAW);
+		buffer.size = data.count;
+	}
+	auto impl_map_vertex_buffer(VertexBuffer *_buffer, Access access) {
+		assert(_buffer);
+		auto &buffer = *(VertexBufferImpl *)_buffer;
+		publish(buffer);
+		return glMapNamedBuffer(buffer.buffer, get_access(access));
+	}
+	auto impl_unmap_vertex_buffer(VertexBuffer *_buffer) {
+		assert(_buffer);
+		auto &buffer = *(VertexBufferImpl *)_buffer;
+		glUnmapNamedBuffer(buffer.buffer);
 	}
-	auto impl_update_texture_2d(Texture2D *_texture, u32 width, u32 height, void *data) {
+	auto impl_update_texture_2d(Texture2D *_texture, u32 width, u32 height, void *data) -> void {
+		if (is_loading_thread()) {
+			// Resizing reattaches the texture to framebuffers and rebinds its units, which belong to the render context.
+			assert(_texture->size.x == width && _texture->size.y == height, "update_texture_2d can not resize a texture outside of the render thread");
+			return run_job_on_upload_thread([&] { impl_update_texture_2d(_texture, width, height, data); });
+		}
+
+		auto &texture = *(Texture2DImpl *)_texture;
+		publish(texture.upload_fence);
+		if (texture.size.x != width || texture.size.y != height) {
+			resize_texture(texture, width, height);
+		}
+		if (data) {
+			glTextureSubImage2D(texture.texture, 0, 0, 0, width, height, texture.format, texture.type, data);
+		}
+
+		finish_upload(texture.upload_fence, 0);
+	}
+	auto impl_update_texture_2d_region(Texture2D *_texture, u32 x, u32 y, u32 width, u32 height, void const *data) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_update_texture_2d_region(_texture, x, y, width, height, data); });
+		}
+
+		assert(_texture);
+		assert(data);
 		auto &texture = *(Texture2DImpl *)_texture;
-		glBindTexture(texture.target, texture.texture);
-		glTexImage2D(texture.target, 0, texture.internal_format, width, height, 0, texture.format, texture.type, data);
-		glBindTexture(texture.target, 0);
+		publish(texture.upload_fence);
+		assert(x + width <= texture.size.x && y + height <= texture.size.y, "update_texture_2d_region: region is out of bounds");
+
+		glTextureSubImage2D(texture.texture, 0, x, y, width, height, texture.format, texture.type, data);
+
+		finish_upload(texture.upload_fence, 0);
 	}
-	auto impl_generate_mipmaps_2d(Texture2D *_texture) {
+	auto impl_generate_mipmaps_2d(Texture2D *_texture) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_generate_mipmaps_2d(_texture); });
+		}
+
 		assert(_texture);
 		auto &texture = *(Texture2DImpl *)_texture;
+		publish(texture.upload_fence);
 		glGenerateTextureMipmap(texture.texture);
+
+		finish_upload(texture.upload_fence, 0);
 	}
-	auto impl_generate_mipmaps_cube(TextureCube *_texture, GenerateCubeMipmapParams params) {
+	auto impl_generate_mipmaps_cube(TextureCube *_texture, GenerateCubeMipmapParams params) -> void {
+		if (is_loading_thread()) {
+			return run_job_on_upload_thread([&] { impl_generate_mipmaps_cube(_texture, params); });
+		}
+
 		assert(_texture);
 		auto &texture = *(TextureCubeImpl *)_texture;
+		publish(texture.upload_fence);
 		glGenerateTextureMipmap(texture.texture);
+
+		finish_upload(texture.upload_fence, 0);
 	}
 	auto impl_set_scissor(s32 x, s32 y, u32 w, u32 h) {
 		if (!scissor_enabled) {
@@ -1197,7 +2525,95 @@ void main() {
 	}
 
 
+	// Converts a narrowed 16 bit index buffer back to 32 bits, keeping its contents.
+	// Reads the buffer back, so it stalls, but happens at most once per buffer.
+	void widen_index_buffer(IndexBufferImpl &buffer) {
+		assert(buffer.index_size == 2);
+
+		auto narrow = allocator.allocate<u16>(buffer.count);
+		auto wide = allocator.allocate<u32>(buffer.count);
+		defer {
+			allocator.free(narrow);
+			allocator.free(wide);
+		};
+
+		glGetNamedBufferSubData(buffer.buffer, 0, (umm)buffer.count * sizeof(u16), narrow);
+		for (u32 i = 0; i < buffer.count; ++i) {
+			wide[i] = narrow[i];
+		}
+		glNamedBufferData(buffer.buffer, (umm)buffer.count * sizeof(u32), wide, GL_STATIC_DRAW);
+
+		buffer.index_size = 4;
+		buffer.type = get_index_type_from_size(buffer.index_size);
+	}
+
+	void attach_current_index_buffer(VertexLayoutImpl &layout) {
+		GLuint element_buffer = current_index_buffer ? current_index_buffer->buffer : 0;
+		if (layout.element_buffer != element_buffer) {
+			layout.element_buffer = element_buffer;
+			glVertexArrayElementBuffer(layout.array, element_buffer);
+		}
+	}
+
+	v2u get_window_relative_size(f32 scale) {
+		return {
+			max(1u, (u32)(back_buffer_color.size.x * scale)),
+			max(1u, (u32)(back_buffer_color.size.y * scale)),
+		};
+	}
+
+	// Resizes a window relative target once the window size stopped changing.
+	// While the window is being dragged it keeps the old size.
+	void update_window_relative_size(RenderTargetImpl &render_target) {
+		if (render_target.window_scale == 0 || render_target.window_size_version == window_size_version)
+			return;
+		if (window_size_version != window_size_version_at_present)
+			return;
+
+		render_target.window_size_version = window_size_version;
+
+		auto size = get_window_relative_size(render_target.window_scale);
+		for (u32 i = 0; i < render_target.color_count; ++i) {
+			if (any_true(render_target.colors[i]->size != size))
+				resize_texture(*(Texture2DImpl *)render_target.colors[i], size.x, size.y);
+		}
+		if (render_target.depth && any_true(render_target.depth->size != size))
+			resize_texture(*(Texture2DImpl *)render_target.depth, size.x, size.y);
+	}
+
+	void resize_texture(Texture2DImpl &texture, u32 width, u32 height) {
+		publish(texture.upload_fence);
+		if (!resize_texture_gl(&texture, width, height))
+			return;
+
+		for (auto render_target : render_targets_with_attachments) {
+			for (u32 i = 0; i < render_target->color_count; ++i) {
+				if (render_target->colors[i] == &texture)
+					attach_texture(render_target->frame_buffer, GL_COLOR_ATTACHMENT0 + i, texture);
+			}
+			if (render_target->depth == &texture)
+				attach_texture(render_target->frame_buffer, GL_DEPTH_ATTACHMENT, texture);
+		}
+
+		// Deleting the old object unbound it from texture and image units, bind the new one where it was.
+		for (u32 slot = 0; slot < max_tracked_texture_units; ++slot) {
+			if (bound_textures[slot] == &texture) {
+				glActiveTexture(GL_TEXTURE0 + slot);
+				glBindTexture(texture.target, texture.texture);
+			}
+		}
+		for (u32 slot = 0; slot < max_tracked_image_units; ++slot) {
+			auto &binding = bound_images[slot];
+			if (binding.texture == &texture) {
+				binding.mip = min(binding.mip, get_allocated_mip_count(texture) - 1);
+				glBindImageTexture(slot, texture.texture, binding.mip, GL_FALSE, 0, get_access(binding.access), texture.internal_format);
+			}
+		}
+	}
+
 	void bind_render_target(RenderTargetImpl &render_target) {
+		update_window_relative_size(render_target);
+
 		if (&render_target == currently_bound_render_target)
 			return;
 
@@ -1205,13 +2621,209 @@ void main() {
 		glBindFramebuffer(GL_FRAMEBUFFER, render_target.frame_buffer);
 	}
 
+	// Checks fences in order up to `value`. Returns true if all of them are signaled.
+	bool wait_for_fence(u64 value, GLuint64 timeout) {
+		assert(value < next_fence_value, "Fence was not inserted yet");
+		while (signaled_fence_value < value) {
+			auto next = signaled_fence_value + 1;
+			auto &sync = fences[next % max_fences_in_flight];
+			auto status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+				return false;
+			glDeleteSync(sync);
+			sync = 0;
+			signaled_fence_value = next;
+		}
+		return true;
+	}
+
+	// Blocks until at most `count` presented frames are not finished by the GPU.
+	void wait_for_frames_in_flight(u32 count) {
+		if (presented_frame_count <= count)
+			return;
+
+		auto fence = frame_fences[(presented_frame_count - 1 - count) % max_frames_in_flight_limit];
+		if (wait_for_fence(fence.value, 0))
+			return;
+
+		LARGE_INTEGER begin, end, frequency;
+		QueryPerformanceCounter(&begin);
+		wait_for_fence(fence.value, GL_TIMEOUT_IGNORED);
+		QueryPerformanceCounter(&end);
+		QueryPerformanceFrequency(&frequency);
+		cpu_wait_ms += (f32)((end.QuadPart - begin.QuadPart) * 1000.0 / frequency.QuadPart);
+	}
+
+	// Reads timestamps of finished frames without waiting.
+	void read_frame_timings() {
+		if (presented_frame_count - timed_frame_count > max_frames_in_flight_limit) {
+			timed_frame_count = presented_frame_count - max_frames_in_flight_limit;
+			previous_frame_end = 0;
+		}
+
+		while (timed_frame_count < presented_frame_count) {
+			auto &queries = frame_queries[timed_frame_count % max_frames_in_flight_limit];
+			GLuint available = 0;
+			glGetQueryObjectuiv(queries.end, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v(queries.begin, GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries.end, GL_QUERY_RESULT, &end);
+
+			if (previous_frame_end) {
+				frame_timings.gpu_idle_ms  = begin > previous_frame_end ? (begin - previous_frame_end) / 1e6f : 0;
+				frame_timings.gpu_frame_ms = (end - previous_frame_end) / 1e6f;
+			}
+			previous_frame_end = end;
+			++timed_frame_count;
+		}
+	}
+
+	bool is_upload_thread() {
+		return upload_thread && GetCurrentThreadId() == upload_thread_id;
+	}
+
+	// True on threads other than the render and the upload thread.
+	bool is_loading_thread() {
+		if (!upload_thread)
+			return false;
+		auto id = GetCurrentThreadId();
+		return id != render_thread_id && id != upload_thread_id;
+	}
+
+	template <class Pool>
+	auto add_shared(Pool &pool) {
+		AcquireSRWLockExclusive(&pool_lock);
+		auto result = pool.add().pointer;
+		ReleaseSRWLockExclusive(&pool_lock);
+		return result;
+	}
+
+	// Runs `fn` on the upload thread and waits for it. Calls from several threads are served in the order they came.
+	template <class Fn>
+	void run_job_on_upload_thread(Fn &&fn) {
+		UploadJob job = {};
+		job.function = [](void *param) { (*(decltype(&fn))param)(); };
+		job.param = &fn;
+
+		AcquireSRWLockExclusive(&upload_lock);
+		assert(upload_job_tail - upload_job_head < max_pending_uploads);
+		upload_jobs[upload_job_tail++ % max_pending_uploads] = &job;
+		WakeAllConditionVariable(&upload_condition);
+		while (!job.done) {
+			SleepConditionVariableSRW(&upload_condition, &upload_lock, INFINITE, 0);
+		}
+		ReleaseSRWLockExclusive(&upload_lock);
+	}
+
+	// Same as above for functions that return a value.
+	template <class Fn>
+	auto run_on_upload_thread(Fn &&fn) {
+		decltype(fn()) result = {};
+		run_job_on_upload_thread([&] { result = fn(); });
+		return result;
+	}
+
+	static DWORD WINAPI upload_thread_proc(void *param) {
+		auto &state = *(StateGL *)param;
+		wglMakeCurrent(state.upload_dc, state.upload_context);
+		set_pixel_alignment();
+
+		AcquireSRWLockExclusive(&state.upload_lock);
+		while (true) {
+			while (state.upload_job_head == state.upload_job_tail && !state.upload_thread_exit) {
+				SleepConditionVariableSRW(&state.upload_condition, &state.upload_lock, INFINITE, 0);
+			}
+			if (state.upload_thread_exit)
+				break;
+
+			auto job = state.upload_jobs[state.upload_job_head++ % max_pending_uploads];
+			ReleaseSRWLockExclusive(&state.upload_lock);
+
+			job->function(job->param);
+
+			AcquireSRWLockExclusive(&state.upload_lock);
+			job->done = true;
+			WakeAllConditionVariable(&state.upload_condition);
+		}
+		ReleaseSRWLockExclusive(&state.upload_lock);
+
+		wglMakeCurrent(0, 0);
+		return 0;
+	}
+
+	// Called at the end of a create, update or generate function. On the upload thread inserts a fence that
+	// the render thread checks before the resource is used.
+	void finish_upload(GLsync &fence, VertexBufferImpl *vertex_buffer) {
+		if (!is_upload_thread())
+			return;
+
+		auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+
+		AcquireSRWLockExclusive(&upload_lock);
+		if (fence) {
+			// An earlier upload to this resource is not published yet, it is already pending.
+			// Fences are signaled in order, so the new one covers it.
+			glDeleteSync(fence);
+			fence = sync;
+		} else {
+			fence = sync;
+			assert(pending_upload_count < max_pending_uploads, "Too many unpublished uploads");
+			pending_uploads[pending_upload_count++] = {&fence, vertex_buffer};
+		}
+		ReleaseSRWLockExclusive(&upload_lock);
+	}
+
+	// Makes an upload visible to this context. The GPU waits for the fence, the CPU does not.
+	// The upload thread issued the commands itself, so it does not need to wait.
+	void publish(GLsync &fence) {
+		if (!fence || is_upload_thread())
+			return;
+		glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+		glDeleteSync(fence);
+		fence = 0;
+	}
+	void publish(VertexBufferImpl &buffer) {
+		publish(buffer.upload_fence);
+		if (buffer.pending_descriptor_count) {
+			buffer.layout = (VertexLayoutImpl *)create_vertex_layout(Span(buffer.pending_descriptor, (umm)buffer.pending_descriptor_count));
+			buffer.pending_descriptor_count = 0;
+		}
+	}
+
+	// Publishes uploads whose fence is already signaled, so resources are usually ready before their first use.
+	void publish_finished_uploads() {
+		AcquireSRWLockExclusive(&upload_lock);
+		for (u32 i = 0; i < pending_upload_count;) {
+			auto &pending = pending_uploads[i];
+			if (*pending.fence) {
+				auto status = glClientWaitSync(*pending.fence, 0, 0);
+				if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+					++i;
+					continue;
+				}
+			}
+
+			if (pending.vertex_buffer) {
+				publish(*pending.vertex_buffer);
+			} else {
+				publish(*pending.fence);
+			}
+			pending_uploads[i] = pending_uploads[--pending_upload_count];
+		}
+		ReleaseSRWLockExclusive(&upload_lock);
+	}
+
 	GLuint get_sampler(Filtering filtering, Comparison comparison) {
 		if (filtering == Filtering_none)
 			return 0;
 
 		auto &result = samplers.get_or_insert({filtering, comparison});
 		if (!result) {
-			glGenSamplers(1, &result);
+			glCreateSamplers(1, &result);
 			if (comparison != Comparison_none) {
 				glSamplerParameteri(result, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
 				auto func = get_func(comparison);
@@ -1228,22 +2840,188 @@ void main() {
 
 };
 
-State *init(InitInfo init_info) {
-	if (!init_opengl(init_info.window, init_info.debug)) {
-		return 0;
+// Creates a context that shares objects with the current one, with the same version and profile.
+bool start_upload_thread(StateGL &state) {
+	using CreateContextAttribs = HGLRC (WINAPI *)(HDC dc, HGLRC share_context, int const *attributes);
+	auto create_context_attribs = (CreateContextAttribs)wglGetProcAddress("wglCreateContextAttribsARB");
+	if (!create_context_attribs)
+		return false;
+
+	GLint major = 0, minor = 0, profile = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile);
+
+	// From WGL_ARB_create_context.
+	int const attributes[] = {
+		0x2091, major,   // WGL_CONTEXT_MAJOR_VERSION_ARB
+		0x2092, minor,   // WGL_CONTEXT_MINOR_VERSION_ARB
+		0x9126, profile, // WGL_CONTEXT_PROFILE_MASK_ARB
+		0,
+	};
+
+	state.upload_dc = wglGetCurrentDC();
+	state.upload_context = create_context_attribs(state.upload_dc, wglGetCurrentContext(), attributes);
+	if (!state.upload_context)
+		return false;
+
+	state.upload_thread = CreateThread(0, 0, StateGL::upload_thread_proc, &state, 0, &state.upload_thread_id);
+	if (!state.upload_thread) {
+		wglDeleteContext(state.upload_context);
+		state.upload_context = 0;
+		return false;
 	}
+	return true;
+}
 
+// Headless contexts belong to hidden windows that are never shown, which works without a display
+// and with software implementations like Mesa's llvmpipe.
+// Functions are loaded by tl when it creates its context. Later contexts are created like that one,
+// so only the first state has to initialize tl.
+struct ContextTemplate {
+	bool created;
+	int pixel_format;
+	PIXELFORMATDESCRIPTOR pixel_format_descriptor;
+	int attributes[7];
+
+	// Needs a current context to be queried, which a new thread does not have.
+	HGLRC (WINAPI *create_context_attribs)(HDC dc, HGLRC share_context, int const *attributes);
+};
+
+inline ContextTemplate context_template;
+inline SRWLOCK context_template_lock = SRWLOCK_INIT;
+
+// Called with context_template_lock held, after tl created its context.
+void remember_context_template() {
+	auto dc = wglGetCurrentDC();
+	context_template.pixel_format = GetPixelFormat(dc);
+	DescribePixelFormat(dc, context_template.pixel_format, sizeof(context_template.pixel_format_descriptor), &context_template.pixel_format_descriptor);
+
+	GLint major = 0, minor = 0, profile = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile);
+
+	// From WGL_ARB_create_context.
+	int const attributes[] = {
+		0x2091, major,   // WGL_CONTEXT_MAJOR_VERSION_ARB
+		0x2092, minor,   // WGL_CONTEXT_MINOR_VERSION_ARB
+		0x9126, profile, // WGL_CONTEXT_PROFILE_MASK_ARB
+		0,
+	};
+	static_assert(sizeof(attributes) == sizeof(context_template.attributes));
+	memcpy(context_template.attributes, attributes, sizeof(attributes));
+
+	context_template.create_context_attribs = (decltype(context_template.create_context_attribs))wglGetProcAddress("wglCreateContextAttribsARB");
+	context_template.created = true;
+}
+
+bool create_headless_context(StateGL &state, bool debug) {
+	AcquireSRWLockExclusive(&context_template_lock);
+	defer { ReleaseSRWLockExclusive(&context_template_lock); };
+
+	// Predefined class, so nothing has to be registered.
+	state.headless_window = CreateWindowExW(0, L"STATIC", L"tgraphics", WS_POPUP, 0, 0, 1, 1, 0, 0, GetModuleHandleW(0), 0);
+	if (!state.headless_window) {
+		print(Print_error, "tgraphics: failed to create a window for the headless context\n");
+		return false;
+	}
+
+	if (!context_template.created) {
+		if (!init_opengl((NativeWindowHandle)state.headless_window, debug))
+			return false;
+		state.headless_dc = wglGetCurrentDC();
+		state.headless_context = wglGetCurrentContext();
+		state.headless_context_of_tl = true;
+		remember_context_template();
+		return true;
+	}
+
+	// Debug output is set up by tl, so only the first context has it.
+	if (!context_template.create_context_attribs) {
+		print(Print_error, "tgraphics: WGL_ARB_create_context is not supported, only one headless state can exist\n");
+		return false;
+	}
+
+	state.headless_dc = GetDC(state.headless_window);
+	if (!SetPixelFormat(state.headless_dc, context_template.pixel_format, &context_template.pixel_format_descriptor)) {
+		print(Print_error, "tgraphics: failed to set the pixel format of the headless context\n");
+		return false;
+	}
+
+	state.headless_context = context_template.create_context_attribs(state.headless_dc, 0, context_template.attributes);
+	if (!state.headless_context || !wglMakeCurrent(state.headless_dc, state.headless_context)) {
+		print(Print_error, "tgraphics: failed to create the headless context\n");
+		return false;
+	}
+	return true;
+}
+
+// Also cleans up after a failed create_headless_context.
+void destroy_headless_context(StateGL &state) {
+	if (state.headless_context_of_tl)
+		return;
+
+	if (state.headless_context) {
+		if (wglGetCurrentContext() == state.headless_context)
+			wglMakeCurrent(0, 0);
+		wglDeleteContext(state.headless_context);
+	}
+	if (state.headless_dc)
+		ReleaseDC(state.headless_window, state.headless_dc);
+	if (state.headless_window)
+		DestroyWindow(state.headless_window);
+
+	state.headless_context = 0;
+	state.headless_dc = 0;
+	state.headless_window = 0;
+}
+
+bool create_window_context(InitInfo init_info) {
+	AcquireSRWLockExclusive(&context_template_lock);
+	defer { ReleaseSRWLockExclusive(&context_template_lock); };
+
+	if (!init_opengl(init_info.window, init_info.debug))
+		return false;
+	if (!context_template.created)
+		remember_context_template();
+	return true;
+}
+
+State *init(InitInfo init_info) {
 	auto allocator = current_allocator;
 
 	auto state = allocator.allocate<StateGL>();
 	state->allocator = allocator;
 
+	if (init_info.headless) {
+		state->headless = true;
+		if (!create_headless_context(*state, init_info.debug)) {
+			destroy_headless_context(*state);
+			allocator.free(state);
+			return 0;
+		}
+	} else {
+		if (!create_window_context(init_info)) {
+			allocator.free(state);
+			return 0;
+		}
+	}
+
 	((State *)state)->back_buffer        = &state->back_buffer;
 	((State *)state)->back_buffer->color = &state->back_buffer_color;
 	((State *)state)->back_buffer->depth = &state->back_buffer_depth;
+	((State *)state)->back_buffer->colors[0] = &state->back_buffer_color;
+	((State *)state)->back_buffer->color_count = 1;
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
+	set_pixel_alignment();
+
+	state->render_thread_id = GetCurrentThreadId();
+	if (init_info.upload_thread && !start_upload_thread(*state)) {
+		print(Print_warning, "tgraphics: failed to create the upload context, resources will be created on the render thread only\n");
+	}
 
 	//glEnable(GL_DEPTH_TEST);
 	//glDepthFunc(GL_LESS);
@@ -1253,7 +3031,22 @@ State *init(InitInfo init_info) {
 	return state;
 }
 
-void deinit(State *state) {
+void deinit(State *_state) {
+	auto state = (StateGL *)_state;
+	if (state->upload_thread) {
+		AcquireSRWLockExclusive(&state->upload_lock);
+		state->upload_thread_exit = true;
+		WakeAllConditionVariable(&state->upload_condition);
+		ReleaseSRWLockExclusive(&state->upload_lock);
+
+		WaitForSingleObject(state->upload_thread, INFINITE);
+		CloseHandle(state->upload_thread);
+		wglDeleteContext(state->upload_context);
+		state->upload_thread = 0;
+	}
+	if (state->headless) {
+		destroy_headless_context(*state);
+	}
 	/*
 	StaticMaskedBlockList<ShaderImpl, 256> shaders;
 	StaticMaskedBlockList<VertexBufferImpl, 256> vertex_buffers;
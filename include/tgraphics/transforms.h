@@ -0,0 +1,202 @@
+#pragma once
+#include "tgraphics.h"
+#include "parallel.h"
+
+namespace tgraphics {
+
+// Per-instance transforms in structure-of-arrays layout.
+// Rotations are unit quaternions.
+struct InstanceTransforms {
+	f32 const *position_x;
+	f32 const *position_y;
+	f32 const *position_z;
+	f32 const *rotation_x;
+	f32 const *rotation_y;
+	f32 const *rotation_z;
+	f32 const *rotation_w;
+	f32 const *scale_x;
+	f32 const *scale_y;
+	f32 const *scale_z;
+	umm count;
+};
+
+// Matches this std140 block member:
+//
+//   struct InstanceMatrices {
+//       mat4 world;
+//       mat4 mvp;
+//       mat3 normal;
+//   };
+//
+struct alignas(16) InstanceMatrices {
+	m4 world;
+	m4 mvp;
+	v4f normal[3]; // std140 pads every mat3 column to vec4, w is unused
+};
+static_assert(sizeof(InstanceMatrices) == 176);
+
+// Computes world = translation * rotation * scale, mvp = view_projection * world
+// and normal = inverse transpose of the upper 3x3 of world for every instance.
+// `output` must be 16 byte aligned. It is written with non-temporal stores and never read,
+// so it can point straight into mapped GPU memory.
+// When `pool` is not null large batches are split across its threads.
+TGRAPHICS_API void compute_instance_matrices(m4 const &view_projection, InstanceTransforms transforms, InstanceMatrices *output, ThreadPool *pool = 0);
+
+// Maps `constants`, writes matrices for all instances starting at `first_instance` and unmaps it.
+// `constants` must be big enough for `first_instance + transforms.count` matrices.
+inline void compute_instance_matrices(State *state, ShaderConstants *constants, u32 first_instance, m4 const &view_projection, InstanceTransforms transforms, ThreadPool *pool = 0) {
+	auto mapped = (InstanceMatrices *)state->map_shader_constants(constants, Access_write);
+	compute_instance_matrices(view_projection, transforms, mapped + first_instance, pool);
+	state->unmap_shader_constants(constants);
+}
+
+// Same as above, but writes into a vertex buffer, which is not limited by the uniform block size.
+// Bind it with `set_vertex_buffers` and a vertex layout with a per instance step rate.
+// `buffer` must be big enough for `first_instance + transforms.count` matrices.
+inline void compute_instance_matrices(State *state, VertexBuffer *buffer, u32 first_instance, m4 const &view_projection, InstanceTransforms transforms, ThreadPool *pool = 0) {
+	auto mapped = (InstanceMatrices *)state->map_vertex_buffer(buffer, Access_write);
+	compute_instance_matrices(view_projection, transforms, mapped + first_instance, pool);
+	state->unmap_vertex_buffer(buffer);
+}
+
+}
+
+#ifdef TGRAPHICS_IMPL
+
+#include <immintrin.h>
+
+namespace tgraphics {
+
+namespace transforms {
+
+// Instances per chunk when splitting across threads.
+inline constexpr umm min_instances_per_chunk = 2048;
+
+inline constexpr u32 lane_count = 4;
+
+// Loads up to four consecutive values, filling missing lanes with `pad`.
+inline __m128 load_lanes(f32 const *source, umm index, u32 lanes, f32 pad) {
+	if (lanes == lane_count)
+		return _mm_loadu_ps(source + index);
+
+	f32 values[lane_count] = {pad, pad, pad, pad};
+	for (u32 lane = 0; lane < lanes; ++lane) {
+		values[lane] = source[index + lane];
+	}
+	return _mm_loadu_ps(values);
+}
+
+// Transposes one matrix column of four instances and stores it into each instance.
+// `offset` is the byte offset of the column inside InstanceMatrices.
+inline void store_column(InstanceMatrices *output, u32 lanes, umm offset, __m128 x, __m128 y, __m128 z, __m128 w) {
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	__m128 columns[lane_count] = {x, y, z, w};
+	for (u32 lane = 0; lane < lanes; ++lane) {
+		_mm_stream_ps((f32 *)((u8 *)(output + lane) + offset), columns[lane]);
+	}
+}
+
+void compute_range(m4 const &view_projection, InstanceTransforms t, umm begin, umm end, InstanceMatrices *output) {
+	// vp[column][row]
+	__m128 vp[4][4];
+	for (u32 column = 0; column < 4; ++column) {
+		for (u32 row = 0; row < 4; ++row) {
+			vp[column][row] = _mm_set1_ps(view_projection.s[column * 4 + row]);
+		}
+	}
+
+	auto zero = _mm_setzero_ps();
+	auto one  = _mm_set1_ps(1.0f);
+	auto two  = _mm_set1_ps(2.0f);
+
+	for (umm i = begin; i < end; i += lane_count) {
+		u32 lanes = (u32)min<umm>(lane_count, end - i);
+
+		auto px = load_lanes(t.position_x, i, lanes, 0);
+		auto py = load_lanes(t.position_y, i, lanes, 0);
+		auto pz = load_lanes(t.position_z, i, lanes, 0);
+		auto qx = load_lanes(t.rotation_x, i, lanes, 0);
+		auto qy = load_lanes(t.rotation_y, i, lanes, 0);
+		auto qz = load_lanes(t.rotation_z, i, lanes, 0);
+		auto qw = load_lanes(t.rotation_w, i, lanes, 1);
+		auto sx = load_lanes(t.scale_x,    i, lanes, 1);
+		auto sy = load_lanes(t.scale_y,    i, lanes, 1);
+		auto sz = load_lanes(t.scale_z,    i, lanes, 1);
+
+		auto xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+		auto xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+		auto wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+		// Rotation matrix, r[column][row]
+		__m128 r[3][3];
+		r[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+		r[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+		r[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+		r[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+		r[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+		r[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+		r[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+		r[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+		r[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+		__m128 scale[3]         = {sx, sy, sz};
+		__m128 inverse_scale[3] = {_mm_div_ps(one, sx), _mm_div_ps(one, sy), _mm_div_ps(one, sz)};
+
+		// World matrix, w[column][row]. Last row is (0, 0, 0, 1).
+		__m128 w[4][3];
+		for (u32 column = 0; column < 3; ++column) {
+			for (u32 row = 0; row < 3; ++row) {
+				w[column][row] = _mm_mul_ps(r[column][row], scale[column]);
+			}
+		}
+		w[3][0] = px;
+		w[3][1] = py;
+		w[3][2] = pz;
+
+		auto out = output + (i - begin);
+
+		for (u32 column = 0; column < 4; ++column) {
+			store_column(out, lanes, offsetof(InstanceMatrices, world) + column * sizeof(v4f), w[column][0], w[column][1], w[column][2], column == 3 ? one : zero);
+		}
+
+		for (u32 column = 0; column < 4; ++column) {
+			__m128 m[4];
+			for (u32 row = 0; row < 4; ++row) {
+				m[row] = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(vp[0][row], w[column][0]), _mm_mul_ps(vp[1][row], w[column][1])),
+					_mm_mul_ps(vp[2][row], w[column][2])
+				);
+				if (column == 3) {
+					m[row] = _mm_add_ps(m[row], vp[3][row]);
+				}
+			}
+			store_column(out, lanes, offsetof(InstanceMatrices, mvp) + column * sizeof(v4f), m[0], m[1], m[2], m[3]);
+		}
+
+		// Inverse transpose of rotation * scale is rotation * inverse scale.
+		for (u32 column = 0; column < 3; ++column) {
+			store_column(out, lanes, offsetof(InstanceMatrices, normal) + column * sizeof(v4f),
+				_mm_mul_ps(r[column][0], inverse_scale[column]),
+				_mm_mul_ps(r[column][1], inverse_scale[column]),
+				_mm_mul_ps(r[column][2], inverse_scale[column]),
+				zero
+			);
+		}
+	}
+
+	// Make the non-temporal stores visible before the buffer is unmapped or read by another thread.
+	_mm_sfence();
+}
+
+}
+
+void compute_instance_matrices(m4 const &view_projection, InstanceTransforms transforms, InstanceMatrices *output, ThreadPool *pool) {
+	assert(((umm)output & 15) == 0, "compute_instance_matrices: output must be 16 byte aligned");
+	parallel_for(pool, transforms.count, transforms::min_instances_per_chunk, [&](u32 chunk_index, umm begin, umm end) {
+		transforms::compute_range(view_projection, transforms, begin, end, output + begin);
+	});
+}
+
+}
+
+#endif
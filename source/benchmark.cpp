@@ -0,0 +1,551 @@
+#include <tl/common.h>
+#include <tl/file.h>
+#include <tl/console.h>
+#include <tl/main.h>
+#include <tgraphics/tgraphics.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+using namespace tl;
+using namespace tgraphics;
+
+// Usage: benchmark [--filter text] [--samples count] [--output file.json]
+//
+// Times the api functions one by one and a few larger scenarios, then writes the results as JSON.
+// Every sample runs a benchmark a fixed number of times and waits for the GPU, times are per call in microseconds.
+//
+// The state is headless and renders only into offscreen targets, so no display has to be visible.
+// To measure the software path, run it with Mesa's opengl32.dll (llvmpipe) next to the executable.
+//
+// Functions that create resources leak them, there is no api to free them, so they run fewer samples.
+// Not measured on their own: set_vsync, set_frame_pacing, on_window_resize and create_window_render_target
+// depend on the window system, init_colored_rectangle_shader runs as part of the draw_rectangle scenario.
+
+inline constexpr u32 target_size = 1024;
+inline constexpr u32 large_texture_size = 2048;
+inline constexpr u32 default_sample_count = 30;
+
+struct Benchmark {
+	char const *group;
+	char const *name;
+	u32 iterations;           // calls per sample
+	void (*run)(u32 iteration);
+	void (*setup)() = 0;      // before every sample, not timed
+	u64 bytes = 0;            // moved by one call, reported as throughput
+	u32 sample_count = 0;     // 0 means the --samples value
+};
+
+State *state;
+
+Shader *shaders[2];
+ShaderConstants *constants;
+VertexLayout *layouts[2];
+VertexBuffer *vertex_buffers[2];
+VertexBuffer *large_vertex_buffer;
+IndexBuffer *index_buffer;
+IndexBuffer *large_index_buffer;
+Texture2D *small_textures[2];
+Texture2D *large_texture;
+Texture2D *mipmapped_texture;
+Texture2D *compute_texture;
+Texture2D *resizable_texture;
+Texture2DArray *texture_array;
+TextureCube *texture_cube;
+TextureCubeArray *texture_cube_array;
+RenderTarget *targets[2];
+RenderTarget *multisampled_target;
+ComputeShader *compute_shader;
+ComputeBuffer *compute_buffer;
+ComputeBuffer *indirect_arguments;
+Readback *readback;
+
+List<u8> upload_data;     // large enough for the biggest upload or read
+List<u8> large_png;       // target_size squared
+List<u8> small_png;       // 64 by 64
+
+inline constexpr u32 small_upload_size = 256;
+inline constexpr u32 large_upload_size = 4 * 1024 * 1024;
+inline constexpr u32 compute_buffer_size = 1024 * 1024;
+
+Span<utf8> const shader_source = u8R"(
+layout(binding = 0) uniform Constants {
+	vec4 color;
+};
+
+#ifdef VERTEX_SHADER
+layout(location = 0) in vec2 position;
+void main() {
+	gl_Position = vec4(position, 0, 1);
+}
+#endif
+
+#ifdef FRAGMENT_SHADER
+layout(binding = 0) uniform sampler2D albedo;
+out vec4 fragment_color;
+void main() {
+	fragment_color = color * texture(albedo, gl_FragCoord.xy / 64);
+}
+#endif
+)"s;
+
+// Every compiled variant differs in a constant, so the driver can not reuse an earlier program.
+char const shader_compile_format[] = R"(
+layout(binding = 0) uniform Constants {
+	vec4 color;
+};
+
+#ifdef VERTEX_SHADER
+layout(location = 0) in vec2 position;
+void main() {
+	gl_Position = vec4(position * %u.0 / 1000.0, 0, 1);
+}
+#endif
+
+#ifdef FRAGMENT_SHADER
+layout(binding = 0) uniform sampler2D albedo;
+out vec4 fragment_color;
+void main() {
+	vec4 sum = vec4(0);
+	for (int i = 0; i < 8; ++i)
+		sum += texture(albedo, gl_FragCoord.xy / float(64 + i));
+	fragment_color = color * sum / 8.0 + vec4(%u.0 / 1000.0);
+}
+#endif
+)";
+
+Span<utf8> const compute_shader_source = u8R"(
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 0) buffer Values {
+	uint values[];
+};
+
+void main() {
+	values[gl_GlobalInvocationID.x] = values[gl_GlobalInvocationID.x] * 1664525u + 1013904223u;
+}
+)"s;
+
+// Microseconds per call.
+struct Result {
+	Benchmark const *benchmark;
+	u32 sample_count;
+	f64 min, p50, p90, p99, max, mean;
+};
+
+using Clock = std::chrono::steady_clock;
+
+f64 get_microseconds(Clock::time_point begin, Clock::time_point end) {
+	return std::chrono::duration<f64, std::micro>(end - begin).count();
+}
+
+void append_to_list(void *context, void *data, int size) {
+	auto &list = *(List<u8> *)context;
+	auto offset = list.count;
+	list.resize(offset + size);
+	memcpy(list.data + offset, data, size);
+}
+
+// Gradient with some noise, so the encoded image compresses like a photo rather than a flat color.
+List<u8> encode_test_png(u32 size) {
+	List<u8> pixels;
+	defer { free(pixels); };
+	pixels.resize(size * size * 4);
+	u32 random = 0x12345678;
+	for (u32 y = 0; y < size; ++y) {
+		for (u32 x = 0; x < size; ++x) {
+			random = random * 1664525 + 1013904223;
+			auto pixel = pixels.data + (y * size + x) * 4;
+			pixel[0] = (u8)(x * 255 / size + (random >> 28));
+			pixel[1] = (u8)(y * 255 / size + ((random >> 24) & 0xf));
+			pixel[2] = (u8)((x ^ y) + ((random >> 20) & 0xf));
+			pixel[3] = 255;
+		}
+	}
+
+	List<u8> result;
+	stbi_write_png_to_func(append_to_list, &result, size, size, 4, pixels.data, size * 4);
+	return result;
+}
+
+void create_resources() {
+	upload_data.resize(large_texture_size * large_texture_size * 4);
+	for (umm i = 0; i < upload_data.count; ++i)
+		upload_data[i] = (u8)(i * 7);
+
+	large_png = encode_test_png(target_size);
+	small_png = encode_test_png(64);
+
+	static ElementType position_elements[] = {Element_f32x2};
+	Span<ElementType> positions = {position_elements, 1};
+
+	// A small quad, so draws measure the submission rather than the fill rate.
+	v2f quad[] = {{-1, -1}, {-0.9f, -1}, {-1, -0.9f}, {-0.9f, -0.9f}};
+	u16 quad_indices[] = {0, 1, 2, 2, 1, 3};
+
+	shaders[0] = state->create_shader(shader_source);
+	shaders[1] = state->create_shader(shader_source);
+	constants = state->create_shader_constants(sizeof(v4f) * 4);
+	state->update_shader_constants(constants, v4f{1, 1, 1, 1});
+
+	layouts[0] = state->create_vertex_layout(positions);
+	VertexStream instanced_stream = {.elements = positions, .step_rate = 1};
+	layouts[1] = state->create_vertex_layout(Span(&instanced_stream, 1));
+
+	vertex_buffers[0] = state->create_vertex_buffer(as_bytes(Span(quad, 4)), positions);
+	vertex_buffers[1] = state->create_vertex_buffer(as_bytes(Span(quad, 4)), positions);
+	large_vertex_buffer = state->create_vertex_buffer(Span(upload_data.data, (umm)large_upload_size), positions);
+	index_buffer = state->create_index_buffer(Span(quad_indices, 6));
+	large_index_buffer = state->create_index_buffer(Span(upload_data.data, (umm)large_upload_size), 2);
+
+	small_textures[0] = state->create_texture_2d(64, 64, upload_data.data, Format_rgba_u8n);
+	small_textures[1] = state->create_texture_2d(64, 64, upload_data.data, Format_rgba_u8n);
+	large_texture = state->create_texture_2d(large_texture_size, large_texture_size, upload_data.data, Format_rgba_u8n);
+	mipmapped_texture = state->create_texture_2d_mipmapped(target_size, target_size, ~0u, Format_rgba_u8n);
+	compute_texture = state->create_texture_2d(256, 256, 0, Format_rgba_u8n);
+	resizable_texture = state->create_texture_2d(256, 256, 0, Format_rgba_u8n);
+	texture_array = state->create_texture_2d_array({256, 256}, 16, Format_rgba_u8n);
+
+	void *faces[6];
+	for (auto &face : faces)
+		face = upload_data.data;
+	texture_cube = state->create_texture_cube(64, faces, Format_rgba_u8n);
+	texture_cube_array = state->create_texture_cube_array(64, 4, Format_rgba_u8n);
+
+	for (auto &target : targets) {
+		target = state->create_render_target(
+			state->create_texture_2d(target_size, target_size, 0, Format_rgba_u8n),
+			state->create_texture_2d(target_size, target_size, 0, Format_depth)
+		);
+	}
+	multisampled_target = state->create_render_target(
+		state->create_texture_2d_multisampled(target_size, target_size, Format_rgba_u8n, 4),
+		state->create_renderbuffer(target_size, target_size, Format_depth, 4)
+	);
+
+	compute_shader = state->create_compute_shader(compute_shader_source);
+	compute_buffer = state->create_compute_buffer(compute_buffer_size);
+
+	// One indexed draw of the quad followed by a dispatch of one group.
+	u32 arguments[] = {6, 1, 0, 0, 0, 1, 1, 1};
+	indirect_arguments = state->create_compute_buffer(sizeof(arguments));
+	state->update_compute_buffer(indirect_arguments, arguments, 0, sizeof(arguments));
+
+	readback = state->create_readback(target_size * target_size * 4);
+
+	state->wait(state->insert_fence());
+}
+
+void bind_draw_state() {
+	state->set_render_target(targets[0]);
+	state->set_viewport(target_size, target_size);
+	state->set_shader(shaders[0]);
+	state->set_shader_constants(constants, 0);
+	state->set_texture_2d(small_textures[0], 0);
+	state->set_sampler(Filtering_linear, 0);
+	state->set_vertex_buffer(vertex_buffers[0]);
+	state->set_index_buffer(index_buffer);
+	state->set_topology(Topology_triangle_list);
+	state->disable_blend();
+}
+
+void bind_compute_state() {
+	state->set_compute_shader(compute_shader);
+	state->set_compute_buffer(compute_buffer, 0);
+}
+
+Benchmark benchmarks[] = {
+	// State changes. Values alternate so no call is skipped as redundant.
+	{"state", "set_blend",        1000, [](u32 i) { state->set_blend(BlendFunction_add, i & 1 ? Blend_one : Blend_source_alpha, Blend_one_minus_source_alpha); }},
+	{"state", "disable_blend",    1000, [](u32 i) { state->disable_blend(); }},
+	{"state", "set_topology",     1000, [](u32 i) { state->set_topology(i & 1 ? Topology_line_list : Topology_triangle_list); }},
+	{"state", "set_scissor",      1000, [](u32 i) { state->set_scissor(0, 0, 64 + (i & 1), 64); }},
+	{"state", "disable_scissor",  1000, [](u32 i) { state->disable_scissor(); }},
+	{"state", "set_cull",         1000, [](u32 i) { state->set_cull(i & 1 ? Cull_front : Cull_back); }},
+	{"state", "set_viewport",     1000, [](u32 i) { state->set_viewport(0, 0, target_size - (i & 1), target_size); }},
+	{"state", "enable_depth_clip",  1000, [](u32 i) { state->enable_depth_clip(); }},
+	{"state", "disable_depth_clip", 1000, [](u32 i) { state->disable_depth_clip(); }},
+	{"state", "set_rasterizer",   1000, [](u32 i) { state->set_rasterizer(RasterizerState{}.set_depth_test(i & 1).set_depth_write(i & 1).set_depth_func(Comparison_less)); }},
+	{"state", "get_rasterizer",   1000, [](u32 i) { state->get_rasterizer(); }},
+	{"state", "calculate_perspective_matrices", 1000, [](u32 i) { state->calculate_perspective_matrices({0, 0, (f32)i}, {0, 0.1f, 0}, 16.0f / 9, 1.5f, 0.1f, 1000); }},
+
+	// Binds.
+	{"bind", "set_shader",            1000, [](u32 i) { state->set_shader(shaders[i & 1]); }},
+	{"bind", "set_vertex_layout",     1000, [](u32 i) { state->set_vertex_layout(layouts[i & 1]); }},
+	{"bind", "set_vertex_buffer",     1000, [](u32 i) { state->set_vertex_buffer(vertex_buffers[i & 1]); }},
+	{"bind", "set_vertex_buffers",    1000, [](u32 i) { state->set_vertex_buffers(0, vertex_buffers[i & 1], 0, sizeof(v2f)); }, [] { state->set_vertex_layout(layouts[0]); }},
+	{"bind", "set_index_buffer",      1000, [](u32 i) { state->set_index_buffer(i & 1 ? index_buffer : large_index_buffer); }},
+	{"bind", "set_texture_2d",        1000, [](u32 i) { state->set_texture_2d(small_textures[i & 1], 0); }},
+	{"bind", "set_texture_cube",      1000, [](u32 i) { state->set_texture_cube(texture_cube, i & 7); }},
+	{"bind", "set_texture_2d_array",  1000, [](u32 i) { state->set_texture_2d_array(texture_array, i & 7); }},
+	{"bind", "set_texture_cube_array",1000, [](u32 i) { state->set_texture_cube_array(texture_cube_array, i & 7); }},
+	{"bind", "set_sampler",           1000, [](u32 i) { state->set_sampler(i & 1 ? Filtering_nearest : Filtering_linear, 0); }},
+	{"bind", "set_shader_constants",  1000, [](u32 i) { state->set_shader_constants(constants, i & 7); }},
+	{"bind", "set_render_target",     1000, [](u32 i) { state->set_render_target(targets[i & 1]); }},
+	{"bind", "set_compute_shader",    1000, [](u32 i) { state->set_compute_shader(compute_shader); }},
+	{"bind", "set_compute_buffer",    1000, [](u32 i) { state->set_compute_buffer(compute_buffer, i & 7); }},
+	{"bind", "set_compute_texture",   1000, [](u32 i) { state->set_compute_texture(compute_texture, i & 7, 0, Access_write); }},
+
+	// Shader constants.
+	{"constants", "update_shader_constants_64b", 1000, [](u32 i) {
+		v4f values[4] = {{(f32)i, 0, 0, 1}};
+		state->update_shader_constants(constants, values, 0, sizeof(values));
+	}, 0, 64},
+	{"constants", "map_shader_constants_64b", 1000, [](u32 i) {
+		auto values = (v4f *)state->map_shader_constants(constants, Access_write);
+		for (u32 j = 0; j < 4; ++j)
+			values[j] = {(f32)i, 0, 0, 1};
+		state->unmap_shader_constants(constants);
+	}, 0, 64},
+
+	// Uploads.
+	{"upload", "update_vertex_buffer_256b", 1000, [](u32 i) { state->update_vertex_buffer(large_vertex_buffer, Span(upload_data.data, (umm)small_upload_size)); }, 0, small_upload_size},
+	{"upload", "update_vertex_buffer_4mb",    20, [](u32 i) { state->update_vertex_buffer(large_vertex_buffer, Span(upload_data.data, (umm)large_upload_size)); }, 0, large_upload_size},
+	{"upload", "update_index_buffer_256b",  1000, [](u32 i) { state->update_index_buffer(large_index_buffer, Span(upload_data.data, (umm)small_upload_size), 0); }, 0, small_upload_size},
+	{"upload", "update_index_buffer_4mb",     20, [](u32 i) { state->update_index_buffer(large_index_buffer, Span(upload_data.data, (umm)large_upload_size), 0); }, 0, large_upload_size},
+	{"upload", "update_compute_buffer_256b",1000, [](u32 i) { state->update_compute_buffer(compute_buffer, upload_data.data, 0, small_upload_size); }, 0, small_upload_size},
+	{"upload", "update_compute_buffer_1mb",   20, [](u32 i) { state->update_compute_buffer(compute_buffer, upload_data.data, 0, compute_buffer_size); }, 0, compute_buffer_size},
+	{"upload", "update_texture_2d_64",       500, [](u32 i) { state->update_texture_2d(small_textures[i & 1], 64, 64, upload_data.data); }, 0, 64 * 64 * 4},
+	{"upload", "update_texture_2d_2048",       5, [](u32 i) { state->update_texture_2d(large_texture, large_texture_size, large_texture_size, upload_data.data); }, 0, large_texture_size * large_texture_size * 4},
+	{"upload", "update_texture_2d_region_256",100, [](u32 i) { state->update_texture_2d_region(large_texture, (i & 7) * 256, 0, 256, 256, upload_data.data); }, 0, 256 * 256 * 4},
+	{"upload", "update_texture_2d_array_layer_256", 100, [](u32 i) { state->update_texture_2d_array_layer(texture_array, i & 15, upload_data.data); }, 0, 256 * 256 * 4},
+	{"upload", "update_texture_cube_array_layer_64", 100, [](u32 i) {
+		void *faces[6];
+		for (auto &face : faces)
+			face = upload_data.data;
+		state->update_texture_cube_array_layer(texture_cube_array, i & 3, faces);
+	}, 0, 6 * 64 * 64 * 4},
+
+	// Resource creation.
+	{"create", "create_vertex_buffer_256b",  20, [](u32 i) { state->create_vertex_buffer(Span(upload_data.data, (umm)small_upload_size), {}); }, 0, small_upload_size, 10},
+	{"create", "create_index_buffer_256b",   20, [](u32 i) { state->create_index_buffer(Span(upload_data.data, (umm)small_upload_size), 2); }, 0, small_upload_size, 10},
+	{"create", "create_vertex_layout",     1000, [](u32 i) {
+		// Cached by the backend after the first call.
+		static ElementType elements[][1] = {{Element_f32x2}, {Element_f32x4}};
+		state->create_vertex_layout(Span(elements[i & 1], 1));
+	}},
+	{"create", "create_texture_2d_64",       20, [](u32 i) { state->create_texture_2d(64, 64, upload_data.data, Format_rgba_u8n); }, 0, 64 * 64 * 4, 10},
+	{"create", "create_texture_2d_mipmapped_256", 20, [](u32 i) { state->create_texture_2d_mipmapped(256, 256, ~0u, Format_rgba_u8n); }, 0, 0, 10},
+	{"create", "create_texture_2d_multisampled_256", 20, [](u32 i) { state->create_texture_2d_multisampled(256, 256, Format_rgba_u8n, 4); }, 0, 0, 10},
+	{"create", "create_renderbuffer_256",    20, [](u32 i) { state->create_renderbuffer(256, 256, Format_depth, 4); }, 0, 0, 10},
+	{"create", "create_texture_cube_64",     20, [](u32 i) {
+		void *faces[6];
+		for (auto &face : faces)
+			face = upload_data.data;
+		state->create_texture_cube(64, faces, Format_rgba_u8n);
+	}, 0, 6 * 64 * 64 * 4, 10},
+	{"create", "create_texture_2d_array_256x4", 20, [](u32 i) { state->create_texture_2d_array(256, 256, 4, 1, Format_rgba_u8n); }, 0, 0, 10},
+	{"create", "create_texture_cube_array_64x4", 20, [](u32 i) { state->create_texture_cube_array(64, 4, Format_rgba_u8n); }, 0, 0, 10},
+	{"create", "create_render_target",       20, [](u32 i) { state->create_render_target(small_textures[0], 0); }, 0, 0, 10},
+	{"create", "create_render_target_with_attachments", 20, [](u32 i) {
+		Texture2D *colors[] = {small_textures[0], small_textures[1]};
+		state->create_render_target_with_attachments(Span(colors, 2), 0);
+	}, 0, 0, 10},
+	{"create", "create_shader_constants",    20, [](u32 i) { state->create_shader_constants(256); }, 0, 0, 10},
+	{"create", "create_compute_buffer_64kb", 20, [](u32 i) { state->create_compute_buffer(64 * 1024); }, 0, 0, 10},
+	{"create", "create_readback_64kb",       20, [](u32 i) { state->create_readback(64 * 1024); }, 0, 0, 10},
+	{"create", "create_compute_shader",       5, [](u32 i) { state->create_compute_shader(compute_shader_source); }, 0, 0, 5},
+	{"create", "resize_texture_2d",          20, [](u32 i) { state->resize_texture_2d(resizable_texture, 256 + (i & 1) * 256, 256); }},
+
+	// Draws of a small quad, so the numbers are mostly submission cost.
+	{"draw", "draw",                  1000, [](u32 i) { state->draw(3, 0); }, bind_draw_state},
+	{"draw", "draw_instanced_100",    1000, [](u32 i) { state->draw_instanced(3, 100, 0, 0); }, bind_draw_state},
+	{"draw", "draw_indexed",          1000, [](u32 i) { state->draw_indexed(6, 0, 0); }, bind_draw_state},
+	{"draw", "draw_indexed_indirect", 1000, [](u32 i) { state->draw_indexed_indirect(indirect_arguments, 0, 1, 5 * sizeof(u32)); }, bind_draw_state},
+	{"draw", "clear_1024",             100, [](u32 i) { state->clear(targets[0], ClearFlags_color | ClearFlags_depth, {(f32)(i & 1), 0, 0, 1}, 1); }},
+	{"draw", "discard_1024",           100, [](u32 i) { state->discard(targets[0], ClearFlags_color | ClearFlags_depth); }},
+	{"draw", "resolve_1024",            20, [](u32 i) { state->resolve(multisampled_target, targets[0]); }},
+	{"draw", "generate_mipmaps_2d_1024",  20, [](u32 i) { state->generate_mipmaps_2d(mipmapped_texture); }},
+	{"draw", "generate_mipmaps_2d_array_256x16", 20, [](u32 i) { state->generate_mipmaps_2d_array(texture_array); }},
+	{"draw", "generate_mipmaps_cube_64",  20, [](u32 i) { state->generate_mipmaps_cube(texture_cube, {}); }},
+	{"draw", "generate_mipmaps_cube_array_64x4", 20, [](u32 i) { state->generate_mipmaps_cube_array(texture_cube_array); }},
+
+	// Compute.
+	{"compute", "dispatch_compute_shader_16k", 1000, [](u32 i) { state->dispatch_compute_shader(compute_buffer_size / sizeof(u32) / 64 / 16, 1, 1); }, bind_compute_state},
+	{"compute", "dispatch_compute_indirect",   1000, [](u32 i) { state->dispatch_compute_indirect(indirect_arguments, 5 * sizeof(u32)); }, bind_compute_state},
+	{"compute", "memory_barrier",              1000, [](u32 i) { state->memory_barrier(Barrier_compute_buffer); }},
+
+	// Readbacks. All of them wait for the GPU.
+	{"readback", "read_texture_2d_1024", 10, [](u32 i) { state->read_texture_2d(targets[0]->color, Span(upload_data.data, (umm)target_size * target_size * 4)); }, 0, target_size * target_size * 4},
+	{"readback", "read_texture_2d_async_1024", 10, [](u32 i) {
+		state->read_texture_2d_async(targets[0]->color, 0, readback);
+		state->map_readback(readback);
+		state->unmap_readback(readback);
+	}, 0, target_size * target_size * 4},
+	{"readback", "is_readback_ready", 1000, [](u32 i) { state->is_readback_ready(readback); }},
+	{"readback", "read_compute_buffer_1mb", 10, [](u32 i) { state->read_compute_buffer(compute_buffer, upload_data.data); }, 0, compute_buffer_size},
+
+	// Synchronization.
+	{"sync", "insert_fence",      1000, [](u32 i) { state->insert_fence(); }},
+	{"sync", "is_signaled",       1000, [](u32 i) { state->is_signaled(state->insert_fence()); }},
+	{"sync", "wait",               100, [](u32 i) { state->wait(state->insert_fence()); }},
+	{"sync", "begin_frame",        100, [](u32 i) { state->begin_frame(); }},
+	{"sync", "get_frame_timings", 1000, [](u32 i) { state->get_frame_timings(); }},
+	{"sync", "present",            100, [](u32 i) { state->present(); }},
+
+	// Scenarios.
+	{"scenario", "draw_rectangle_10k", 10'000, [](u32 i) {
+		state->draw_rectangle((i % 128) * 8, (i / 128 % 128) * 8, 8, 8, {(f32)(i & 1), 0.5f, 0.5f, 1});
+	}, [] {
+		state->set_render_target(targets[0]);
+		state->set_vertex_buffer(0);
+		state->disable_blend();
+	}, 0, 10},
+	{"scenario", "load_texture_2d_1k", 1000, [](u32 i) { state->load_texture_2d(small_png); }, 0, 64 * 64 * 4, 5},
+	{"scenario", "create_shader_200", 200, [](u32 i) {
+		static u32 variant = 0;
+		char source[2048];
+		auto length = snprintf(source, sizeof(source), shader_compile_format, variant, variant);
+		++variant;
+		state->create_shader(Span((utf8 *)source, (umm)length));
+	}, 0, 0, 3},
+	{"scenario", "load_pixels_1024", 10, [](u32 i) {
+		auto pixels = load_pixels(large_png);
+		pixels.free(pixels.data);
+	}, 0, target_size * target_size * 4},
+};
+
+int compare_f64(void const *a, void const *b) {
+	auto x = *(f64 const *)a;
+	auto y = *(f64 const *)b;
+	return x < y ? -1 : x > y;
+}
+
+// Nearest rank: the smallest sample that at least `fraction` of the samples do not exceed.
+f64 get_percentile(Span<f64> sorted, f64 fraction) {
+	auto rank = (s64)ceil(fraction * sorted.count);
+	return sorted[(umm)clamp(rank - 1, (s64)0, (s64)sorted.count - 1)];
+}
+
+Result run_benchmark(Benchmark const &benchmark, u32 sample_count) {
+	if (benchmark.sample_count)
+		sample_count = min(sample_count, benchmark.sample_count);
+
+	List<f64> samples;
+	defer { free(samples); };
+
+	// The first sample warms up caches and the driver and is not counted.
+	for (u32 sample_index = 0; sample_index <= sample_count; ++sample_index) {
+		if (benchmark.setup)
+			benchmark.setup();
+		state->wait(state->insert_fence());
+
+		auto begin = Clock::now();
+		for (u32 i = 0; i < benchmark.iterations; ++i)
+			benchmark.run(i);
+		state->wait(state->insert_fence());
+		auto end = Clock::now();
+
+		if (sample_index)
+			samples.add(get_microseconds(begin, end) / benchmark.iterations);
+	}
+
+	qsort(samples.data, samples.count, sizeof(f64), compare_f64);
+
+	Result result = {
+		.benchmark = &benchmark,
+		.sample_count = (u32)samples.count,
+		.min = samples[0],
+		.p50 = get_percentile(samples, 0.5),
+		.p90 = get_percentile(samples, 0.9),
+		.p99 = get_percentile(samples, 0.99),
+		.max = samples[samples.count - 1],
+	};
+	for (auto sample : samples)
+		result.mean += sample;
+	result.mean /= samples.count;
+	return result;
+}
+
+void write_json_string(FILE *file, char const *string) {
+	fputc('"', file);
+	for (auto c = string; *c; ++c) {
+		if (*c == '"' || *c == '\\')
+			fprintf(file, "\\%c", *c);
+		else if ((u8)*c < 0x20)
+			fprintf(file, "\\u%04x", *c);
+		else
+			fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+void write_json(FILE *file, Span<Result> results, u32 sample_count) {
+	fprintf(file, "{\n\t\"version\": 1,\n\t\"renderer\": ");
+	write_json_string(file, (char const *)glGetString(GL_RENDERER));
+	fprintf(file, ",\n\t\"gl_version\": ");
+	write_json_string(file, (char const *)glGetString(GL_VERSION));
+	fprintf(file, ",\n\t\"samples\": %u,\n\t\"unit\": \"us\",\n\t\"benchmarks\": [\n", sample_count);
+	for (umm i = 0; i < results.count; ++i) {
+		auto &result = results[i];
+		auto &benchmark = *result.benchmark;
+		fprintf(file, "\t\t{\"group\": \"%s\", \"name\": \"%s\", \"iterations\": %u, \"samples\": %u, "
+			"\"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f",
+			benchmark.group, benchmark.name, benchmark.iterations, result.sample_count,
+			result.min, result.p50, result.p90, result.p99, result.max, result.mean);
+		if (benchmark.bytes)
+			fprintf(file, ", \"p50_mb_per_s\": %.1f", benchmark.bytes / result.p50);
+		fprintf(file, "}%s\n", i + 1 < results.count ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+}
+
+s32 tl_main(Span<Span<utf8>> args) {
+	current_printer = console_printer;
+
+	char const *filter = 0;
+	char const *output_path = 0;
+	u32 sample_count = default_sample_count;
+	for (umm i = 1; i < args.count; ++i) {
+		if (i + 1 < args.count && args[i] == u8"--filter"s) {
+			filter = (char const *)args[++i].data;
+		} else if (i + 1 < args.count && args[i] == u8"--samples"s) {
+			sample_count = max(atoi((char const *)args[++i].data), 1);
+		} else if (i + 1 < args.count && args[i] == u8"--output"s) {
+			output_path = (char const *)args[++i].data;
+		} else {
+			print("Usage: benchmark [--filter text] [--samples count] [--output file.json]\n");
+			return 1;
+		}
+	}
+
+	state = init(GraphicsApi_opengl, {.headless = true});
+	if (!state)
+		return 1;
+
+	create_resources();
+
+	List<Result> results;
+	defer { free(results); };
+
+	for (auto &benchmark : benchmarks) {
+		char full_name[256];
+		snprintf(full_name, sizeof(full_name), "%s/%s", benchmark.group, benchmark.name);
+		if (filter && !strstr(full_name, filter))
+			continue;
+
+		if (output_path)
+			print("{}\n", Span((utf8 *)full_name, strlen(full_name)));
+		results.add(run_benchmark(benchmark, sample_count));
+	}
+
+	auto file = output_path ? fopen(output_path, "wb") : stdout;
+	if (!file) {
+		print(Print_error, "Failed to create {}\n", Span((utf8 *)output_path, strlen(output_path)));
+		return 1;
+	}
+	write_json(file, results, sample_count);
+	if (file != stdout)
+		fclose(file);
+
+	free(upload_data);
+	free(large_png);
+	free(small_png);
+	return 0;
+}
@@ -229,5 +229,116 @@ begin_parse:
 	}
 	write_entire_file(u8"../include/tgraphics/generated/assign.h"s, as_bytes(to_string(assign_builder)));
 
+	// Trace capture and replay, see capture.h and replay.h.
+
+	// Calls whose capture and replay are written by hand.
+	Span<char> manually_traced[] = {
+		"map_shader_constants"s,
+		"unmap_shader_constants"s,
+		"map_vertex_buffer"s,
+		"unmap_vertex_buffer"s,
+	};
+	auto is_manually_traced = [&](Func const &func) {
+		for (auto name : manually_traced) {
+			if (name == func.name)
+				return true;
+		}
+		return false;
+	};
+
+	// `void` pointers are uploaded data, their size comes from a hand written `data_size_<call>`.
+	// `void **` are six faces of a cube.
+	auto is_data = [](Arg const &arg) {
+		return arg.type.count >= 4 && memcmp(arg.type.data, "void", 4) == 0;
+	};
+	auto is_faces = [](Arg const &arg) {
+		return arg.type.count >= 2 && arg.type.end()[-1] == '*' && arg.type.end()[-2] == '*';
+	};
+	auto append_arg_names = [](StringBuilder &builder, Func const &func) {
+		for (auto &arg : func.args) {
+			if (&arg != func.args.data)
+				append(builder, ", ");
+			append(builder, arg.name);
+		}
+	};
+
+	StringBuilder calls_builder;
+	for (auto func : funcs) {
+		append_format(calls_builder, "ApiCall_{},\n", func.name);
+	}
+	write_entire_file(u8"../include/tgraphics/generated/calls.h"s, as_bytes(to_string(calls_builder)));
+
+	StringBuilder capture_builder;
+	for (auto func : funcs) {
+		if (is_manually_traced(func))
+			continue;
+
+		append_format(capture_builder, "state->_{} = [](State *_state", func.name);
+		for (auto &arg : func.args) {
+			append_format(capture_builder, ", {} {}", arg.type, arg.name);
+		}
+		append_format(capture_builder, ") -> {} {{ auto &capture = *_state->capture; TraceCall call(capture, ApiCall_{}); if (call.recording) {{ ", func.ret, func.name);
+		for (auto &arg : func.args) {
+			if (is_data(arg)) {
+				append_format(capture_builder, "{}(capture, {}, data_size_{}(", is_faces(arg) ? "write_faces" : "write_data", arg.name, func.name);
+				append_arg_names(capture_builder, func);
+				append(capture_builder, ")); ");
+			} else {
+				append_format(capture_builder, "write_value(capture, {}); ", arg.name);
+			}
+		}
+		append(capture_builder, "} ");
+
+		bool returns = func.ret != "void"s;
+		if (returns) {
+			append(capture_builder, "auto result = ");
+		}
+		append_format(capture_builder, "capture.original._{}(_state", func.name);
+		for (auto &arg : func.args) {
+			append_format(capture_builder, ", {}", arg.name);
+		}
+		append(capture_builder, "); ");
+		if (returns) {
+			append(capture_builder, "if (call.recording) capture_result(capture, result); return result; ");
+		}
+		append(capture_builder, "};\n");
+	}
+	write_entire_file(u8"../include/tgraphics/generated/capture.h"s, as_bytes(to_string(capture_builder)));
+
+	StringBuilder uncapture_builder;
+	for (auto func : funcs) {
+		append_format(uncapture_builder, "state->_{} = capture.original._{};\n", func.name, func.name);
+	}
+	write_entire_file(u8"../include/tgraphics/generated/uncapture.h"s, as_bytes(to_string(uncapture_builder)));
+
+	StringBuilder replay_builder;
+	for (auto func : funcs) {
+		if (is_manually_traced(func))
+			continue;
+
+		append_format(replay_builder, "case ApiCall_{}: {{ ", func.name);
+		for (auto &arg : func.args) {
+			if (is_faces(arg)) {
+				append_format(replay_builder, "void *{}[6] = {{}}; read_faces(replay, {}); ", arg.name, arg.name);
+			} else if (is_data(arg)) {
+				append_format(replay_builder, "{} {} = {{}}; read_data(replay, {}); ", arg.type, arg.name, arg.name);
+			} else {
+				append_format(replay_builder, "{} {} = {{}}; read_value(replay, {}); ", arg.type, arg.name, arg.name);
+			}
+		}
+		bool returns = func.ret != "void"s;
+		if (returns) {
+			append(replay_builder, "auto result = ");
+		}
+		append_format(replay_builder, "_state->{}(", func.name);
+		append_arg_names(replay_builder, func);
+		append(replay_builder, "); ");
+		if (returns) {
+			append(replay_builder, "replay_result(replay, result); ");
+		}
+		append(replay_builder, "break; }\n");
+	}
+	write_entire_file(u8"../include/tgraphics/generated/replay.h"s, as_bytes(to_string(replay_builder)));
+
 	return 0;
 }
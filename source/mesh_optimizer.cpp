@@ -0,0 +1,215 @@
+#include <tl/common.h>
+#include <tl/file.h>
+#include <tl/console.h>
+#include <tl/main.h>
+#include <tgraphics/mesh.h>
+
+#include <stdlib.h>
+
+using namespace tl;
+using namespace tgraphics;
+
+// Usage: mesh_optimizer input.obj output.mesh
+//
+// Converts a Wavefront OBJ file into the format read by `parse_mesh_file`.
+// Vertices are position f32x3, uv f32x2 and normal f32x3. Polygons are triangulated as fans.
+
+struct Vertex {
+	v3f position;
+	v2f uv;
+	v3f normal;
+};
+
+ElementType vertex_elements[] = {Element_f32x3, Element_f32x2, Element_f32x3};
+
+char *skip_spaces(char *c) {
+	while (*c == ' ' || *c == '\t')
+		++c;
+	return c;
+}
+
+char *skip_line(char *c) {
+	while (*c && *c != '\n')
+		++c;
+	return *c ? c + 1 : c;
+}
+
+// OBJ indices are one based, negative ones count from the end. Returns -1 if the index is missing.
+s64 resolve_index(s64 index, umm count) {
+	if (index > 0)
+		return index - 1;
+	if (index < 0)
+		return (s64)count + index;
+	return -1;
+}
+
+bool parse_obj(char *c, List<Vertex> &vertices) {
+	List<v3f> positions;
+	List<v2f> uvs;
+	List<v3f> normals;
+	List<Vertex> polygon;
+	defer {
+		free(positions);
+		free(uvs);
+		free(normals);
+		free(polygon);
+	};
+
+	u32 line = 1;
+	for (; *c; c = skip_line(c), ++line) {
+		c = skip_spaces(c);
+		if (c[0] == 'v' && c[1] == ' ') {
+			v3f v = {};
+			v.x = strtof(c + 2, &c);
+			v.y = strtof(c, &c);
+			v.z = strtof(c, &c);
+			positions.add(v);
+		} else if (c[0] == 'v' && c[1] == 't' && c[2] == ' ') {
+			v2f v = {};
+			v.x = strtof(c + 3, &c);
+			v.y = strtof(c, &c);
+			uvs.add(v);
+		} else if (c[0] == 'v' && c[1] == 'n' && c[2] == ' ') {
+			v3f v = {};
+			v.x = strtof(c + 3, &c);
+			v.y = strtof(c, &c);
+			v.z = strtof(c, &c);
+			normals.add(v);
+		} else if (c[0] == 'f' && c[1] == ' ') {
+			polygon.clear();
+			c = skip_spaces(c + 2);
+			while (*c && *c != '\n' && *c != '\r') {
+				s64 position_index = resolve_index(strtoll(c, &c, 10), positions.count);
+				s64 uv_index = -1;
+				s64 normal_index = -1;
+				if (*c == '/') {
+					++c;
+					if (*c != '/')
+						uv_index = resolve_index(strtoll(c, &c, 10), uvs.count);
+					if (*c == '/') {
+						++c;
+						normal_index = resolve_index(strtoll(c, &c, 10), normals.count);
+					}
+				}
+
+				if (position_index < 0 || position_index >= (s64)positions.count || uv_index >= (s64)uvs.count || normal_index >= (s64)normals.count) {
+					print(Print_error, "Line {}: face index is out of range\n", line);
+					return false;
+				}
+
+				Vertex vertex = {};
+				vertex.position = positions[position_index];
+				if (uv_index >= 0)
+					vertex.uv = uvs[uv_index];
+				if (normal_index >= 0)
+					vertex.normal = normals[normal_index];
+				polygon.add(vertex);
+
+				c = skip_spaces(c);
+			}
+
+			for (umm i = 2; i < polygon.count; ++i) {
+				vertices.add(polygon[0]);
+				vertices.add(polygon[i - 1]);
+				vertices.add(polygon[i]);
+			}
+		}
+	}
+	return true;
+}
+
+void print_statistics(char const *stage, Span<u32> indices, u32 vertex_count) {
+	auto statistics = analyze_vertex_cache(indices, vertex_count, sizeof(Vertex));
+	print("{}: ACMR {}, ATVR {}, overfetch {}\n", stage, statistics.acmr, statistics.atvr, statistics.overfetch);
+}
+
+s32 tl_main(Span<Span<utf8>> args) {
+	current_printer = console_printer;
+	current_allocator = temporary_allocator;
+
+	if (args.count != 3) {
+		print("Usage: mesh_optimizer input.obj output.mesh\n");
+		return 1;
+	}
+
+	auto file = read_entire_file(args[1]);
+	if (!file.data) {
+		print(Print_error, "Failed to open {}\n", args[1]);
+		return 1;
+	}
+
+	// strtof needs a null terminated string.
+	List<char> text;
+	text.resize(file.count + 1);
+	memcpy(text.data, file.data, file.count);
+	text[file.count] = 0;
+
+	List<Vertex> unindexed;
+	if (!parse_obj(text.data, unindexed))
+		return 1;
+
+	if (!unindexed.count) {
+		print(Print_error, "{} has no faces\n", args[1]);
+		return 1;
+	}
+
+	u32 unindexed_count = (u32)unindexed.count;
+
+	// The remap table of an unindexed stream is its index buffer.
+	List<u32> indices;
+	indices.resize(unindexed_count);
+	u32 vertex_count = deduplicate_vertices(indices, unindexed.data, unindexed_count, sizeof(Vertex));
+
+	List<Vertex> vertices;
+	vertices.resize(vertex_count);
+	remap_vertices(vertices.data, unindexed.data, unindexed_count, sizeof(Vertex), indices);
+
+	print("{} triangles, {} unique vertices\n", indices.count / 3, vertex_count);
+	print_statistics("Before", indices, vertex_count);
+
+	optimize_vertex_cache(indices, indices, vertex_count);
+	print_statistics("Vertex cache", indices, vertex_count);
+
+	optimize_overdraw(indices, indices, &vertices[0].position.x, sizeof(Vertex), vertex_count);
+	print_statistics("Overdraw", indices, vertex_count);
+
+	List<Vertex> fetch_ordered;
+	fetch_ordered.resize(vertex_count);
+	vertex_count = optimize_vertex_fetch(fetch_ordered.data, indices, vertices.data, vertex_count, sizeof(Vertex));
+	print_statistics("Vertex fetch", indices, vertex_count);
+
+	u32 index_size = vertex_count <= 0x10000 ? 2 : 4;
+
+	MeshFileHeader header = {};
+	header.magic = mesh_file_magic;
+	header.version = mesh_file_version;
+	header.element_count = (u32)(sizeof(vertex_elements) / sizeof(vertex_elements[0]));
+	header.vertex_count = vertex_count;
+	header.vertex_size = sizeof(Vertex);
+	header.index_count = (u32)indices.count;
+	header.index_size = index_size;
+	header.vertex_offset = (u32)(sizeof(header) + sizeof(vertex_elements) + 3) & ~3u;
+	header.index_offset = header.vertex_offset + vertex_count * (u32)sizeof(Vertex);
+
+	List<u8> output;
+	output.resize(header.index_offset + indices.count * index_size);
+	memset(output.data, 0, output.count);
+	memcpy(output.data, &header, sizeof(header));
+	memcpy(output.data + sizeof(header), vertex_elements, sizeof(vertex_elements));
+	memcpy(output.data + header.vertex_offset, fetch_ordered.data, vertex_count * sizeof(Vertex));
+	for (umm i = 0; i < indices.count; ++i) {
+		if (index_size == 2) {
+			((u16 *)(output.data + header.index_offset))[i] = (u16)indices[i];
+		} else {
+			((u32 *)(output.data + header.index_offset))[i] = indices[i];
+		}
+	}
+
+	if (!write_entire_file(args[2], output)) {
+		print(Print_error, "Failed to write {}\n", args[2]);
+		return 1;
+	}
+
+	print("Wrote {} ({} bytes)\n", args[2], output.count);
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <tl/common.h>
+#include <tl/file.h>
+#include <tl/console.h>
+#include <tl/main.h>
+#include <tl/window.h>
+#include <tgraphics/replay.h>
+
+using namespace tl;
+using namespace tgraphics;
+
+// Usage: replay file.trace [--paced]
+//
+// Replays a trace written by `start_capture` and prints how long it took.
+// Without --paced frames are presented as fast as possible, which makes it a benchmark of the recorded workload.
+
+State *state;
+
+s32 tl_main(Span<Span<utf8>> args) {
+	current_printer = console_printer;
+
+	if (args.count < 2) {
+		print("Usage: replay file.trace [--paced]\n");
+		return 1;
+	}
+
+	ReplayParams params = {};
+	for (umm i = 2; i < args.count; ++i) {
+		if (args[i] == u8"--paced"s) {
+			params.paced = true;
+		} else {
+			print(Print_error, "Unknown argument {}\n", args[i]);
+			return 1;
+		}
+	}
+
+	auto file = read_entire_file(args[1]);
+	if (!file.data) {
+		print(Print_error, "Failed to open {}\n", args[1]);
+		return 1;
+	}
+
+	auto window = create_window({
+		.on_create = [](Window &window) {
+			state = init(GraphicsApi_opengl, {.window = window.handle});
+			state->set_vsync(false);
+		},
+		.on_size = [](Window &window) {
+			state->on_window_resize(window.client_size.x, window.client_size.y);
+		},
+	});
+	if (!state)
+		return 1;
+
+	ReplayStats stats = {};
+	auto succeeded = replay_trace(state, file, params, &stats);
+
+	print("{} frames, {} calls in {} s\n", stats.frame_count, stats.call_count, stats.seconds);
+	if (stats.frame_count)
+		print("{} ms per frame\n", stats.seconds * 1000 / stats.frame_count);
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include <tl/common.h>
+#include <tl/file.h>
+#include <tl/console.h>
+#include <tl/main.h>
+#include <tl/window.h>
+#include <tgraphics/text.h>
+
+using namespace tl;
+using namespace tgraphics;
+
+// Usage: text_benchmark font.ttf [frame_count]
+//
+// Lays out and draws 100k distance field glyphs per frame and prints CPU and GPU times.
+// To measure the software path, run it with Mesa's opengl32.dll (llvmpipe) next to the executable.
+
+inline constexpr u32 glyphs_per_frame = 100'000;
+inline constexpr f32 text_size = 12;
+
+Span<utf8> const paragraph = u8"The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs. "s;
+
+State *state;
+TextureAtlas atlas;
+Font font;
+SpriteBatch batch;
+
+u32 frame_count = 300;
+u32 frames_drawn = 0;
+f64 layout_ms = 0;
+f64 flush_ms = 0;
+f64 gpu_ms = 0;
+
+f64 get_ms(LARGE_INTEGER begin, LARGE_INTEGER end) {
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (end.QuadPart - begin.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+s32 tl_main(Span<Span<utf8>> args) {
+	current_printer = console_printer;
+
+	if (args.count < 2) {
+		print("Usage: text_benchmark font.ttf [frame_count]\n");
+		return 1;
+	}
+	if (args.count > 2) {
+		frame_count = (u32)atoi((char *)args[2].data);
+	}
+
+	auto file = read_entire_file(args[1]);
+	if (!file.data) {
+		print(Print_error, "Failed to open {}\n", args[1]);
+		return 1;
+	}
+
+	auto window = create_window({
+		.on_create = [](Window &window) {
+			state = init(GraphicsApi_opengl, {.window = window.handle});
+			state->set_vsync(false);
+		},
+		.on_size = [](Window &window) {
+			state->on_window_resize(window.client_size.x, window.client_size.y);
+		},
+	});
+	if (!state)
+		return 1;
+
+	atlas = create_texture_atlas({1024, 1024}, Format_r_u8n);
+	font = load_font(file, atlas);
+	if (!font.file.count)
+		return 1;
+	batch = create_text_batch(state);
+
+	while (update(window) && frames_drawn < frame_count) {
+		auto size = window->client_size;
+		state->set_render_target(state->back_buffer);
+		state->set_viewport(size);
+		state->clear(state->back_buffer, ClearFlags_color, {0, 0, 0, 1}, 1);
+
+		LARGE_INTEGER begin, laid_out, flushed;
+		QueryPerformanceCounter(&begin);
+
+		// Lines wrap at the window width and restart from the top when they run out of space.
+		v2f position = {0, (f32)size.y - text_size};
+		while (batch.sprites.count < glyphs_per_frame) {
+			auto text_size_on_screen = add_text(state, batch, font, paragraph, position, {.size = text_size, .max_width = (f32)size.x});
+			position.y -= text_size_on_screen.y;
+			if (position.y < 0)
+				position.y = (f32)size.y - text_size;
+		}
+		QueryPerformanceCounter(&laid_out);
+
+		flush(state, batch, atlas, size);
+		QueryPerformanceCounter(&flushed);
+
+		state->present();
+
+		// The first frames rasterize glyphs and warm up the driver.
+		if (frames_drawn++ >= 10) {
+			layout_ms += get_ms(begin, laid_out);
+			flush_ms += get_ms(laid_out, flushed);
+			gpu_ms += state->get_frame_timings().gpu_frame_ms;
+		}
+	}
+
+	auto measured = max(frames_drawn, 11u) - 10;
+	print("{} glyphs per frame, {} draws, {} frames\n", batch.sprite_count, batch.draw_count, measured);
+	print("layout: {} ms\n", layout_ms / measured);
+	print("flush:  {} ms\n", flush_ms / measured);
+	print("gpu:    {} ms\n", gpu_ms / measured);
+
+	free(batch);
+	free(font);
+	free(atlas);
+	return 0;
+}